@@ -0,0 +1,79 @@
+#include "aligned_tuple.h"
+#include <chrono>
+#include <vector>
+
+const std::uint32_t TUPLE_COUNT = 1 << 12;  // Small enough to stay in cache, so the arithmetic dominates
+const std::uint32_t CYCLES = 1000;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the mean wall-clock time of one call to "cycle," in microseconds
+template <typename Function>
+double timeCycles(Function cycle) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::uint32_t c = 0; c < CYCLES; c++)
+		cycle();
+
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / CYCLES;
+}
+
+// A spring-like inner loop: direction and length of the separation, then accumulate a force along it
+template <typename TupleType>
+void springLoop(const std::vector<TupleType>& a, const std::vector<TupleType>& b, std::vector<TupleType>& F) {
+	for (std::uint32_t i = 0; i < a.size(); i++) {
+		TupleType d = b[i] - a[i];
+		double length_squared = magnitudeSquared(d);
+		F[i] += unit(d) * (length_squared - 1.);
+		F[i] -= a[i] * (dot(a[i], d) * .01);
+	}
+}
+
+template <typename TupleType>
+void crossLoop(const std::vector<TupleType>& a, const std::vector<TupleType>& b, std::vector<TupleType>& F) {
+	for (std::uint32_t i = 0; i < a.size(); i++)
+		F[i] += cross(a[i], b[i]) * .01;
+}
+
+template <std::uint8_t _Size, typename Loop>
+void benchmark(const char* name, Loop loop) {
+	std::vector<Tuple<_Size> > a, b, F(TUPLE_COUNT);
+	std::vector<AlignedTuple<_Size> > aligned_a, aligned_b, aligned_F(TUPLE_COUNT);
+
+	for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) {
+		a.push_back(random_unit<_Size>() * 2.);
+		b.push_back(random_unit<_Size>() * 3.);
+		aligned_a.push_back(AlignedTuple<_Size>(a.back()));
+		aligned_b.push_back(AlignedTuple<_Size>(b.back()));
+	}
+
+	double tuple_time = timeCycles([&]() { loop(a, b, F); });
+	double aligned_time = timeCycles([&]() { loop(aligned_a, aligned_b, aligned_F); });
+
+	print(_Size + 0, "D", name, " Tuple:", tuple_time, "us  AlignedTuple:", aligned_time, "us  speedup:", tuple_time / aligned_time);
+}
+
+int main() {
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	print("AlignedTuple compiled for AVX");
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+	print("AlignedTuple compiled for SSE2 (build with BENCHFLAGS=\"-O2 -mavx2\" for AVX)");
+#else
+	print("AlignedTuple compiled without SIMD");
+#endif
+	print(TUPLE_COUNT, "tuples, mean of", CYCLES, "cycles");
+	print();
+
+	benchmark<3>("spring", [](auto& a, auto& b, auto& F) { springLoop(a, b, F); });
+	benchmark<4>("spring", [](auto& a, auto& b, auto& F) { springLoop(a, b, F); });
+	benchmark<3>("cross ", [](auto& a, auto& b, auto& F) { crossLoop(a, b, F); });
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "particle_store.h"
+#include <chrono>
+#include <vector>
+
+using namespace Brazen;
+
+const std::uint32_t PARTICLE_COUNT = 1 << 20;
+const std::uint32_t CYCLES = 20;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the mean wall-clock time of one call to "cycle," in milliseconds
+template <typename Function>
+double timeCycles(Function cycle) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::uint32_t c = 0; c < CYCLES; c++)
+		cycle();
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / CYCLES;
+}
+
+template <std::uint8_t _Size, typename _Scalar = double>
+void benchmark(const char* scalar_name = "double") {
+	std::vector<Particle<_Size, _Scalar> > particles;
+	ParticleStore<_Size, _Scalar> store;
+
+	for (std::uint32_t i = 0; i < PARTICLE_COUNT; i++) {
+		// A third of the particles are static geometry, at rest
+		Particle<_Size, _Scalar> p(random_unit<_Size, _Scalar>(), i % 3 ? random_unit<_Size, _Scalar>() : Tuple<_Size, _Scalar>(), i % 3 ? 1. : 0.);
+		particles.push_back(p);
+		store.push_back(p);
+	}
+
+	// The per-particle loop "Simulator::updateState()" used to run
+	double loop_time = timeCycles([&particles]() {
+		for (Particle<_Size, _Scalar>& p : particles)
+			p.update(.001);
+	});
+	print(_Size + 0, "D", scalar_name, " Particle::update() loop:", loop_time, "ms");
+
+	for (int l = 0; l <= (int)simdLevel(); l++) {
+		SimdLevel level = (SimdLevel)l;
+		double batch_time = timeCycles([&store, level]() {
+			store.applyCorrections();  // No particle has corrections, as in most cycles
+			integrateBatch<_Size, _Scalar>(store.arrays(), .001, 0, store.size(), level);
+		});
+		print(_Size + 0, "D", scalar_name, " batch kernel (", simdLevelName(level), "):", batch_time, "ms  speedup:", loop_time / batch_time);
+	}
+
+	// Static particles moved behind the dynamic ones, so only the dynamic range is integrated
+	std::vector<std::uint32_t> new_index;
+	store.partition(new_index);
+	double partitioned_time = timeCycles([&store]() {
+		store.integrate(.001);
+	});
+	print(_Size + 0, "D", scalar_name, " partitioned store (", simdLevelName(simdLevel()), "):", partitioned_time, "ms  speedup:", loop_time / partitioned_time);
+}
+
+int main() {
+	print("Integrating", PARTICLE_COUNT, "particles, mean of", CYCLES, "cycles");
+	print("Detected SIMD level:", simdLevelName(simdLevel()));
+	print();
+
+	benchmark<2>();
+	benchmark<3>();
+	benchmark<4>();
+	print();
+
+	// Half the memory traffic and twice the particles per vector
+	benchmark<3, float>("float");
+
+	return 0;
+}
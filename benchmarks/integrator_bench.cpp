@@ -0,0 +1,91 @@
+#include "implicit_euler.h"
+#include <chrono>
+#include <vector>
+
+using namespace Brazen;
+
+const std::uint32_t CHAIN_LENGTH = 4096;  // Particles in the spring chain, the first one static
+const double STIFFNESS = 1e4, MASS = 1., REST_LENGTH = .1;
+const double DURATION = .5;  // Simulated seconds per run
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// A chain of stiff springs hanging from a static particle, stretched and let go
+void makeChain(ParticleStore<3>& store, std::vector<Spring<3> >& springs) {
+	for (std::uint32_t i = 0; i < CHAIN_LENGTH; i++)
+		store.push_back(Particle<3>(Tuple<3>(1.2 * REST_LENGTH * i, 0., 0.), i ? MASS : 0.));
+	for (std::uint32_t i = 0; i + 1 < CHAIN_LENGTH; i++)
+		springs.push_back(Spring<3>(i, i + 1, STIFFNESS, REST_LENGTH));
+}
+
+void chainForces(ParticleStore<3>& store) {
+	for (std::uint32_t i = 0; i + 1 < CHAIN_LENGTH; i++) {
+		Tuple<3> d = store.pos[i + 1] - store.pos[i];
+		double length = magnitude(d);
+		Tuple<3> f = d * (STIFFNESS * (length - REST_LENGTH) / length);
+		store.F[i] += f;
+		store.F[i + 1] -= f;
+	}
+}
+
+// Run the chain for DURATION with the given step. Return the wall-clock time in milliseconds and store the final positions.
+template <template <std::uint8_t, typename> class _Integrator>
+double runChain(double dt, std::vector<Tuple<3> >& final_pos) {
+	ParticleStore<3> store;
+	std::vector<Spring<3> > springs;
+	_Integrator<3, double> integrator;
+	makeChain(store, springs);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const std::uint32_t steps = (std::uint32_t)std::lround(DURATION / dt);
+	for (std::uint32_t s = 0; s < steps; s++)
+		integrator.step(store, dt, springForces(springs, [&store]() { chainForces(store); }), nullptr);
+	double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	final_pos = store.pos;
+	return time;
+}
+
+// Try one integrator at growing multiples of the base step, reporting its error against the reference solution.
+template <template <std::uint8_t, typename> class _Integrator>
+void benchmark(double base_dt, const std::vector<Tuple<3> >& reference) {
+	for (double multiple : { 1., 2., 2.5, 3., 4., 8., 16. }) {
+		std::vector<Tuple<3> > final_pos;
+		double time = runChain<_Integrator>(base_dt * multiple, final_pos);
+
+		double error = 0.;
+		for (std::uint32_t i = 0; i < CHAIN_LENGTH; i++)
+			error = std::max(error, magnitude(final_pos[i] - reference[i]));
+		bool stable = error < 1.;  // Unstable runs blow up by many orders of magnitude
+
+		print(_Integrator<3, double>::name(), " dt =", multiple, "x base  time:", time, "ms  max position error:", stable ? error : -1.,
+			stable ? "" : "(unstable)");
+	}
+	print();
+}
+
+int main() {
+	// The fastest mode of a chain of springs has angular frequency 2 * sqrt(k / m); explicit methods need dt < 2 / omega
+	const double omega = 2. * std::sqrt(STIFFNESS / MASS), base_dt = 1. / omega;
+	print(CHAIN_LENGTH, "particle spring chain, k =", STIFFNESS, " base dt = 1 / omega_max =", base_dt, "s, ", DURATION, "simulated seconds");
+	print("Errors are against RK4 at a hundredth of the base step");
+	print();
+
+	std::vector<Tuple<3> > reference;
+	runChain<RungeKutta4>(base_dt / 100., reference);
+
+	benchmark<SymplecticEuler>(base_dt, reference);
+	benchmark<PositionVerlet>(base_dt, reference);
+	benchmark<VelocityVerlet>(base_dt, reference);
+	benchmark<RungeKutta4>(base_dt, reference);
+	benchmark<ImplicitEuler>(base_dt, reference);
+
+	return 0;
+}
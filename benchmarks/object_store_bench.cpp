@@ -0,0 +1,79 @@
+#include "object_store.h"
+#include <chrono>
+#include <vector>
+#include <random>
+#include <memory>
+#include <algorithm>
+
+using namespace Brazen;
+
+const std::uint32_t OBJECT_COUNT = 50000;
+const std::uint32_t MEMBERS = 8;  // Particles per object
+const std::uint32_t CYCLES = 20;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the mean wall-clock time of one call to "cycle," in milliseconds
+template <typename Function>
+double timeCycles(Function cycle) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::uint32_t c = 0; c < CYCLES; c++)
+		cycle();
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / CYCLES;
+}
+
+int main() {
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<double> coordinate(0., 100.);
+
+	// Small objects of neighbouring particles, created in shuffled order and interleaved with other
+	//	allocations, as when a scene is loaded object by object
+	std::vector<Tuple<3> > positions(OBJECT_COUNT * MEMBERS);
+	for (Tuple<3>& p : positions)
+		p = Tuple<3>(coordinate(generator), coordinate(generator), coordinate(generator));
+	std::vector<std::uint32_t> order(OBJECT_COUNT);
+	for (std::uint32_t o = 0; o < OBJECT_COUNT; o++)
+		order[o] = o;
+	std::shuffle(order.begin(), order.end(), generator);
+
+	std::vector<std::vector<std::uint32_t> > lists;
+	std::vector<std::unique_ptr<char[]> > clutter;
+	ObjectStore<3> store;
+	for (std::uint32_t o : order) {
+		std::vector<std::uint32_t> list;
+		for (std::uint32_t m = 0; m < MEMBERS; m++)
+			list.push_back(o * MEMBERS + m);
+		lists.push_back(list);
+		clutter.emplace_back(new char[64]);
+		store.push_back(list, positions);
+	}
+
+	print("Bounding", OBJECT_COUNT, "objects of", MEMBERS, "particles, mean of", CYCLES, "cycles");
+
+	std::vector<AABB<3> > bounds(OBJECT_COUNT);
+	std::vector<Tuple<3> > centroids(OBJECT_COUNT);
+	double nested_time = timeCycles([&]() {
+		for (std::uint32_t o = 0; o < OBJECT_COUNT; o++) {
+			bounds[o] = boundsOf(positions, lists[o]);
+			Tuple<3> sum;
+			for (std::uint32_t index : lists[o])
+				sum += positions[index];
+			centroids[o] = sum / (double)lists[o].size();
+		}
+	});
+	print("vector of vectors + boundsOf():", nested_time, "ms");
+
+	double csr_time = timeCycles([&]() { store.updateBounds(positions, 0, store.size()); });
+	print("ObjectStore::updateBounds():", csr_time, "ms  speedup:", nested_time / csr_time);
+
+	return 0;
+}
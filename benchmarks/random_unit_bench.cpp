@@ -0,0 +1,62 @@
+#include "tuple_batch.h"
+#include <chrono>
+#include <vector>
+
+using namespace Brazen;
+
+const std::uint32_t TUPLE_COUNT = 1 << 20;
+const std::uint32_t CYCLES = 5;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the mean wall-clock time of one call to "cycle," in milliseconds
+template <typename Function>
+double timeCycles(Function cycle) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::uint32_t c = 0; c < CYCLES; c++)
+		cycle();
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / CYCLES;
+}
+
+template <std::uint8_t _Size>
+void benchmark(ThreadPool& pool) {
+	std::vector<Tuple<_Size> > out(TUPLE_COUNT);
+
+	double loop_time = timeCycles([&out]() {
+		for (Tuple<_Size>& v : out)
+			v = random_unit<_Size>();
+	});
+	print(_Size + 0, "D random_unit() loop:", loop_time, "ms");
+
+	for (int l = 0; l <= (int)simdLevel(); l++) {
+		SimdLevel level = (SimdLevel)l;
+		double batch_time = timeCycles([&out, level]() { randomUnitBatch(out.data(), TUPLE_COUNT, 1, nullptr, level); });
+		double threaded_time = timeCycles([&out, &pool, level]() { randomUnitBatch(out.data(), TUPLE_COUNT, 1, &pool, level); });
+		print(_Size + 0, "D randomUnitBatch (", simdLevelName(level), "):", batch_time, "ms  speedup:", loop_time / batch_time,
+			" with", pool.threadCount(), "threads:", threaded_time, "ms  speedup:", loop_time / threaded_time);
+	}
+	print();
+}
+
+int main() {
+	ThreadPool pool;
+
+	print("Generating", TUPLE_COUNT, "unit vectors, mean of", CYCLES, "cycles");
+	print("Detected SIMD level:", simdLevelName(simdLevel()));
+	print();
+
+	benchmark<2>(pool);
+	benchmark<3>(pool);
+	benchmark<8>(pool);
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include "topology.h"
+#include "integrators.h"
+#include <chrono>
+#include <vector>
+#include <random>
+
+using namespace Brazen;
+
+const std::array<std::uint32_t, 3> BODY = { { 10, 10, 10 } };  // Lattice points per axis of the body
+const double SPACING = .1, STIFFNESS = 100., DAMPING = .5, MASS = 1.;
+const double DURATION = 1.;  // Simulated seconds per run
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+void applySprings(ParticleStore<3>& store, const std::vector<Spring<3> >& springs) {
+	for (const Spring<3>& spring : springs)
+		spring.update(store);
+}
+
+// Root mean square relative change in the distance between every pair of particles: 0 for a body that kept its shape
+double shapeError(const std::vector<Tuple<3> >& rest, const std::vector<Tuple<3> >& pos) {
+	double sum = 0.;
+	std::uint64_t pairs = 0;
+	for (std::uint32_t i = 0; i < rest.size(); i++)
+		for (std::uint32_t j = i + 1; j < rest.size(); j++) {
+			double rest_distance = magnitude(rest[j] - rest[i]);
+			double change = (magnitude(pos[j] - pos[i]) - rest_distance) / rest_distance;
+			sum += change * change;
+			pairs++;
+		}
+	return std::sqrt(sum / pairs);
+}
+
+// Knock the body out of shape, let it settle for DURATION and report the cost per step and how well it recovered.
+void benchmark(const char* name, const std::vector<SpringEdge>& edges, double build_time, const std::vector<Tuple<3> >& rest) {
+	std::vector<Spring<3> > springs;
+	for (const SpringEdge& edge : edges)
+		springs.push_back(Spring<3>(edge.p1_index, edge.p2_index, STIFFNESS, magnitude(rest[edge.p2_index] - rest[edge.p1_index]), DAMPING));
+
+	for (double rate : { 240., 120., 60. }) {
+		std::mt19937 generator(3);
+		std::uniform_real_distribution<double> kick(-.2 * SPACING, .2 * SPACING);
+		ParticleStore<3> store;
+		SymplecticEuler<3> integrator;
+		for (const Tuple<3>& p : rest)
+			store.push_back(Particle<3>(p + Tuple<3>(kick(generator), kick(generator), kick(generator)), MASS));
+
+		const std::uint32_t steps = (std::uint32_t)(DURATION * rate);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (std::uint32_t s = 0; s < steps; s++)
+			integrator.step(store, 1. / rate, springForces(springs, [&store, &springs]() { applySprings(store, springs); }), nullptr);
+		double step_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / steps;
+
+		double error = shapeError(rest, store.pos);
+		bool stable = std::isfinite(error) && error < 1.;
+		print(name, " springs:", springs.size(), " build:", build_time, "ms ", rate, "Hz  step:", step_time, "ms  shape error:",
+			stable ? error : -1., stable ? "" : "(unstable)");
+	}
+	print();
+}
+
+// Return the wall-clock time of one call to "build," in milliseconds, storing its edges
+template <typename Function>
+double timeBuild(Function build, std::vector<SpringEdge>& edges) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	edges = build();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+	const std::vector<Tuple<3> > rest = latticePoints<3>(BODY, SPACING);
+	std::vector<SpringEdge> edges;
+	double build_time;
+
+	print(rest.size(), "particle body, k =", STIFFNESS, " displaced by up to 20% of the spacing, then left to settle for", DURATION, "s");
+	print("Shape error: RMS relative change in every pairwise distance at the end");
+	print();
+
+	build_time = timeBuild([&rest]() { return fullyConnectedEdges((std::uint32_t)rest.size()); }, edges);
+	benchmark("fully connected", edges, build_time, rest);
+	build_time = timeBuild([]() { return latticeEdges<3>(BODY, true); }, edges);
+	benchmark("tetrahedral lattice", edges, build_time, rest);
+	build_time = timeBuild([]() { return latticeEdges<3>(BODY, false); }, edges);
+	benchmark("cubic lattice (not rigid)", edges, build_time, rest);
+	build_time = timeBuild([&rest]() { return kNearestEdges(rest, 9); }, edges);
+	benchmark("9 nearest neighbors", edges, build_time, rest);
+	build_time = timeBuild([&rest]() { return distanceEdges(rest, 1.5 * SPACING); }, edges);
+	benchmark("within 1.5 spacings", edges, build_time, rest);
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include "tuple_batch.h"
+#include <chrono>
+#include <vector>
+
+using namespace Brazen;
+
+const std::uint32_t TUPLE_COUNT = 1 << 13;  // 192 kB per array of 3D double tuples, so the arrays stay in cache
+const std::uint32_t CYCLES = 1000;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the mean wall-clock time of one call to "cycle," in microseconds
+template <typename Function>
+double timeCycles(Function cycle) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::uint32_t c = 0; c < CYCLES; c++)
+		cycle();
+
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / CYCLES;
+}
+
+// Time one batch function against the per-tuple loop it replaces, with both layouts at every SIMD level.
+//	Only "axpyBatch()" is vectorized on arrays of Tuple; the others run the same kernel at every level there.
+template <typename Loop, typename InterleavedBatch, typename ComponentBatch>
+void benchmark(const char* name, Loop loop, InterleavedBatch interleaved_batch, ComponentBatch component_batch) {
+	double loop_time = timeCycles(loop);
+	print(name, " per-tuple loop:", loop_time, "us");
+
+	for (int l = 0; l <= (int)simdLevel(); l++) {
+		SimdLevel level = (SimdLevel)l;
+		double interleaved_time = timeCycles([&]() { interleaved_batch(level); });
+		double component_time = timeCycles([&]() { component_batch(level); });
+		print(name, " batch (", simdLevelName(level), ")  Tuple array:", interleaved_time, "us  speedup:", loop_time / interleaved_time,
+			" components:", component_time, "us  speedup:", loop_time / component_time);
+	}
+	print();
+}
+
+template <std::uint8_t _Size, typename _Scalar = double>
+void benchmarkSize(const char* scalar_name = "double") {
+	std::vector<Tuple<_Size, _Scalar> > a, b, out(TUPLE_COUNT);
+	std::vector<_Scalar> scalars(TUPLE_COUNT), a_storage(_Size * TUPLE_COUNT), b_storage(_Size * TUPLE_COUNT), out_storage(_Size * TUPLE_COUNT);
+	TupleComponents<_Size, _Scalar> a_view, b_view, out_view;
+
+	for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) {
+		a.push_back(Tuple<_Size, _Scalar>(random_unit<_Size>() * 2.));
+		b.push_back(Tuple<_Size, _Scalar>(random_unit<_Size>() * 3.));
+	}
+	for (std::uint8_t c = 0; c < _Size; c++) {
+		a_view.component[c] = a_storage.data() + c * TUPLE_COUNT;
+		b_view.component[c] = b_storage.data() + c * TUPLE_COUNT;
+		out_view.component[c] = out_storage.data() + c * TUPLE_COUNT;
+		for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) {
+			a_view.component[c][i] = a[i][c];
+			b_view.component[c][i] = b[i][c];
+		}
+	}
+
+	print(_Size + 0, "D", scalar_name);
+	benchmark("axpy",
+		[&]() { for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) out[i] += a[i] * _Scalar(.5); },
+		[&](SimdLevel level) { axpyBatch(.5, a.data(), out.data(), TUPLE_COUNT, nullptr, level); },
+		[&](SimdLevel level) { axpyBatch(.5, a_view, out_view, TUPLE_COUNT, nullptr, level); });
+	benchmark("dot",
+		[&]() { for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) scalars[i] = dot(a[i], b[i]); },
+		[&](SimdLevel) { dotBatch(a.data(), b.data(), scalars.data(), TUPLE_COUNT); },
+		[&](SimdLevel level) { dotBatch(a_view, b_view, scalars.data(), TUPLE_COUNT, nullptr, level); });
+	benchmark("magnitude",
+		[&]() { for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) scalars[i] = magnitude(a[i]); },
+		[&](SimdLevel) { magnitudeBatch(a.data(), scalars.data(), TUPLE_COUNT); },
+		[&](SimdLevel level) { magnitudeBatch(a_view, scalars.data(), TUPLE_COUNT, nullptr, level); });
+	benchmark("unit",
+		[&]() { for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) out[i] = unit(a[i]); },
+		[&](SimdLevel) { unitBatch(a.data(), out.data(), TUPLE_COUNT); },
+		[&](SimdLevel level) { unitBatch(a_view, out_view, TUPLE_COUNT, nullptr, level); });
+	benchmark("projection_vector",
+		[&]() { for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) out[i] = projection_vector(a[i], b[i]); },
+		[&](SimdLevel) { projectionVectorBatch(a.data(), b.data(), out.data(), TUPLE_COUNT); },
+		[&](SimdLevel level) { projectionVectorBatch(a_view, b_view, out_view, TUPLE_COUNT, nullptr, level); });
+}
+
+int main() {
+	print(TUPLE_COUNT, "tuples, mean of", CYCLES, "cycles");
+	print("Detected SIMD level:", simdLevelName(simdLevel()));
+	print();
+
+	benchmarkSize<3>();
+	benchmarkSize<4>();
+	benchmarkSize<3, float>("float");
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+#include "tuple_expression.h"
+#include <chrono>
+#include <vector>
+
+const std::uint32_t TUPLE_COUNT = 1 << 10;  // Small enough to stay in cache, so the arithmetic dominates
+const std::uint32_t CYCLES = 2000;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the mean wall-clock time of one call to "cycle," in microseconds
+template <typename Function>
+double timeCycles(Function cycle) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (std::uint32_t c = 0; c < CYCLES; c++)
+		cycle();
+
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / CYCLES;
+}
+
+template <std::uint8_t _Size>
+double checksum(const std::vector<Tuple<_Size> >& tuples) {
+	double sum = 0.;
+
+	for (const Tuple<_Size>& v : tuples)
+		for (std::uint8_t i = 0; i < _Size; i++)
+			sum += v[i];
+
+	return sum;
+}
+
+// Time a Verlet-style position update, "pos = pos + vel * dt + F * (dt * dt / 2)," with the eager
+//	operators and with expression templates. Both compute every component identically.
+template <std::uint8_t _Size>
+void benchmark(void) {
+	std::vector<Tuple<_Size> > pos, vel, F;
+	for (std::uint32_t i = 0; i < TUPLE_COUNT; i++) {
+		pos.push_back(random_unit<_Size>());
+		vel.push_back(random_unit<_Size>());
+		F.push_back(random_unit<_Size>());
+	}
+	std::vector<Tuple<_Size> > eager_pos = pos, lazy_pos = pos;
+	const double dt = 1e-6, half_dt_squared = .5 * dt * dt;
+
+	double eager_time = timeCycles([&]() {
+		for (std::uint32_t i = 0; i < TUPLE_COUNT; i++)
+			eager_pos[i] = eager_pos[i] + vel[i] * dt + F[i] * half_dt_squared;
+	});
+	double lazy_time = timeCycles([&]() {
+		for (std::uint32_t i = 0; i < TUPLE_COUNT; i++)
+			lazy_pos[i] = lazy(lazy_pos[i]) + lazy(vel[i]) * dt + lazy(F[i]) * half_dt_squared;
+	});
+
+	print(_Size + 0, "D  eager operators:", eager_time, "us  expression templates:", lazy_time, "us  speedup:", eager_time / lazy_time,
+		" results match:", checksum(eager_pos) == checksum(lazy_pos));
+}
+
+int main() {
+	print("Updating", TUPLE_COUNT, "tuples, mean of", CYCLES, "cycles");
+	print();
+
+	benchmark<4>();
+	benchmark<8>();
+	benchmark<16>();
+
+	return 0;
+}
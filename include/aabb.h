@@ -0,0 +1,113 @@
+// aabb.h
+// Written by Weston Cook
+// Defines the struct AABB and helpers for building them
+
+#ifndef BRAZEN_AABB_H
+#define BRAZEN_AABB_H
+
+#include "tuple.h"
+#include <vector>  // std::vector
+#include <utility>  // std::pair
+#include <algorithm>  // std::min, std::max
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	// Pair of indices of two boxes whose AABBs overlap, with first < second
+	typedef std::pair<std::uint32_t, std::uint32_t> BoxPair;
+
+	/*
+	Struct AABB - N-dimensional axis-aligned bounding box.
+	*/
+	template <std::uint8_t _Size>
+	struct AABB {
+		// ATTRIBUTES
+		Tuple<_Size> min, max;
+
+		// CONSTRUCTORS
+		AABB(void) :
+			min(true), max(true)
+		{}
+		AABB(const Tuple<_Size>& min, const Tuple<_Size>& max) :
+			min(min), max(max)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Return whether this box and the given box overlap (touching counts).
+		bool overlaps(const AABB<_Size>& b) const {
+			for (std::uint8_t i = 0; i < _Size; i++)
+				if (max[i] < b.min[i] || b.max[i] < min[i])
+					return false;
+			return true;
+		}
+		// Return whether the given box lies entirely inside this box.
+		bool contains(const AABB<_Size>& b) const {
+			for (std::uint8_t i = 0; i < _Size; i++)
+				if (b.min[i] < min[i] || max[i] < b.max[i])
+					return false;
+			return true;
+		}
+		// Grow this box to contain the given point.
+		void expand(const Tuple<_Size>& point) {
+			for (std::uint8_t i = 0; i < _Size; i++) {
+				min[i] = std::min(min[i], point[i]);
+				max[i] = std::max(max[i], point[i]);
+			}
+		}
+		// Grow this box by "margin" in every direction.
+		void fatten(double margin) {
+			for (std::uint8_t i = 0; i < _Size; i++) {
+				min[i] -= margin;
+				max[i] += margin;
+			}
+		}
+
+		// Return the center of the box.
+		Tuple<_Size> center(void) const { return (min + max) * .5; }
+		// Return the side lengths of the box.
+		Tuple<_Size> extent(void) const { return max - min; }
+		// Return the largest side length of the box.
+		double largestExtent(void) const {
+			double largest = 0.;
+			for (std::uint8_t i = 0; i < _Size; i++)
+				largest = std::max(largest, max[i] - min[i]);
+			return largest;
+		}
+		// Return the sum of the side lengths of the box. Used as the cost of a box when building trees,
+		//	since it grows with box size in any dimension (unlike volume, which is zero for flat boxes).
+		double perimeter(void) const {
+			double sum = 0.;
+			for (std::uint8_t i = 0; i < _Size; i++)
+				sum += max[i] - min[i];
+			return sum;
+		}
+	};
+
+	// Return the smallest box containing both boxes.
+	template <std::uint8_t _Size>
+	AABB<_Size> merge(const AABB<_Size>& a, const AABB<_Size>& b) {
+		AABB<_Size> out(a);
+
+		for (std::uint8_t i = 0; i < _Size; i++) {
+			out.min[i] = std::min(a.min[i], b.min[i]);
+			out.max[i] = std::max(a.max[i], b.max[i]);
+		}
+
+		return out;
+	}
+
+	// Return the smallest box containing the positions with the given indices. "indices" must not be empty.
+	//	Boxes are always in double precision, whatever the scalar type of the positions.
+	template <std::uint8_t _Size, typename _Scalar, typename Indices>
+	AABB<_Size> boundsOf(const std::vector<Tuple<_Size, _Scalar> >& positions, const Indices& indices) {
+		auto index = indices.begin();
+		Tuple<_Size> first(positions[*index]);
+		AABB<_Size> out(first, first);
+
+		for (++index; index != indices.end(); ++index)
+			out.expand(Tuple<_Size>(positions[*index]));
+
+		return out;
+	}
+}
+
+#endif
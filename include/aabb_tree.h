@@ -0,0 +1,389 @@
+// aabb_tree.h
+// Written by Weston Cook
+// Defines the class AABBTree
+
+#ifndef BRAZEN_AABB_TREE_H
+#define BRAZEN_AABB_TREE_H
+
+#include "aabb.h"
+#include <vector>  // std::vector
+#include <algorithm>  // std::sort, std::max
+#include <cmath>  // std::abs
+#include <limits>  // std::numeric_limits
+#include <cstdint>  // std::uint8_t, std::int32_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Class AABBTree - dynamic bounding volume hierarchy over N-dimensional boxes.
+
+	Every box is stored in a leaf under a "fat" copy grown by a margin, so a box that moves a little stays
+	inside its leaf and the tree is left alone. Only when a box leaves its fat box is its leaf removed and
+	reinserted, refitting the boxes of its ancestors. Leaves are inserted next to the sibling that grows the
+	tree's total perimeter the least, and AVL-style rotations keep the tree balanced, so box and ray queries
+	are O(log n) for a scene of well-separated objects.
+
+	Boxes are identified by an index chosen by the caller ("key"), e.g. the index of the object they bound.
+	*/
+	template <std::uint8_t _Size>
+	class AABBTree {
+	private:
+		static constexpr std::int32_t NULL_NODE = -1;
+
+		/*
+		Struct Node - a leaf (one box) or an internal node (the union of its two children's boxes).
+		*/
+		struct Node {
+			AABB<_Size> box;  // Fat box of a leaf, or the box containing both children
+			std::int32_t parent;  // Also the next free node while the node is unused
+			std::int32_t child1, child2;  // NULL_NODE for leaves
+			std::int32_t height;  // 0 for leaves, -1 for unused nodes
+			std::uint32_t key;  // Caller's index for the box of a leaf
+
+			bool isLeaf(void) const { return child1 == NULL_NODE; }
+		};
+
+		// ATTRIBUTES
+		std::vector<Node> nodes;  // Node pool
+		std::int32_t root;
+		std::int32_t free_list;  // First unused node in "nodes"
+		double margin;  // How far fat boxes extend beyond the boxes they contain
+		std::vector<std::int32_t> leaf_of;  // Leaf node holding the box with each key, or NULL_NODE
+		std::vector<std::int32_t> stack;  // Traversal stack reused by queries
+		std::vector<BoxPair> pairs;  // Output of the last call to "findPairs()"
+
+		std::int32_t allocateNode(void);
+		void freeNode(std::int32_t node);
+		void insertLeaf(std::int32_t leaf);
+		void removeLeaf(std::int32_t leaf);
+		// Rotate the tree at "a" if it is imbalanced. Return the node now at a's position.
+		std::int32_t balance(std::int32_t a);
+		// Recompute the boxes and heights of "node" and its ancestors, rebalancing on the way up.
+		void refitAncestors(std::int32_t node);
+	public:
+		// CONSTRUCTORS
+		AABBTree(double margin = .1) :
+			root(NULL_NODE), free_list(NULL_NODE), margin(margin)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Set how far fat boxes extend beyond the boxes they contain. Applies to boxes inserted afterwards.
+		void setMargin(double m) { margin = m; }
+
+		// Insert the box with the given key, or move it if it is already in the tree.
+		//	Return whether the tree changed (the box left its fat box or was new).
+		bool update(std::uint32_t key, const AABB<_Size>& box);
+		// Make the tree hold exactly "boxes," box i under key i.
+		void update(const std::vector<AABB<_Size> >& boxes);
+		// Remove the box with the given key, if it is in the tree.
+		void remove(std::uint32_t key);
+
+		// Call "callback(key)" for every box whose fat box overlaps "box." Stops early if the callback returns false.
+		template <typename Callback>
+		void query(const AABB<_Size>& box, Callback callback);
+		// Call "callback(key, t)" for every box whose fat box the ray origin + t * direction, 0 <= t <= max_t, enters
+		//	at t. The callback returns the new max_t: max_t to keep going, t to only look for closer boxes, 0 to stop.
+		template <typename Callback>
+		void rayCast(const Tuple<_Size>& origin, const Tuple<_Size>& direction, double max_t, Callback callback);
+
+		// Make the tree hold exactly "boxes" and return every pair of overlapping boxes, each once, sorted.
+		//	The reference stays valid until the next call.
+		const std::vector<BoxPair>& findPairs(const std::vector<AABB<_Size> >& boxes);
+
+		// Return the height of the tree (0 for a single leaf, -1 when empty).
+		std::int32_t height(void) const { return root == NULL_NODE ? -1 : nodes[root].height; }
+	};
+
+
+	template <std::uint8_t _Size>
+	std::int32_t AABBTree<_Size>::allocateNode(void) {
+		if (free_list == NULL_NODE) {
+			nodes.push_back(Node());
+			nodes.back().parent = free_list;
+			free_list = (std::int32_t)nodes.size() - 1;
+		}
+
+		std::int32_t node = free_list;
+		free_list = nodes[node].parent;
+		nodes[node].parent = NULL_NODE;
+		nodes[node].child1 = NULL_NODE;
+		nodes[node].child2 = NULL_NODE;
+		nodes[node].height = 0;
+
+		return node;
+	}
+
+	template <std::uint8_t _Size>
+	void AABBTree<_Size>::freeNode(std::int32_t node) {
+		nodes[node].parent = free_list;
+		nodes[node].height = -1;
+		free_list = node;
+	}
+
+	template <std::uint8_t _Size>
+	void AABBTree<_Size>::insertLeaf(std::int32_t leaf) {
+		if (root == NULL_NODE) {
+			root = leaf;
+			nodes[root].parent = NULL_NODE;
+			return;
+		}
+
+		// Descend to the sibling that grows the total perimeter of the tree the least
+		const AABB<_Size> leaf_box = nodes[leaf].box;
+		std::int32_t index = root;
+		while (!nodes[index].isLeaf()) {
+			std::int32_t child1 = nodes[index].child1, child2 = nodes[index].child2;
+			double perimeter = nodes[index].box.perimeter();
+			double combined_perimeter = merge(nodes[index].box, leaf_box).perimeter();
+
+			// Cost of making the leaf and this node siblings under a new parent, and the growth this node
+			//	undergoes if the leaf descends further
+			double cost = 2. * combined_perimeter;
+			double inheritance_cost = 2. * (combined_perimeter - perimeter);
+
+			double cost1 = merge(leaf_box, nodes[child1].box).perimeter() + inheritance_cost;
+			if (!nodes[child1].isLeaf())
+				cost1 -= nodes[child1].box.perimeter();
+			double cost2 = merge(leaf_box, nodes[child2].box).perimeter() + inheritance_cost;
+			if (!nodes[child2].isLeaf())
+				cost2 -= nodes[child2].box.perimeter();
+
+			if (cost < cost1 && cost < cost2)
+				break;
+			index = cost1 < cost2 ? child1 : child2;
+		}
+		std::int32_t sibling = index;
+
+		// Create a new parent for the leaf and its sibling
+		std::int32_t old_parent = nodes[sibling].parent;
+		std::int32_t new_parent = allocateNode();
+		nodes[new_parent].parent = old_parent;
+		nodes[new_parent].box = merge(leaf_box, nodes[sibling].box);
+		nodes[new_parent].height = nodes[sibling].height + 1;
+		nodes[new_parent].child1 = sibling;
+		nodes[new_parent].child2 = leaf;
+		nodes[sibling].parent = new_parent;
+		nodes[leaf].parent = new_parent;
+
+		if (old_parent == NULL_NODE)
+			root = new_parent;
+		else if (nodes[old_parent].child1 == sibling)
+			nodes[old_parent].child1 = new_parent;
+		else
+			nodes[old_parent].child2 = new_parent;
+
+		refitAncestors(old_parent);
+	}
+
+	template <std::uint8_t _Size>
+	void AABBTree<_Size>::removeLeaf(std::int32_t leaf) {
+		if (leaf == root) {
+			root = NULL_NODE;
+			return;
+		}
+
+		// Replace the leaf's parent with the leaf's sibling
+		std::int32_t parent = nodes[leaf].parent;
+		std::int32_t grandparent = nodes[parent].parent;
+		std::int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		nodes[sibling].parent = grandparent;
+		freeNode(parent);
+
+		if (grandparent == NULL_NODE) {
+			root = sibling;
+			return;
+		}
+		if (nodes[grandparent].child1 == parent)
+			nodes[grandparent].child1 = sibling;
+		else
+			nodes[grandparent].child2 = sibling;
+
+		refitAncestors(grandparent);
+	}
+
+	template <std::uint8_t _Size>
+	void AABBTree<_Size>::refitAncestors(std::int32_t node) {
+		while (node != NULL_NODE) {
+			node = balance(node);
+
+			Node& n = nodes[node];
+			n.box = merge(nodes[n.child1].box, nodes[n.child2].box);
+			n.height = 1 + std::max(nodes[n.child1].height, nodes[n.child2].height);
+
+			node = n.parent;
+		}
+	}
+
+	template <std::uint8_t _Size>
+	std::int32_t AABBTree<_Size>::balance(std::int32_t a) {
+		if (nodes[a].isLeaf() || nodes[a].height < 2)
+			return a;
+
+		std::int32_t b = nodes[a].child1, c = nodes[a].child2;
+		std::int32_t difference = nodes[c].height - nodes[b].height;
+
+		if (difference > 1 || difference < -1) {
+			// Rotate the taller child "up" into a's place. "up_child" is the taller child, "down_child" the other one.
+			bool c_is_taller = difference > 1;
+			std::int32_t up = c_is_taller ? c : b;
+			std::int32_t down = c_is_taller ? b : c;
+			std::int32_t f = nodes[up].child1, g = nodes[up].child2;
+
+			// Swap a and "up"
+			nodes[up].child1 = a;
+			nodes[up].parent = nodes[a].parent;
+			nodes[a].parent = up;
+
+			if (nodes[up].parent == NULL_NODE)
+				root = up;
+			else if (nodes[nodes[up].parent].child1 == a)
+				nodes[nodes[up].parent].child1 = up;
+			else
+				nodes[nodes[up].parent].child2 = up;
+
+			// Keep the taller grandchild under "up" and give the shorter one to a
+			std::int32_t keep = nodes[f].height > nodes[g].height ? f : g;
+			std::int32_t give = keep == f ? g : f;
+			nodes[up].child2 = keep;
+			if (c_is_taller)
+				nodes[a].child2 = give;
+			else
+				nodes[a].child1 = give;
+			nodes[give].parent = a;
+
+			nodes[a].box = merge(nodes[down].box, nodes[give].box);
+			nodes[a].height = 1 + std::max(nodes[down].height, nodes[give].height);
+			nodes[up].box = merge(nodes[a].box, nodes[keep].box);
+			nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+
+			return up;
+		}
+
+		return a;
+	}
+
+	template <std::uint8_t _Size>
+	bool AABBTree<_Size>::update(std::uint32_t key, const AABB<_Size>& box) {
+		if (key >= leaf_of.size())
+			leaf_of.resize(key + 1, NULL_NODE);
+
+		std::int32_t leaf = leaf_of[key];
+		if (leaf == NULL_NODE) {
+			leaf = allocateNode();
+			leaf_of[key] = leaf;
+			nodes[leaf].key = key;
+		}
+		else if (nodes[leaf].box.contains(box))
+			return false;  // Still inside its fat box
+		else
+			removeLeaf(leaf);
+
+		nodes[leaf].box = box;
+		nodes[leaf].box.fatten(margin);
+		insertLeaf(leaf);
+
+		return true;
+	}
+
+	template <std::uint8_t _Size>
+	void AABBTree<_Size>::update(const std::vector<AABB<_Size> >& boxes) {
+		for (std::uint32_t key = (std::uint32_t)boxes.size(); key < leaf_of.size(); key++)
+			remove(key);
+
+		for (std::uint32_t key = 0; key < boxes.size(); key++)
+			update(key, boxes[key]);
+	}
+
+	template <std::uint8_t _Size>
+	void AABBTree<_Size>::remove(std::uint32_t key) {
+		if (key >= leaf_of.size() || leaf_of[key] == NULL_NODE)
+			return;
+
+		removeLeaf(leaf_of[key]);
+		freeNode(leaf_of[key]);
+		leaf_of[key] = NULL_NODE;
+	}
+
+	template <std::uint8_t _Size>
+	template <typename Callback>
+	void AABBTree<_Size>::query(const AABB<_Size>& box, Callback callback) {
+		stack.clear();
+		if (root != NULL_NODE)
+			stack.push_back(root);
+
+		while (!stack.empty()) {
+			const Node& n = nodes[stack.back()];
+			stack.pop_back();
+
+			if (!n.box.overlaps(box))
+				continue;
+
+			if (n.isLeaf()) {
+				if (!callback(n.key))
+					return;
+			}
+			else {
+				stack.push_back(n.child1);
+				stack.push_back(n.child2);
+			}
+		}
+	}
+
+	template <std::uint8_t _Size>
+	template <typename Callback>
+	void AABBTree<_Size>::rayCast(const Tuple<_Size>& origin, const Tuple<_Size>& direction, double max_t, Callback callback) {
+		stack.clear();
+		if (root != NULL_NODE)
+			stack.push_back(root);
+
+		while (!stack.empty() && max_t > 0.) {
+			const Node& n = nodes[stack.back()];
+			stack.pop_back();
+
+			// Slab test: intersect the ray's parameter interval with the box's interval along every axis
+			double t_enter = 0., t_exit = max_t;
+			for (std::uint8_t i = 0; i < _Size && t_enter <= t_exit; i++) {
+				if (std::abs(direction[i]) < std::numeric_limits<double>::min()) {
+					// Parallel to this slab
+					if (origin[i] < n.box.min[i] || n.box.max[i] < origin[i])
+						t_enter = std::numeric_limits<double>::infinity();
+				}
+				else {
+					double t1 = (n.box.min[i] - origin[i]) / direction[i];
+					double t2 = (n.box.max[i] - origin[i]) / direction[i];
+					t_enter = std::max(t_enter, std::min(t1, t2));
+					t_exit = std::min(t_exit, std::max(t1, t2));
+				}
+			}
+			if (t_enter > t_exit)
+				continue;  // Missed
+
+			if (n.isLeaf())
+				max_t = std::min(max_t, callback(n.key, t_enter));
+			else {
+				stack.push_back(n.child1);
+				stack.push_back(n.child2);
+			}
+		}
+	}
+
+	template <std::uint8_t _Size>
+	const std::vector<BoxPair>& AABBTree<_Size>::findPairs(const std::vector<AABB<_Size> >& boxes) {
+		update(boxes);
+		pairs.clear();
+
+		// Query every box against the tree, keeping each pair once
+		for (std::uint32_t a = 0; a < boxes.size(); a++)
+			query(boxes[a], [this, a, &boxes](std::uint32_t b) {
+				if (a < b && boxes[a].overlaps(boxes[b]))
+					pairs.push_back(BoxPair(a, b));
+				return true;
+			});
+
+		std::sort(pairs.begin(), pairs.end());
+
+		return pairs;
+	}
+}
+
+#endif
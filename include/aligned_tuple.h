@@ -0,0 +1,325 @@
+/*
+//
+// aligned_tuple.h
+//
+// Author: Weston Cook
+//
+// Distributed under the Mozilla Public Lincence 2.0
+//
+// Description:
+//	Defines the template struct AlignedTuple, a padded, 32-byte aligned 3- or 4-tuple of doubles
+//		whose operations are implemented with SSE2 or AVX.
+//
+*/
+
+#ifndef BRAZEN_ALIGNED_TUPLE_H
+#define BRAZEN_ALIGNED_TUPLE_H
+
+#include "tuple.h"
+#include <cstdint>  // std::uint8_t
+#include <cmath>  // std::sqrt
+
+// The instruction set is picked at compile time, since these operations are too small to dispatch at run time:
+//	AVX when compiling with -mavx (AVX2 adds a shuffle-based cross product), otherwise SSE2, which every x86-64 CPU has.
+//	Define BRAZEN_NO_SIMD for the portable implementation.
+#if !defined(BRAZEN_NO_SIMD) && defined(__AVX__)
+#define BRAZEN_ALIGNED_TUPLE_AVX
+#include <immintrin.h>
+#elif !defined(BRAZEN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define BRAZEN_ALIGNED_TUPLE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+/*
+//
+// Struct AlignedTuple - opt-in SIMD-friendly alternative to Tuple<3> and Tuple<4>.
+//
+// Always stores 4 doubles on a 32-byte boundary, so the whole tuple is one AVX register (or two SSE2
+//	registers) and loads and stores never split a cache line. A 3-tuple keeps its fourth lane at zero,
+//	which lets dot products and magnitudes run over all 4 lanes.
+//
+// Converts to and from Tuple<_Size>, so hot loops can switch to AlignedTuple without touching the rest
+//	of the code. Results match Tuple's operations up to the order the dot product sums its terms in.
+//
+*/
+template <std::uint8_t _Size>
+struct alignas(32) AlignedTuple {
+	static_assert(_Size == 3 || _Size == 4, "AlignedTuple is only defined for 3- and 4-tuples.");
+
+	double value[4];
+
+	// Initialize with all zeros if zeros is true. Otherwise the padding lane is still zeroed.
+	AlignedTuple(bool zeros = true) {
+		if (zeros)
+			setZero();
+		else
+			value[3] = 0.;
+	}
+
+	// Initialize with the given values
+	AlignedTuple(double x, double y, double z) :
+		value{ x, y, z, 0. }
+	{
+		static_assert(_Size == 3, "A 4-tuple needs 4 values.");
+	}
+	AlignedTuple(double x, double y, double z, double w) :
+		value{ x, y, z, w }
+	{
+		static_assert(_Size == 4, "A 3-tuple needs 3 values.");
+	}
+
+	// Initialize with the given Tuple
+	explicit AlignedTuple(const Tuple<_Size>& v) :
+		value{ v[0], v[1], v[2], _Size == 4 ? v[_Size - 1] : 0. }
+	{}
+
+	// Return a copy as a Tuple
+	explicit operator Tuple<_Size>(void) const {
+		Tuple<_Size> out(false);
+
+		for (std::uint8_t i = 0; i < _Size; i++)
+			out[i] = value[i];
+
+		return out;
+	}
+
+
+	// Index the components - mutable. Unchecked.
+	double& operator[](std::uint8_t i) {
+		return value[i];
+	}
+
+	// Index the components - immutable. Unchecked.
+	double operator[](std::uint8_t i) const {
+		return value[i];
+	}
+
+
+	// Set all components to zero
+	void setZero(void) {
+		for (std::uint8_t i = 0; i < 4; i++)
+			value[i] = 0.;
+	}
+};
+
+
+/*************TUPLE HELPER FUNCTIONS***********/
+// Every function has an AVX, an SSE2 and a portable implementation, selected when compiling.
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+// Sum the 4 lanes
+inline double horizontalSum(__m256d v) {
+	__m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+// Sum the 2 lanes of both halves
+inline double horizontalSum(__m128d lo, __m128d hi) {
+	__m128d sum = _mm_add_pd(lo, hi);
+	return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+#endif
+
+
+/*************NOT IN PLACE************/
+// SCALAR VECTOR MULTIPLICATION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size> operator*(const AlignedTuple<_Size>& v, double s) {
+	AlignedTuple<_Size> out(false);
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	_mm256_store_pd(out.value, _mm256_mul_pd(_mm256_load_pd(v.value), _mm256_set1_pd(s)));
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+	__m128d scale = _mm_set1_pd(s);
+	_mm_store_pd(out.value, _mm_mul_pd(_mm_load_pd(v.value), scale));
+	_mm_store_pd(out.value + 2, _mm_mul_pd(_mm_load_pd(v.value + 2), scale));
+#else
+	for (std::uint8_t i = 0; i < 4; i++)
+		out.value[i] = v.value[i] * s;
+#endif
+	return out;
+}
+
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size> operator*(double s, const AlignedTuple<_Size>& v) {
+	return v * s;
+}
+
+
+// SCALAR VECTOR DIVISION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size> operator/(const AlignedTuple<_Size>& v, double s) {
+	// The padding lane of a 3-tuple is zeroed again in registers, since 0 / 0 would leave NaN in it.
+	//	(Patching it in memory after the vector store would stall the next vector load of the tuple.)
+	AlignedTuple<_Size> out(false);
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	__m256d quotient = _mm256_div_pd(_mm256_load_pd(v.value), _mm256_set1_pd(s));
+	if (_Size == 3)
+		quotient = _mm256_blend_pd(quotient, _mm256_setzero_pd(), 0x8);
+	_mm256_store_pd(out.value, quotient);
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+	__m128d divisor = _mm_set1_pd(s);
+	__m128d hi = _mm_div_pd(_mm_load_pd(v.value + 2), divisor);
+	if (_Size == 3)
+		hi = _mm_move_sd(_mm_setzero_pd(), hi);
+	_mm_store_pd(out.value, _mm_div_pd(_mm_load_pd(v.value), divisor));
+	_mm_store_pd(out.value + 2, hi);
+#else
+	for (std::uint8_t i = 0; i < _Size; i++)
+		out.value[i] = v.value[i] / s;
+#endif
+	return out;
+}
+
+
+// VECTOR ADDITION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size> operator+(const AlignedTuple<_Size>& v1, const AlignedTuple<_Size>& v2) {
+	AlignedTuple<_Size> out(false);
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	_mm256_store_pd(out.value, _mm256_add_pd(_mm256_load_pd(v1.value), _mm256_load_pd(v2.value)));
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+	_mm_store_pd(out.value, _mm_add_pd(_mm_load_pd(v1.value), _mm_load_pd(v2.value)));
+	_mm_store_pd(out.value + 2, _mm_add_pd(_mm_load_pd(v1.value + 2), _mm_load_pd(v2.value + 2)));
+#else
+	for (std::uint8_t i = 0; i < 4; i++)
+		out.value[i] = v1.value[i] + v2.value[i];
+#endif
+	return out;
+}
+
+
+// VECTOR SUBTRACTION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size> operator-(const AlignedTuple<_Size>& v1, const AlignedTuple<_Size>& v2) {
+	AlignedTuple<_Size> out(false);
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	_mm256_store_pd(out.value, _mm256_sub_pd(_mm256_load_pd(v1.value), _mm256_load_pd(v2.value)));
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+	_mm_store_pd(out.value, _mm_sub_pd(_mm_load_pd(v1.value), _mm_load_pd(v2.value)));
+	_mm_store_pd(out.value + 2, _mm_sub_pd(_mm_load_pd(v1.value + 2), _mm_load_pd(v2.value + 2)));
+#else
+	for (std::uint8_t i = 0; i < 4; i++)
+		out.value[i] = v1.value[i] - v2.value[i];
+#endif
+	return out;
+}
+
+
+// DOT PRODUCT
+template <std::uint8_t _Size>
+inline double dot(const AlignedTuple<_Size>& v1, const AlignedTuple<_Size>& v2) {
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	return horizontalSum(_mm256_mul_pd(_mm256_load_pd(v1.value), _mm256_load_pd(v2.value)));
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+	return horizontalSum(_mm_mul_pd(_mm_load_pd(v1.value), _mm_load_pd(v2.value)),
+		_mm_mul_pd(_mm_load_pd(v1.value + 2), _mm_load_pd(v2.value + 2)));
+#else
+	return (v1.value[0] * v2.value[0] + v1.value[2] * v2.value[2]) + (v1.value[1] * v2.value[1] + v1.value[3] * v2.value[3]);
+#endif
+}
+
+
+// CROSS PRODUCT
+inline AlignedTuple<3> cross(const AlignedTuple<3>& v1, const AlignedTuple<3>& v2) {
+	AlignedTuple<3> out(false);
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX) && defined(__AVX2__)
+	// (y, z, x, 0) * (z, x, y, 0) - (z, x, y, 0) * (y, z, x, 0)
+	__m256d a = _mm256_load_pd(v1.value), b = _mm256_load_pd(v2.value);
+	__m256d a_yzx = _mm256_permute4x64_pd(a, 0xC9), b_yzx = _mm256_permute4x64_pd(b, 0xC9);
+	__m256d a_zxy = _mm256_permute4x64_pd(a, 0xD2), b_zxy = _mm256_permute4x64_pd(b, 0xD2);
+	_mm256_store_pd(out.value, _mm256_sub_pd(_mm256_mul_pd(a_yzx, b_zxy), _mm256_mul_pd(a_zxy, b_yzx)));
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2) || defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	// x and y as (y, z) * (z, x) - (z, x) * (y, z); z as the difference of the two lanes of (x, y) * (y, x)
+	__m128d a_lo = _mm_load_pd(v1.value), a_hi = _mm_load_pd(v1.value + 2);
+	__m128d b_lo = _mm_load_pd(v2.value), b_hi = _mm_load_pd(v2.value + 2);
+	__m128d a_yz = _mm_shuffle_pd(a_lo, a_hi, 1), a_zx = _mm_shuffle_pd(a_hi, a_lo, 0);
+	__m128d b_yz = _mm_shuffle_pd(b_lo, b_hi, 1), b_zx = _mm_shuffle_pd(b_hi, b_lo, 0);
+	__m128d products = _mm_mul_pd(a_lo, _mm_shuffle_pd(b_lo, b_lo, 1));
+	__m128d lo = _mm_sub_pd(_mm_mul_pd(a_yz, b_zx), _mm_mul_pd(a_zx, b_yz));
+	__m128d hi = _mm_move_sd(_mm_setzero_pd(), _mm_sub_sd(products, _mm_unpackhi_pd(products, products)));
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	// One 256-bit store, since the next 256-bit load of the result cannot be forwarded from two halves
+	_mm256_store_pd(out.value, _mm256_insertf128_pd(_mm256_castpd128_pd256(lo), hi, 1));
+#else
+	_mm_store_pd(out.value, lo);
+	_mm_store_pd(out.value + 2, hi);
+#endif
+#else
+	out.value[0] = v1.value[1] * v2.value[2] - v1.value[2] * v2.value[1];
+	out.value[1] = v1.value[2] * v2.value[0] - v1.value[0] * v2.value[2];
+	out.value[2] = v1.value[0] * v2.value[1] - v1.value[1] * v2.value[0];
+#endif
+	return out;
+}
+
+
+// MAGNITUDE
+template <std::uint8_t _Size>
+inline double magnitudeSquared(const AlignedTuple<_Size>& v) {
+	return dot(v, v);
+}
+
+template <std::uint8_t _Size>
+inline double magnitude(const AlignedTuple<_Size>& v) {
+	return std::sqrt(magnitudeSquared(v));
+}
+
+
+// UNIT
+template <std::uint8_t _Size>
+inline Brazen::Result<AlignedTuple<_Size> > checked_unit(const AlignedTuple<_Size>& v) {
+	double mag = magnitude(v);
+
+	if (mag > 0.)  // Unit vector is defined
+		return v / mag;
+	return Brazen::ErrorCode::ZERO_VECTOR;
+}
+
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size> unit(const AlignedTuple<_Size>& v, bool fake_it = true) {
+	double mag = magnitude(v);
+
+	if (mag > 0.)  // Unit vector is defined
+		return v / mag;
+	// Division by zero: same warning and fallback as "unit(const Tuple<_Size>&)"
+	return AlignedTuple<_Size>(unit(Tuple<_Size>(v), fake_it));
+}
+
+
+/***************IN PLACE OPERATIONS***************/
+// SCALAR VECTOR MULTIPLICATION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size>& operator*=(AlignedTuple<_Size>& v, double s) {
+	return v = v * s;
+}
+
+
+// SCALAR VECTOR DIVISION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size>& operator/=(AlignedTuple<_Size>& v, double s) {
+	return v = v / s;
+}
+
+
+// VECTOR ADDITION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size>& operator+=(AlignedTuple<_Size>& v1, const AlignedTuple<_Size>& v2) {
+	return v1 = v1 + v2;
+}
+
+
+// VECTOR SUBTRACTION
+template <std::uint8_t _Size>
+inline AlignedTuple<_Size>& operator-=(AlignedTuple<_Size>& v1, const AlignedTuple<_Size>& v2) {
+	return v1 = v1 - v2;
+}
+
+
+// STREAM INSERTION
+template <std::uint8_t _Size>
+std::ostream& operator<<(std::ostream &s, const AlignedTuple<_Size>& v) {
+	return s << Tuple<_Size>(v);
+}
+
+
+#endif
@@ -0,0 +1,216 @@
+// block_sparse_matrix.h
+// Written by Weston Cook
+// Defines the class BlockSparseMatrix and a preconditioned conjugate gradient solver for it
+
+#ifndef BRAZEN_BLOCK_SPARSE_MATRIX_H
+#define BRAZEN_BLOCK_SPARSE_MATRIX_H
+
+#include "thread_pool.h"
+#include <vector>  // std::vector
+#include <utility>  // std::pair
+#include <algorithm>  // std::sort, std::unique, std::lower_bound, std::fill
+#include <cmath>  // std::sqrt
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Class BlockSparseMatrix - a square sparse matrix of _Size x _Size blocks in compressed sparse row form.
+
+	The sparsity pattern (which blocks exist) is set once by "setPattern()"; after that only the block values change,
+	so a matrix assembled every step from the same topology never reallocates or searches for a block again:
+	"blockIndex()" is looked up once per nonzero and the caller keeps the result.
+	Vectors are flat arrays of rowCount() * _Size scalars.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	class BlockSparseMatrix {
+	private:
+		// ATTRIBUTES
+		static constexpr std::uint32_t BLOCK = _Size * _Size;  // Scalars per block, row-major
+
+		std::vector<std::uint32_t> row_offsets;  // Blocks of row r are [row_offsets[r], row_offsets[r + 1])
+		std::vector<std::uint32_t> columns;  // Block column of every block, ascending within a row
+		std::vector<std::uint32_t> diagonal;  // Index of the diagonal block of every row
+		std::vector<_Scalar> values;  // BLOCK scalars per block
+	public:
+		// MEMBER FUNCTIONS
+		// Set the pattern to a diagonal block in each of "row_count" rows plus a block at (r, c) and (c, r) for every
+		//	given pair. Duplicate pairs share a block. Zeroes every value.
+		void setPattern(std::uint32_t row_count, const std::vector<std::pair<std::uint32_t, std::uint32_t> >& pairs);
+
+		// Return the number of block rows.
+		std::uint32_t rowCount(void) const { return row_offsets.empty() ? 0 : (std::uint32_t)row_offsets.size() - 1; }
+		// Return the number of stored blocks.
+		std::uint32_t blockCount(void) const { return (std::uint32_t)columns.size(); }
+		// Return the index of block (row, column), which must be in the pattern.
+		std::uint32_t blockIndex(std::uint32_t row, std::uint32_t column) const;
+		// Return the index of the diagonal block of the given row.
+		std::uint32_t diagonalIndex(std::uint32_t row) const { return diagonal[row]; }
+
+		// Return the scalars of the block with the given index, row-major.
+		_Scalar* block(std::uint32_t index) { return values.data() + index * BLOCK; }
+		const _Scalar* block(std::uint32_t index) const { return values.data() + index * BLOCK; }
+		// Zero every value, keeping the pattern.
+		void setZero(void) { std::fill(values.begin(), values.end(), _Scalar(0)); }
+
+		// y = A * x for block rows [begin, end)
+		void multiply(const _Scalar* x, _Scalar* y, std::uint32_t begin, std::uint32_t end) const;
+		// y = A * x, split across the pool's threads if there is one.
+		void multiply(const _Scalar* x, _Scalar* y, ThreadPool* pool) const;
+	};
+
+
+	/*
+	Struct ConjugateGradientResult - how a "conjugateGradient()" solve ended.
+	*/
+	struct ConjugateGradientResult {
+		std::uint32_t iterations;
+		double relative_residual;  // |b - A x| / |b| on return
+	};
+
+	// Solve A x = b for symmetric positive definite A by conjugate gradients with a Jacobi (diagonal) preconditioner.
+	//	"x" holds the initial guess and receives the solution. Stops once |b - A x| <= tolerance * |b| or after
+	//	"max_iterations." Matrix products are split across the pool's threads if there is one.
+	template <std::uint8_t _Size, typename _Scalar>
+	ConjugateGradientResult conjugateGradient(const BlockSparseMatrix<_Size, _Scalar>& A, const std::vector<_Scalar>& b, std::vector<_Scalar>& x,
+		double tolerance, std::uint32_t max_iterations, ThreadPool* pool = nullptr);
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void BlockSparseMatrix<_Size, _Scalar>::setPattern(std::uint32_t row_count, const std::vector<std::pair<std::uint32_t, std::uint32_t> >& pairs) {
+		// Count the blocks of every row, then place them
+		std::vector<std::uint32_t> count(row_count, 1);  // The diagonal block
+		for (const std::pair<std::uint32_t, std::uint32_t>& pair : pairs) {
+			count[pair.first]++;
+			count[pair.second]++;
+		}
+
+		row_offsets.assign(row_count + 1, 0);
+		for (std::uint32_t r = 0; r < row_count; r++)
+			row_offsets[r + 1] = row_offsets[r] + count[r];
+
+		columns.resize(row_offsets[row_count]);
+		std::vector<std::uint32_t> next(row_offsets.begin(), row_offsets.end() - 1);
+		for (std::uint32_t r = 0; r < row_count; r++)
+			columns[next[r]++] = r;
+		for (const std::pair<std::uint32_t, std::uint32_t>& pair : pairs) {
+			columns[next[pair.first]++] = pair.second;
+			columns[next[pair.second]++] = pair.first;
+		}
+
+		// Sort every row and drop duplicate blocks, compacting in place
+		std::uint32_t kept = 0;
+		for (std::uint32_t r = 0; r < row_count; r++) {
+			std::vector<std::uint32_t>::iterator first = columns.begin() + row_offsets[r], last = columns.begin() + row_offsets[r + 1];
+			std::sort(first, last);
+			last = std::unique(first, last);
+
+			row_offsets[r] = kept;
+			for (; first != last; ++first)
+				columns[kept++] = *first;
+		}
+		row_offsets[row_count] = kept;
+		columns.resize(kept);
+
+		diagonal.resize(row_count);
+		for (std::uint32_t r = 0; r < row_count; r++)
+			diagonal[r] = blockIndex(r, r);
+		values.assign(kept * BLOCK, _Scalar(0));
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	std::uint32_t BlockSparseMatrix<_Size, _Scalar>::blockIndex(std::uint32_t row, std::uint32_t column) const {
+		return (std::uint32_t)(std::lower_bound(columns.begin() + row_offsets[row], columns.begin() + row_offsets[row + 1], column) - columns.begin());
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void BlockSparseMatrix<_Size, _Scalar>::multiply(const _Scalar* x, _Scalar* y, std::uint32_t begin, std::uint32_t end) const {
+		for (std::uint32_t r = begin; r < end; r++) {
+			_Scalar sum[_Size] = {};
+
+			for (std::uint32_t b = row_offsets[r]; b < row_offsets[r + 1]; b++) {
+				const _Scalar* a = block(b);
+				const _Scalar* xc = x + columns[b] * _Size;
+				for (std::uint8_t i = 0; i < _Size; i++)
+					for (std::uint8_t j = 0; j < _Size; j++)
+						sum[i] += a[i * _Size + j] * xc[j];
+			}
+
+			for (std::uint8_t i = 0; i < _Size; i++)
+				y[r * _Size + i] = sum[i];
+		}
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void BlockSparseMatrix<_Size, _Scalar>::multiply(const _Scalar* x, _Scalar* y, ThreadPool* pool) const {
+		if (pool)
+			pool->parallelFor(0, rowCount(), 1024, [this, x, y](std::uint32_t begin, std::uint32_t end) { multiply(x, y, begin, end); });
+		else
+			multiply(x, y, 0, rowCount());
+	}
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	ConjugateGradientResult conjugateGradient(const BlockSparseMatrix<_Size, _Scalar>& A, const std::vector<_Scalar>& b, std::vector<_Scalar>& x,
+		double tolerance, std::uint32_t max_iterations, ThreadPool* pool) {
+		const std::uint32_t n = A.rowCount() * _Size;
+		std::vector<_Scalar> r(n), z(n), p(n), Ap(n), inverse_diagonal(n);
+		ConjugateGradientResult result = { 0, 0. };
+
+		for (std::uint32_t row = 0; row < A.rowCount(); row++)
+			for (std::uint8_t i = 0; i < _Size; i++) {
+				const _Scalar d = A.block(A.diagonalIndex(row))[i * _Size + i];
+				inverse_diagonal[row * _Size + i] = d > 0 ? _Scalar(1) / d : _Scalar(1);
+			}
+
+		double b_norm_squared = 0.;
+		for (std::uint32_t k = 0; k < n; k++)
+			b_norm_squared += (double)b[k] * b[k];
+		if (b_norm_squared == 0.) {  // x = 0 solves it exactly
+			std::fill(x.begin(), x.end(), _Scalar(0));
+			return result;
+		}
+
+		// r = b - A x, z = M^-1 r, p = z
+		A.multiply(x.data(), Ap.data(), pool);
+		double rz = 0., r_norm_squared = 0.;
+		for (std::uint32_t k = 0; k < n; k++) {
+			r[k] = b[k] - Ap[k];
+			z[k] = r[k] * inverse_diagonal[k];
+			p[k] = z[k];
+			rz += (double)r[k] * z[k];
+			r_norm_squared += (double)r[k] * r[k];
+		}
+
+		const double threshold = tolerance * tolerance * b_norm_squared;
+		while (r_norm_squared > threshold && result.iterations < max_iterations) {
+			A.multiply(p.data(), Ap.data(), pool);
+			double pAp = 0.;
+			for (std::uint32_t k = 0; k < n; k++)
+				pAp += (double)p[k] * Ap[k];
+			if (!(pAp > 0.))  // Not positive definite along p: no further progress is possible
+				break;
+
+			const _Scalar alpha = rz / pAp;
+			double next_rz = 0.;
+			r_norm_squared = 0.;
+			for (std::uint32_t k = 0; k < n; k++) {
+				x[k] += alpha * p[k];
+				r[k] -= alpha * Ap[k];
+				z[k] = r[k] * inverse_diagonal[k];
+				next_rz += (double)r[k] * z[k];
+				r_norm_squared += (double)r[k] * r[k];
+			}
+
+			const _Scalar beta = next_rz / rz;
+			rz = next_rz;
+			for (std::uint32_t k = 0; k < n; k++)
+				p[k] = z[k] + beta * p[k];
+			result.iterations++;
+		}
+
+		result.relative_residual = std::sqrt(r_norm_squared / b_norm_squared);
+		return result;
+	}
+}
+
+#endif
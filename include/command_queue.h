@@ -0,0 +1,189 @@
+// command_queue.h
+// Written by Weston Cook
+// Defines the struct CommandBatch and the class CommandQueue
+
+#ifndef BRAZEN_COMMAND_QUEUE_H
+#define BRAZEN_COMMAND_QUEUE_H
+
+#include "particle.h"
+#include "topology.h"
+#include "validation.h"
+#include <vector>  // std::vector
+#include <iterator>  // std::make_move_iterator
+#include <mutex>  // std::mutex, std::lock_guard
+#include <utility>  // std::move, std::swap
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Struct CommandBatch - particles, springs and objects waiting to be added to a simulation, in the order they were
+	queued. Applying one adds every particle first, so springs and objects may refer to particles of the same batch.
+	*/
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	struct CommandBatch {
+		// ATTRIBUTES
+		std::vector<Particle<_Size, _Scalar> > particles;
+		std::vector<SpringType> springs;  // Including the springs of queued objects
+		std::vector<std::vector<std::uint32_t> > objects;  // Particle indices of every object
+
+		// MEMBER FUNCTIONS
+		// Return whether the batch holds nothing to apply.
+		bool empty(void) const { return particles.empty() && springs.empty() && objects.empty(); }
+		// Remove every command, keeping the storage for the next batch.
+		void clear(void) {
+			particles.clear();
+			springs.clear();
+			objects.clear();
+		}
+	};
+
+
+	/*
+	Class CommandQueue - edits queued by any number of producer threads for a simulation to apply between steps.
+
+	Queueing only holds the queue's own mutex, for as long as it takes to append (or move) the data in, so a producer
+	never waits for a physics step, and the physics thread only holds it for the swap in "take()". Particles are given
+	their indices when they are queued, counting on from every particle queued before them, so later springs and
+	objects can refer to them straight away. Springs and objects are checked against those indices when they are
+	queued; a rejected call queues nothing and returns the ErrorCode saying why. With BRAZEN_NO_VALIDATION (see
+	"validation.h") nothing is checked and every call succeeds.
+	*/
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	class CommandQueue {
+	private:
+		// ATTRIBUTES
+		CommandBatch<_Size, _Scalar, SpringType> pending;  // Commands queued since the last "take()"
+		std::uint32_t issued_particle_count;  // Number of particle indices handed out so far
+		std::mutex queue_mutex;  // Serializes queueing and taking
+
+		// MEMBER FUNCTIONS
+		// Return whether every given index refers to an issued particle. "queue_mutex" must be held.
+		bool issued(const std::vector<std::uint32_t>& indices) const;
+	public:
+		// CONSTRUCTORS
+		CommandQueue(void) :
+			issued_particle_count(0)
+		{}
+		CommandQueue(const CommandQueue<_Size, _Scalar, SpringType>& q) = delete;
+
+		// MEMBER FUNCTIONS
+		// Queue copies of the particles in [first, last) and return the index the first one will have.
+		template <typename Iterator>
+		std::uint32_t addParticles(Iterator first, Iterator last);
+		// Queue the given springs (moved in), unless one refers to a particle that was never queued
+		//	(ErrorCode::INVALID_PARTICLE_INDEX).
+		Status addSprings(std::vector<SpringType> springs);
+		// Queue an object of the given particles, unless one was never queued (ErrorCode::INVALID_PARTICLE_INDEX).
+		Status addObject(std::vector<std::uint32_t> indices);
+		// Queue an object of the given particles and copies of "spring" along "edges" (which index "indices"), unless an
+		//	edge is out of range of "indices" (ErrorCode::INVALID_EDGE_INDEX) or a particle was never queued.
+		Status addObject(std::vector<std::uint32_t> indices, const std::vector<SpringEdge>& edges, SpringType spring);
+
+		// Return the number of particle indices handed out so far, applied or not.
+		std::uint32_t issuedParticleCount(void);
+		// Move every queued command into "batch," which must be empty, leaving the queue empty. Return whether there were any.
+		bool take(CommandBatch<_Size, _Scalar, SpringType>& batch);
+		// "take()," then hand out indices for "count" particles that the caller adds itself, straight after applying
+		//	"batch," without copying them through the queue. Return the first of those indices.
+		std::uint32_t takeAndIssue(CommandBatch<_Size, _Scalar, SpringType>& batch, std::uint32_t count);
+	};
+
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	bool CommandQueue<_Size, _Scalar, SpringType>::issued(const std::vector<std::uint32_t>& indices) const {
+		for (std::uint32_t index : indices)
+			if (index >= issued_particle_count)
+				return false;
+		return true;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	template <typename Iterator>
+	std::uint32_t CommandQueue<_Size, _Scalar, SpringType>::addParticles(Iterator first, Iterator last) {
+		std::lock_guard<std::mutex> queue_lock(queue_mutex);
+		const std::uint32_t first_index = issued_particle_count;
+		const std::size_t queued = pending.particles.size();
+
+		pending.particles.insert(pending.particles.end(), first, last);
+		issued_particle_count += (std::uint32_t)(pending.particles.size() - queued);
+		return first_index;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	Status CommandQueue<_Size, _Scalar, SpringType>::addSprings(std::vector<SpringType> springs) {
+		std::lock_guard<std::mutex> queue_lock(queue_mutex);
+		if (VALIDATION_ENABLED)
+			for (const SpringType& spring : springs)
+				if (spring.p1_index >= issued_particle_count || spring.p2_index >= issued_particle_count)
+					return ErrorCode::INVALID_PARTICLE_INDEX;
+
+		if (pending.springs.empty())
+			pending.springs = std::move(springs);
+		else
+			pending.springs.insert(pending.springs.end(), std::make_move_iterator(springs.begin()), std::make_move_iterator(springs.end()));
+		return ErrorCode::OK;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	Status CommandQueue<_Size, _Scalar, SpringType>::addObject(std::vector<std::uint32_t> indices) {
+		std::lock_guard<std::mutex> queue_lock(queue_mutex);
+		if (VALIDATION_ENABLED && !issued(indices))
+			return ErrorCode::INVALID_PARTICLE_INDEX;
+
+		pending.objects.push_back(std::move(indices));
+		return ErrorCode::OK;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	Status CommandQueue<_Size, _Scalar, SpringType>::addObject(std::vector<std::uint32_t> indices, const std::vector<SpringEdge>& edges, SpringType spring) {
+		if (VALIDATION_ENABLED)
+			for (const SpringEdge& edge : edges)
+				if (edge.p1_index >= indices.size() || edge.p2_index >= indices.size())
+					return ErrorCode::INVALID_EDGE_INDEX;
+
+		std::lock_guard<std::mutex> queue_lock(queue_mutex);
+		if (VALIDATION_ENABLED && !issued(indices))
+			return ErrorCode::INVALID_PARTICLE_INDEX;
+
+		for (const SpringEdge& edge : edges) {
+			spring.p1_index = indices[edge.p1_index];
+			spring.p2_index = indices[edge.p2_index];
+			pending.springs.push_back(spring);
+		}
+		pending.objects.push_back(std::move(indices));
+		return ErrorCode::OK;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	std::uint32_t CommandQueue<_Size, _Scalar, SpringType>::issuedParticleCount(void) {
+		std::lock_guard<std::mutex> queue_lock(queue_mutex);
+		return issued_particle_count;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	bool CommandQueue<_Size, _Scalar, SpringType>::take(CommandBatch<_Size, _Scalar, SpringType>& batch) {
+		std::lock_guard<std::mutex> queue_lock(queue_mutex);
+		if (pending.empty())
+			return false;
+
+		// Swapping hands the (cleared) storage of the last batch back to the queue
+		std::swap(pending.particles, batch.particles);
+		std::swap(pending.springs, batch.springs);
+		std::swap(pending.objects, batch.objects);
+		return true;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename SpringType>
+	std::uint32_t CommandQueue<_Size, _Scalar, SpringType>::takeAndIssue(CommandBatch<_Size, _Scalar, SpringType>& batch, std::uint32_t count) {
+		std::lock_guard<std::mutex> queue_lock(queue_mutex);
+		std::swap(pending.particles, batch.particles);
+		std::swap(pending.springs, batch.springs);
+		std::swap(pending.objects, batch.objects);
+
+		const std::uint32_t first_index = issued_particle_count;
+		issued_particle_count += count;
+		return first_index;
+	}
+}
+
+#endif
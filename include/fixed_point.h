@@ -0,0 +1,114 @@
+// fixed_point.h
+// Written by Weston Cook
+// Defines the struct Fixed32
+
+#ifndef BRAZEN_FIXED_POINT_H
+#define BRAZEN_FIXED_POINT_H
+
+#include <cstdint>  // std::int32_t, std::uint32_t, std::int64_t, std::uint64_t
+#include <cmath>  // std::llround
+#include <type_traits>  // std::enable_if, std::is_arithmetic
+#include <iostream>  // std::ostream
+#include <limits>  // std::numeric_limits
+
+namespace Brazen {
+	/*
+	Struct Fixed32 - signed 32-bit fixed-point number with 16 integer and 16 fractional bits.
+
+	Covers [-32768, 32768) with a resolution of 1/65536. Arithmetic is done in integers, so results are
+	identical on every platform and compiler, which makes it a drop-in scalar type for Tuple, Particle and
+	Simulator when simulations have to be reproducible bit for bit.
+
+	Converts implicitly from arithmetic types (rounding to the nearest step) but only explicitly back,
+	so mixed expressions such as "x * .5" are computed in fixed point rather than silently in double.
+	Products and quotients are rounded toward negative infinity; results out of range wrap around. Dividing by
+	zero saturates instead of trapping: to the largest or smallest Fixed32, after the sign of the dividend, and
+	0 / 0 is 0. That keeps "projection_vector()" of a zero vector, or of one too short to square, finite.
+	*/
+	struct Fixed32 {
+		// ATTRIBUTES
+		static constexpr int FRACTION_BITS = 16;
+		static constexpr std::int64_t ONE = std::int64_t(1) << FRACTION_BITS;
+
+		std::int32_t raw;  // Value * 2^16
+
+		// CONSTRUCTORS
+		Fixed32(void) :
+			raw(0)
+		{}
+		template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+		Fixed32(T v) :
+			raw((std::int32_t)std::llround((double)v * ONE))
+		{}
+
+		// Return the Fixed32 with the given raw representation.
+		static Fixed32 fromRaw(std::int32_t raw) {
+			Fixed32 out;
+			out.raw = raw;
+			return out;
+		}
+
+		// MEMBER FUNCTIONS
+		explicit operator double(void) const { return (double)raw / ONE; }
+		explicit operator float(void) const { return (float)raw / ONE; }
+
+		// Sums, differences and negations are taken in unsigned arithmetic, which wraps where signed overflow would be undefined.
+		Fixed32 operator-(void) const { return fromRaw((std::int32_t)(0u - (std::uint32_t)raw)); }
+
+		Fixed32& operator+=(Fixed32 b) { raw = (std::int32_t)((std::uint32_t)raw + (std::uint32_t)b.raw); return *this; }
+		Fixed32& operator-=(Fixed32 b) { raw = (std::int32_t)((std::uint32_t)raw - (std::uint32_t)b.raw); return *this; }
+		Fixed32& operator*=(Fixed32 b) { raw = (std::int32_t)(std::uint32_t)(((std::int64_t)raw * b.raw) >> FRACTION_BITS); return *this; }
+		Fixed32& operator/=(Fixed32 b);
+
+		friend Fixed32 operator+(Fixed32 a, Fixed32 b) { return a += b; }
+		friend Fixed32 operator-(Fixed32 a, Fixed32 b) { return a -= b; }
+		friend Fixed32 operator*(Fixed32 a, Fixed32 b) { return a *= b; }
+		friend Fixed32 operator/(Fixed32 a, Fixed32 b) { return a /= b; }
+
+		friend bool operator==(Fixed32 a, Fixed32 b) { return a.raw == b.raw; }
+		friend bool operator!=(Fixed32 a, Fixed32 b) { return a.raw != b.raw; }
+		friend bool operator<(Fixed32 a, Fixed32 b) { return a.raw < b.raw; }
+		friend bool operator<=(Fixed32 a, Fixed32 b) { return a.raw <= b.raw; }
+		friend bool operator>(Fixed32 a, Fixed32 b) { return a.raw > b.raw; }
+		friend bool operator>=(Fixed32 a, Fixed32 b) { return a.raw >= b.raw; }
+
+		// Found by argument-dependent lookup, so generic code can call "sqrt(x)" and "abs(x)" after "using std::sqrt, std::abs."
+		friend Fixed32 abs(Fixed32 a) { return a.raw < 0 ? -a : a; }
+		friend Fixed32 sqrt(Fixed32 a);
+
+		friend std::ostream& operator<<(std::ostream& s, Fixed32 a) { return s << (double)a; }
+	};
+
+
+	inline Fixed32& Fixed32::operator/=(Fixed32 b) {
+		if (b.raw == 0)  // Saturate, integer division by zero would trap
+			raw = raw > 0 ? std::numeric_limits<std::int32_t>::max() : raw < 0 ? std::numeric_limits<std::int32_t>::min() : 0;
+		else {
+			const std::int64_t dividend = (std::int64_t)raw * ONE;
+			std::int64_t quotient = dividend / b.raw;  // Truncated toward zero
+			if (dividend % b.raw != 0 && (dividend < 0) != (b.raw < 0))
+				quotient--;
+			raw = (std::int32_t)(std::uint32_t)quotient;
+		}
+		return *this;
+	}
+
+	// Integer square root of raw * 2^16, rounded down. Negative values have no square root and return 0.
+	inline Fixed32 sqrt(Fixed32 a) {
+		if (a.raw <= 0)
+			return Fixed32();
+
+		std::uint64_t n = (std::uint64_t)a.raw << Fixed32::FRACTION_BITS, root = 0;
+		for (std::uint64_t bit = std::uint64_t(1) << 46; bit != 0; bit >>= 2)  // Highest power of 4 <= 2^47
+			if (n >= root + bit) {
+				n -= root + bit;
+				root = (root >> 1) + bit;
+			}
+			else
+				root >>= 1;
+
+		return Fixed32::fromRaw((std::int32_t)root);
+	}
+}
+
+#endif
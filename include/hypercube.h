@@ -0,0 +1,79 @@
+// hypercube.h
+// Written by Weston Cook
+// Defines compile-time generators for the vertices and edges of N-dimensional hypercubes
+
+#ifndef BRAZEN_HYPERCUBE_H
+#define BRAZEN_HYPERCUBE_H
+
+#include "tuple.h"
+#include <array>  // std::array
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	// An edge of a hypercube, as the indices of its two vertices. Named like a spring's endpoints so
+	//	the table can be handed straight to spring construction.
+	struct HypercubeEdge {
+		std::uint32_t p1_index;
+		std::uint32_t p2_index;
+	};
+
+
+	// Number of vertices of an N-cube
+	template <std::uint8_t _Size>
+	constexpr std::uint32_t hypercubeVertexCount(void) {
+		static_assert(_Size >= 1 && _Size <= 16, "hypercube tables are limited to 16 dimensions");
+		return std::uint32_t(1) << _Size;
+	}
+
+	// Number of edges of an N-cube: each vertex has _Size neighbors, and each edge is shared by two vertices
+	template <std::uint8_t _Size>
+	constexpr std::uint32_t hypercubeEdgeCount(void) {
+		return _Size * (hypercubeVertexCount<_Size>() / 2);
+	}
+
+
+	/*
+	Return the vertices of the axis-aligned N-cube with the given side length and center.
+
+	Bit i of a vertex's index selects the sign of its component i, so vertices v and v ^ (1 << i) are the ends
+	of an edge along axis i. Usable in constant expressions: "constexpr auto cube = hypercubeVertices<4>(1.);"
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	constexpr std::array<Tuple<_Size, _Scalar>, hypercubeVertexCount<_Size>()> hypercubeVertices(_Scalar side, const Tuple<_Size, _Scalar>& center = Tuple<_Size, _Scalar>()) {
+		std::array<Tuple<_Size, _Scalar>, hypercubeVertexCount<_Size>()> vertices{};
+		const _Scalar half = side / 2;
+
+		for (std::uint32_t v = 0; v < hypercubeVertexCount<_Size>(); v++) {
+			Tuple<_Size, _Scalar> offset(false);
+			for (std::uint8_t i = 0; i < _Size; i++)
+				offset[i] = (v >> i & 1) ? half : -half;
+			vertices[v] = center + offset;
+		}
+
+		return vertices;
+	}
+
+	/*
+	Return the edges of the N-cube whose vertices "hypercubeVertices()" returns.
+
+	Edges are grouped by axis: all edges along axis 0 come first, each from the vertex with bit i clear to the one
+	with it set, in increasing vertex order.
+	*/
+	template <std::uint8_t _Size>
+	constexpr std::array<HypercubeEdge, hypercubeEdgeCount<_Size>()> hypercubeEdges(void) {
+		std::array<HypercubeEdge, hypercubeEdgeCount<_Size>()> edges{};
+		std::uint32_t e = 0;
+
+		for (std::uint8_t i = 0; i < _Size; i++)
+			for (std::uint32_t v = 0; v < hypercubeVertexCount<_Size>(); v++)
+				if (!(v >> i & 1)) {
+					edges[e].p1_index = v;
+					edges[e].p2_index = v | std::uint32_t(1) << i;
+					e++;
+				}
+
+		return edges;
+	}
+}
+
+#endif
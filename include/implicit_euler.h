@@ -0,0 +1,213 @@
+// implicit_euler.h
+// Written by Weston Cook
+// Defines the integrator policy ImplicitEuler
+
+#ifndef BRAZEN_IMPLICIT_EULER_H
+#define BRAZEN_IMPLICIT_EULER_H
+
+#include "tuple.h"
+#include "particle_store.h"
+#include "integrators.h"
+#include "spring.h"
+#include "block_sparse_matrix.h"
+#include "thread_pool.h"
+#include <vector>  // std::vector
+#include <utility>  // std::pair
+#include <algorithm>  // std::max
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Class ImplicitEuler - backward Euler on the springs, linearized once per step (Baraff and Witkin, "Large Steps in
+	Cloth Simulation"). Each step solves
+
+		(M - dt * df/dv - dt^2 * df/dx) dv = dt * (f + dt * df/dx * v)
+
+	for the velocity change dv of every dynamic particle, then moves it with its new velocity. Stiff springs that
+	make the explicit policies blow up past dt = 2 / omega only get damped here, so a stiff body can run at 60 Hz.
+
+	The springs come from "forces.springs" (see "SpringForces"), and the policy evaluates them itself, taking each
+	force from "Spring::force()" and differentiating it along the spring's axis. "forces()" is never called. The
+	transverse stiffness of a compressed spring is left out of df/dx, which keeps the system positive definite so it
+	can be solved by conjugate gradients (see "conjugateGradient()"), warm started from the last step's dv.
+
+	The matrix has a block per dynamic particle and per pair of dynamic particles joined by a spring. That pattern only
+	changes with the spring topology or the particle order, so it is built on the first step after "reset()" and
+	every later step just refills the blocks it found then.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	class ImplicitEuler {
+	private:
+		// ATTRIBUTES
+		static constexpr std::uint32_t NO_ROW = 0xffffffffu;  // Row of a particle that is not solved for
+
+		/*
+		Struct SpringBlocks - where one spring's terms go: the rows of its particles and its two off-diagonal blocks.
+		*/
+		struct SpringBlocks {
+			std::uint32_t row1, row2;  // NO_ROW for a static particle
+			std::uint32_t block12, block21;  // NO_ROW unless both particles have rows
+		};
+
+		BlockSparseMatrix<_Size, _Scalar> system;  // M - dt * df/dv - dt^2 * df/dx over the dynamic particles
+		std::vector<std::uint32_t> row_of;  // Row of every particle, or NO_ROW
+		std::vector<std::uint32_t> particle_of;  // Particle of every row
+		std::vector<SpringBlocks> spring_blocks;  // Blocks of every spring, in spring order
+		std::vector<_Scalar> rhs, delta_vel;  // Right hand side and solution, rows * _Size scalars
+		bool pattern_valid;  // Whether the pattern still matches the particles and springs
+		std::uint32_t pattern_builds;  // Number of times the pattern was built
+
+		double tolerance;  // Relative residual the solve stops at
+		std::uint32_t max_iterations;  // Conjugate gradient iterations allowed per step
+		ConjugateGradientResult last_solve;  // How the last step's solve ended
+
+		// MEMBER FUNCTIONS
+		// Number the dynamic particles and find the blocks of every spring.
+		void buildPattern(const ParticleStore<_Size, _Scalar>& particles, const std::vector<Spring<_Size, _Scalar> >& springs);
+	public:
+		// CONSTRUCTORS
+		ImplicitEuler(void) :
+			pattern_valid(false), pattern_builds(0), tolerance(1e-6), max_iterations(1000), last_solve{ 0, 0. }
+		{}
+
+		// MEMBER FUNCTIONS
+		static const char* name(void) { return "implicit Euler"; }
+
+		void reset(void) { pattern_valid = false; }
+
+		// Set the relative residual at which each step's solve stops.
+		void setTolerance(double relative_residual) { tolerance = relative_residual; }
+		// Set the most conjugate gradient iterations a step may take.
+		void setMaxIterations(std::uint32_t iterations) { max_iterations = iterations; }
+		// Return how the last step's solve ended.
+		const ConjugateGradientResult& lastSolve(void) const { return last_solve; }
+		// Return the number of times the sparsity pattern was built.
+		std::uint32_t patternBuilds(void) const { return pattern_builds; }
+
+		template <typename Apply>
+		void step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, SpringForces<_Size, _Scalar, Apply> forces, ThreadPool* pool);
+	};
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ImplicitEuler<_Size, _Scalar>::buildPattern(const ParticleStore<_Size, _Scalar>& particles, const std::vector<Spring<_Size, _Scalar> >& springs) {
+		const std::uint32_t count = integratedCount(particles);
+
+		row_of.assign(particles.size(), NO_ROW);
+		particle_of.clear();
+		for (std::uint32_t i = 0; i < count; i++)
+			if (particles.invMass[i] > 0) {
+				row_of[i] = (std::uint32_t)particle_of.size();
+				particle_of.push_back(i);
+			}
+
+		std::vector<std::pair<std::uint32_t, std::uint32_t> > pairs;
+		spring_blocks.resize(springs.size());
+		for (std::uint32_t s = 0; s < springs.size(); s++) {
+			SpringBlocks& blocks = spring_blocks[s];
+			blocks.row1 = row_of[springs[s].p1_index];
+			blocks.row2 = row_of[springs[s].p2_index];
+			if (blocks.row1 != NO_ROW && blocks.row2 != NO_ROW && blocks.row1 != blocks.row2)
+				pairs.push_back(std::pair<std::uint32_t, std::uint32_t>(blocks.row1, blocks.row2));
+		}
+
+		const std::uint32_t rows = (std::uint32_t)particle_of.size();
+		system.setPattern(rows, pairs);
+		for (SpringBlocks& blocks : spring_blocks) {
+			const bool coupled = blocks.row1 != NO_ROW && blocks.row2 != NO_ROW && blocks.row1 != blocks.row2;
+			blocks.block12 = coupled ? system.blockIndex(blocks.row1, blocks.row2) : NO_ROW;
+			blocks.block21 = coupled ? system.blockIndex(blocks.row2, blocks.row1) : NO_ROW;
+		}
+
+		rhs.assign(rows * _Size, _Scalar(0));
+		delta_vel.assign(rows * _Size, _Scalar(0));
+		pattern_valid = true;
+		pattern_builds++;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	template <typename Apply>
+	void ImplicitEuler<_Size, _Scalar>::step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, SpringForces<_Size, _Scalar, Apply> forces, ThreadPool* pool) {
+		const _Scalar dt = seconds_per_cycle;
+		const std::uint32_t count = integratedCount(particles);
+
+		particles.applyCorrections();
+		if (!pattern_valid || row_of.size() != particles.size() || spring_blocks.size() != forces.springs.size())
+			buildPattern(particles, forces.springs);
+
+		// Mass on the diagonal; the forces already in F become a kick
+		system.setZero();
+		forEachParticleChunk((std::uint32_t)particle_of.size(), pool, [this, &particles, dt](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t r = begin; r < end; r++) {
+				const std::uint32_t i = particle_of[r];
+				_Scalar* diagonal = system.block(system.diagonalIndex(r));
+				for (std::uint8_t k = 0; k < _Size; k++) {
+					diagonal[k * _Size + k] = _Scalar(1) / particles.invMass[i];
+					rhs[r * _Size + k] = particles.F[i][k] * dt;
+				}
+			}
+		});
+
+		// Spring terms. Per spring, df1/dx2 = k * (u u^T + (1 - L / l) * (I - u u^T)) and df1/dv2 = c * u u^T
+		for (std::uint32_t s = 0; s < forces.springs.size(); s++) {
+			const SpringBlocks& blocks = spring_blocks[s];
+			if (blocks.row1 == NO_ROW && blocks.row2 == NO_ROW)
+				continue;
+
+			const Spring<_Size, _Scalar>& spring = forces.springs[s];
+			const Tuple<_Size, _Scalar> d = particles.pos[spring.p2_index] - particles.pos[spring.p1_index];
+			const _Scalar length = magnitude(d);
+			if (!(length > 0))  // No axis to act along
+				continue;
+
+			const _Scalar stiffness = spring.stiffness, damping = spring.damping;
+			const Tuple<_Size, _Scalar> u = d / length;
+			const Tuple<_Size, _Scalar> relative_vel = particles.vel[spring.p2_index] - particles.vel[spring.p1_index];
+			const _Scalar transverse = stiffness * std::max(_Scalar(0), _Scalar(1) - spring.rest_length / length);
+
+			// Force on p1, and dt * (f + dt * df/dx * v) for it
+			const Tuple<_Size, _Scalar> f = spring.force(particles);
+			const Tuple<_Size, _Scalar> kick = (f + (relative_vel * transverse + u * ((stiffness - transverse) * dot(relative_vel, u))) * dt) * dt;
+
+			// dt * df1/dv2 + dt^2 * df1/dx2 = iso * I + axial * u u^T
+			const _Scalar iso = dt * dt * transverse, axial = dt * damping + dt * dt * (stiffness - transverse);
+			_Scalar S[_Size * _Size];
+			for (std::uint8_t i = 0; i < _Size; i++)
+				for (std::uint8_t j = 0; j < _Size; j++)
+					S[i * _Size + j] = axial * u[i] * u[j] + (i == j ? iso : _Scalar(0));
+
+			for (std::uint8_t k = 0; k < _Size; k++) {
+				if (blocks.row1 != NO_ROW)
+					rhs[blocks.row1 * _Size + k] += kick[k];
+				if (blocks.row2 != NO_ROW)
+					rhs[blocks.row2 * _Size + k] -= kick[k];
+			}
+			for (std::uint32_t e = 0; e < _Size * _Size; e++) {
+				if (blocks.row1 != NO_ROW)
+					system.block(system.diagonalIndex(blocks.row1))[e] += S[e];
+				if (blocks.row2 != NO_ROW)
+					system.block(system.diagonalIndex(blocks.row2))[e] += S[e];
+				if (blocks.block12 != NO_ROW) {
+					system.block(blocks.block12)[e] -= S[e];
+					system.block(blocks.block21)[e] -= S[e];
+				}
+			}
+		}
+
+		last_solve = conjugateGradient(system, rhs, delta_vel, tolerance, max_iterations, pool);
+
+		// Apply dv and move with the new velocities; static particles in the range just drift
+		forEachParticleChunk(count, pool, [this, &particles, dt](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++) {
+				if (row_of[i] != NO_ROW)
+					for (std::uint8_t k = 0; k < _Size; k++)
+						particles.vel[i][k] += delta_vel[row_of[i] * _Size + k];
+				particles.pos[i] += particles.vel[i] * dt;
+				particles.F[i].setZero();
+			}
+		});
+		endStep(particles, seconds_per_cycle);
+	}
+}
+
+#endif
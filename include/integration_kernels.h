@@ -0,0 +1,216 @@
+// integration_kernels.h
+// Written by Weston Cook
+// Defines batch kernels that integrate many particles stored as flat arrays
+
+#ifndef BRAZEN_INTEGRATION_KERNELS_H
+#define BRAZEN_INTEGRATION_KERNELS_H
+
+#include "simd.h"
+#include <cstdint>  // std::uint8_t, std::int32_t, std::uint32_t
+#include <utility>  // std::integer_sequence
+#include <type_traits>  // std::is_same
+
+namespace Brazen {
+	/*
+	Struct IntegrationArrays - pointers to the flat arrays a batch integration kernel works on.
+	Every Tuple-valued array holds "count" * _Size scalars, particle-major (x0, y0, z0, x1, ...).
+	*/
+	template <typename _Scalar>
+	struct IntegrationArrays {
+		_Scalar *pos, *vel, *F;
+		const _Scalar* invMass;
+		std::uint32_t count;
+	};
+
+	/*
+	Batch equivalents of "Particle::update()" for particles whose ragdoll corrections have already been applied
+	(see "RagdollCorrections::apply()"), i.e. per component:
+
+		vel += F * (invMass * seconds_per_cycle)  (adds zero for static particles, so there is no branch)
+		pos += vel * seconds_per_cycle
+		F = 0
+
+	The SIMD kernels exist for double and float (which fits twice as many particles per vector). Other scalar
+	types, such as Fixed32, always use the portable kernel.
+	*/
+
+	// Integrate particles [begin, end) with portable C++.
+	template <std::uint8_t _Size, typename _Scalar>
+	void integrateScalar(const IntegrationArrays<_Scalar>& a, double seconds_per_cycle, std::uint32_t begin, std::uint32_t end) {
+		const _Scalar dt = seconds_per_cycle, zero = _Scalar(0);
+
+		for (std::uint32_t i = begin; i < end; i++) {
+			const _Scalar invMass = a.invMass[i];
+
+			for (std::uint32_t k = i * _Size; k < (i + 1) * _Size; k++) {
+				a.vel[k] += a.F[k] * (invMass * dt);
+				a.pos[k] += a.vel[k] * dt;
+				a.F[k] = zero;
+			}
+		}
+	}
+
+#ifdef BRAZEN_X86_SIMD
+	// AVX2: a block of 4 particles is _Size vectors of 4 doubles. Vector r of a block holds components of
+	//	particles (4r + lane) / _Size, so its inverse masses are a fixed permutation of the block's 4 inverse masses.
+	template <std::uint8_t _Size, std::uint8_t r>
+	struct Avx2InvMassPermutation {
+		static constexpr int value = ((4 * r + 0) / _Size) | ((4 * r + 1) / _Size) << 2 | ((4 * r + 2) / _Size) << 4 | ((4 * r + 3) / _Size) << 6;
+	};
+
+	// Integrate vector r of the block of 4 particles starting at flat offset k.
+	template <std::uint8_t _Size, std::uint8_t r>
+	BRAZEN_TARGET("avx2") inline void integrateAvx2Vector(const IntegrationArrays<double>& a, std::uint32_t k, __m256d block_invMass, __m256d dt) {
+		const __m256d zero = _mm256_setzero_pd();
+		double *pos = a.pos + k + 4 * r, *vel = a.vel + k + 4 * r, *F = a.F + k + 4 * r;
+
+		__m256d invMass = _mm256_permute4x64_pd(block_invMass, (Avx2InvMassPermutation<_Size, r>::value));
+		__m256d v = _mm256_add_pd(_mm256_loadu_pd(vel), _mm256_mul_pd(_mm256_loadu_pd(F), _mm256_mul_pd(invMass, dt)));
+		__m256d p = _mm256_add_pd(_mm256_loadu_pd(pos), _mm256_mul_pd(v, dt));
+
+		_mm256_storeu_pd(vel, v);
+		_mm256_storeu_pd(pos, p);
+		_mm256_storeu_pd(F, zero);
+	}
+
+	template <std::uint8_t _Size, std::uint8_t... r>
+	BRAZEN_TARGET("avx2") inline void integrateAvx2Block(const IntegrationArrays<double>& a, std::uint32_t i, __m256d dt, std::integer_sequence<std::uint8_t, r...>) {
+		__m256d block_invMass = _mm256_loadu_pd(a.invMass + i);
+		(integrateAvx2Vector<_Size, r>(a, i * _Size, block_invMass, dt), ...);
+	}
+
+	// Integrate particles [begin, end) with AVX2.
+	template <std::uint8_t _Size>
+	BRAZEN_TARGET("avx2") void integrateAvx2(const IntegrationArrays<double>& a, double seconds_per_cycle, std::uint32_t begin, std::uint32_t end) {
+		__m256d dt = _mm256_set1_pd(seconds_per_cycle);
+		std::uint32_t i = begin;
+
+		for (; i + 4 <= end; i += 4)
+			integrateAvx2Block<_Size>(a, i, dt, std::make_integer_sequence<std::uint8_t, _Size>());
+
+		integrateScalar<_Size, double>(a, seconds_per_cycle, i, end);  // Leftover particles
+	}
+
+	// AVX-512: same scheme as AVX2 with blocks of 8 particles and a runtime permutation per vector.
+	template <std::uint8_t _Size>
+	BRAZEN_TARGET("avx512f") void integrateAvx512(const IntegrationArrays<double>& a, double seconds_per_cycle, std::uint32_t begin, std::uint32_t end) {
+		const __m512d zero = _mm512_setzero_pd();
+		const __m512d dt = _mm512_set1_pd(seconds_per_cycle);
+		__m512i permutation[_Size];
+		std::uint32_t i = begin;
+
+		for (std::uint32_t r = 0; r < _Size; r++)
+			permutation[r] = _mm512_setr_epi64((8 * r + 0) / _Size, (8 * r + 1) / _Size, (8 * r + 2) / _Size, (8 * r + 3) / _Size,
+				(8 * r + 4) / _Size, (8 * r + 5) / _Size, (8 * r + 6) / _Size, (8 * r + 7) / _Size);
+
+		for (; i + 8 <= end; i += 8) {
+			__m512d block_invMass = _mm512_loadu_pd(a.invMass + i);
+
+			for (std::uint32_t r = 0; r < _Size; r++) {
+				std::uint32_t k = i * _Size + 8 * r;
+				__m512d invMass = _mm512_mask_permutexvar_pd(zero, 0xff, permutation[r], block_invMass);  // Unmasked, but with no undefined source to warn about
+				__m512d v = _mm512_add_pd(_mm512_loadu_pd(a.vel + k), _mm512_mul_pd(_mm512_loadu_pd(a.F + k), _mm512_mul_pd(invMass, dt)));
+				__m512d p = _mm512_add_pd(_mm512_loadu_pd(a.pos + k), _mm512_mul_pd(v, dt));
+
+				_mm512_storeu_pd(a.vel + k, v);
+				_mm512_storeu_pd(a.pos + k, p);
+				_mm512_storeu_pd(a.F + k, zero);
+			}
+		}
+
+		integrateScalar<_Size, double>(a, seconds_per_cycle, i, end);  // Leftover particles
+	}
+
+	// AVX2, float: a block of 8 particles is _Size vectors of 8 floats, with the inverse masses of vector r
+	//	permuted the same way as the double kernels (lane l holds a component of particle (8r + l) / _Size).
+	template <std::uint8_t _Size>
+	BRAZEN_TARGET("avx2") void integrateAvx2(const IntegrationArrays<float>& a, double seconds_per_cycle, std::uint32_t begin, std::uint32_t end) {
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 dt = _mm256_set1_ps((float)seconds_per_cycle);
+		__m256i permutation[_Size];
+		std::uint32_t i = begin;
+
+		for (std::uint32_t r = 0; r < _Size; r++)
+			permutation[r] = _mm256_setr_epi32((8 * r + 0) / _Size, (8 * r + 1) / _Size, (8 * r + 2) / _Size, (8 * r + 3) / _Size,
+				(8 * r + 4) / _Size, (8 * r + 5) / _Size, (8 * r + 6) / _Size, (8 * r + 7) / _Size);
+
+		for (; i + 8 <= end; i += 8) {
+			__m256 block_invMass = _mm256_loadu_ps(a.invMass + i);
+
+			for (std::uint32_t r = 0; r < _Size; r++) {
+				std::uint32_t k = i * _Size + 8 * r;
+				__m256 invMass = _mm256_permutevar8x32_ps(block_invMass, permutation[r]);
+				__m256 v = _mm256_add_ps(_mm256_loadu_ps(a.vel + k), _mm256_mul_ps(_mm256_loadu_ps(a.F + k), _mm256_mul_ps(invMass, dt)));
+				__m256 p = _mm256_add_ps(_mm256_loadu_ps(a.pos + k), _mm256_mul_ps(v, dt));
+
+				_mm256_storeu_ps(a.vel + k, v);
+				_mm256_storeu_ps(a.pos + k, p);
+				_mm256_storeu_ps(a.F + k, zero);
+			}
+		}
+
+		integrateScalar<_Size, float>(a, seconds_per_cycle, i, end);  // Leftover particles
+	}
+
+	// AVX-512, float: blocks of 16 particles.
+	template <std::uint8_t _Size>
+	BRAZEN_TARGET("avx512f") void integrateAvx512(const IntegrationArrays<float>& a, double seconds_per_cycle, std::uint32_t begin, std::uint32_t end) {
+		const __m512 zero = _mm512_setzero_ps();
+		const __m512 dt = _mm512_set1_ps((float)seconds_per_cycle);
+		__m512i permutation[_Size];
+		std::uint32_t i = begin;
+
+		for (std::uint32_t r = 0; r < _Size; r++) {
+			alignas(64) std::int32_t lanes[16];
+			for (std::uint32_t l = 0; l < 16; l++)
+				lanes[l] = (16 * r + l) / _Size;
+			permutation[r] = _mm512_load_si512(lanes);
+		}
+
+		for (; i + 16 <= end; i += 16) {
+			__m512 block_invMass = _mm512_loadu_ps(a.invMass + i);
+
+			for (std::uint32_t r = 0; r < _Size; r++) {
+				std::uint32_t k = i * _Size + 16 * r;
+				__m512 invMass = _mm512_mask_permutexvar_ps(zero, 0xffff, permutation[r], block_invMass);
+				__m512 v = _mm512_add_ps(_mm512_loadu_ps(a.vel + k), _mm512_mul_ps(_mm512_loadu_ps(a.F + k), _mm512_mul_ps(invMass, dt)));
+				__m512 p = _mm512_add_ps(_mm512_loadu_ps(a.pos + k), _mm512_mul_ps(v, dt));
+
+				_mm512_storeu_ps(a.vel + k, v);
+				_mm512_storeu_ps(a.pos + k, p);
+				_mm512_storeu_ps(a.F + k, zero);
+			}
+		}
+
+		integrateScalar<_Size, float>(a, seconds_per_cycle, i, end);  // Leftover particles
+	}
+#endif
+
+	// Integrate particles [begin, end) with the kernel for the given SIMD level.
+	template <std::uint8_t _Size, typename _Scalar>
+	void integrateBatch(const IntegrationArrays<_Scalar>& a, double seconds_per_cycle, std::uint32_t begin, std::uint32_t end, SimdLevel level) {
+#ifdef BRAZEN_X86_SIMD
+		if constexpr (std::is_same<_Scalar, double>::value || std::is_same<_Scalar, float>::value) {
+			switch (level) {
+			case SimdLevel::AVX512:
+				integrateAvx512<_Size>(a, seconds_per_cycle, begin, end);
+				return;
+			case SimdLevel::AVX2:
+				integrateAvx2<_Size>(a, seconds_per_cycle, begin, end);
+				return;
+			default:
+				break;
+			}
+		}
+#endif
+		integrateScalar<_Size, _Scalar>(a, seconds_per_cycle, begin, end);
+	}
+
+	// Integrate particles [begin, end) with the most capable kernel this CPU supports.
+	template <std::uint8_t _Size, typename _Scalar>
+	void integrateBatch(const IntegrationArrays<_Scalar>& a, double seconds_per_cycle, std::uint32_t begin, std::uint32_t end) {
+		integrateBatch<_Size, _Scalar>(a, seconds_per_cycle, begin, end, simdLevel());
+	}
+}
+
+#endif
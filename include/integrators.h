@@ -0,0 +1,296 @@
+// integrators.h
+// Written by Weston Cook
+// Defines the integrator policies SymplecticEuler, PositionVerlet, VelocityVerlet and RungeKutta4 and the struct SpringForces
+
+#ifndef BRAZEN_INTEGRATORS_H
+#define BRAZEN_INTEGRATORS_H
+
+#include "tuple.h"
+#include "particle_store.h"
+#include "spring.h"
+#include "thread_pool.h"
+#include <vector>  // std::vector
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Integrator policies - advance a ParticleStore by one time step. "Simulator" takes one as a template parameter.
+
+	Every policy has the interface
+
+		void reset(void);  // Forget any state carried between steps (particles were added or reordered)
+		template <typename Forces>
+		void step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, Forces forces, ThreadPool* pool);
+
+	"forces()" adds the forces acting on the particles, at their current positions and velocities, to the (zeroed)
+	force accumulators F. Higher order methods call it more than once per step, at intermediate states, and zero F
+	in between. Forces already in F when "step()" is called (e.g. from collision response) act as a kick of
+	F * invMass * seconds_per_cycle. Ragdoll corrections are applied at the start of the step, and static
+	particles with a velocity drift at it, as with "ParticleStore::integrate()".
+
+	All of these are explicit methods: they differ in accuracy and in the work per step, but stiff springs limit the
+	stable step of each to about 2 / omega (2.8 / omega for RK4), where omega is the fastest spring's angular frequency.
+	"ImplicitEuler" (see "implicit_euler.h") has no such limit, at the cost of a linear solve per step.
+
+	Method             Order   Force evaluations   Extra memory per particle
+	SymplecticEuler    1       1                   none
+	PositionVerlet     2       1                   none
+	VelocityVerlet     2       1                   1 Tuple
+	RungeKutta4        4       4                   4 Tuples
+	ImplicitEuler      1       0 *                 sparse matrix blocks, 7 Tuples
+
+	* It evaluates the springs itself, from their Jacobian.
+	*/
+
+	const std::uint32_t INTEGRATOR_CHUNK = 4096;  // Particles per task when a pass is split across threads
+
+	// Return the number of leading particles an integrator has to update: the dynamic range of a partitioned store, else all.
+	template <std::uint8_t _Size, typename _Scalar>
+	std::uint32_t integratedCount(const ParticleStore<_Size, _Scalar>& particles) {
+		return particles.isPartitioned() ? particles.dynamicCount() : particles.size();
+	}
+
+	// Call "function(begin, end)" over the particles [0, count), split across the pool's threads if there is one.
+	template <typename Function>
+	void forEachParticleChunk(std::uint32_t count, ThreadPool* pool, Function function) {
+		if (pool)
+			pool->parallelFor(0, count, INTEGRATOR_CHUNK, function);
+		else
+			function(0, count);
+	}
+
+	// Apply pending corrections, then kick every integrated particle with the forces already in F and zero them.
+	template <std::uint8_t _Size, typename _Scalar>
+	void beginStep(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, ThreadPool* pool) {
+		const _Scalar dt = seconds_per_cycle;
+
+		particles.applyCorrections();
+		forEachParticleChunk(integratedCount(particles), pool, [&particles, dt](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++) {
+				particles.vel[i] += particles.F[i] * (particles.invMass[i] * dt);
+				particles.F[i].setZero();
+			}
+		});
+	}
+
+	// Move the static particles that have a velocity, if the integrated range left them out.
+	template <std::uint8_t _Size, typename _Scalar>
+	void endStep(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle) {
+		if (particles.isPartitioned())
+			particles.integrateStatic(seconds_per_cycle);
+	}
+
+
+	/*
+	Struct SpringForces - a forces callback that also carries the springs it applies. Explicit policies just call it;
+	"ImplicitEuler" reads "springs" to build the spring Jacobian. "Simulator" hands one of these to its integrator.
+	*/
+	template <std::uint8_t _Size, typename _Scalar, typename Apply>
+	struct SpringForces {
+		const std::vector<Spring<_Size, _Scalar> >& springs;
+		Apply apply;  // Adds every spring's force to F
+
+		void operator()(void) { apply(); }
+	};
+
+	// Return a SpringForces over the given springs that calls "apply()".
+	template <std::uint8_t _Size, typename _Scalar, typename Apply>
+	SpringForces<_Size, _Scalar, Apply> springForces(const std::vector<Spring<_Size, _Scalar> >& springs, Apply apply) {
+		return SpringForces<_Size, _Scalar, Apply>{ springs, apply };
+	}
+
+
+	/*
+	Class SymplecticEuler - semi-implicit Euler: vel += F / m * dt, then pos += vel * dt. "Particle::update()" and the
+	batch kernels of "ParticleStore::integrate()" implement it, so this policy reproduces them exactly.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	class SymplecticEuler {
+	public:
+		static const char* name(void) { return "symplectic Euler"; }
+
+		void reset(void) {}
+
+		template <typename Forces>
+		void step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, Forces forces, ThreadPool* pool) {
+			forces();
+			particles.applyCorrections();
+			forEachParticleChunk(integratedCount(particles), pool, [&particles, seconds_per_cycle](std::uint32_t begin, std::uint32_t end) {
+				particles.integrate(seconds_per_cycle, begin, end);
+			});
+			endStep(particles, seconds_per_cycle);
+		}
+	};
+
+
+	/*
+	Class PositionVerlet - drift-kick-drift leapfrog: pos += vel * dt / 2, evaluate forces, vel += F / m * dt,
+	pos += vel * dt / 2. Second order and time-reversible with one force evaluation and no state between steps.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	class PositionVerlet {
+	public:
+		static const char* name(void) { return "position Verlet"; }
+
+		void reset(void) {}
+
+		template <typename Forces>
+		void step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, Forces forces, ThreadPool* pool) {
+			const _Scalar dt = seconds_per_cycle, half_dt = seconds_per_cycle / 2;
+			const std::uint32_t count = integratedCount(particles);
+
+			beginStep(particles, seconds_per_cycle, pool);
+			forEachParticleChunk(count, pool, [&particles, half_dt](std::uint32_t begin, std::uint32_t end) {
+				for (std::uint32_t i = begin; i < end; i++)
+					particles.pos[i] += particles.vel[i] * half_dt;
+			});
+
+			forces();
+			forEachParticleChunk(count, pool, [&particles, dt, half_dt](std::uint32_t begin, std::uint32_t end) {
+				for (std::uint32_t i = begin; i < end; i++) {
+					particles.vel[i] += particles.F[i] * (particles.invMass[i] * dt);
+					particles.pos[i] += particles.vel[i] * half_dt;
+					particles.F[i].setZero();
+				}
+			});
+			endStep(particles, seconds_per_cycle);
+		}
+	};
+
+
+	/*
+	Class VelocityVerlet - kick-drift-kick: vel += a * dt / 2, pos += vel * dt, evaluate forces, vel += a * dt / 2.
+	Second order with one force evaluation per step, by keeping each step's accelerations for the next one.
+	Positions and velocities are both known at whole steps.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	class VelocityVerlet {
+	private:
+		std::vector<Tuple<_Size, _Scalar> > acceleration;  // Acceleration of every particle at the end of the last step
+		bool acceleration_valid;  // Whether "acceleration" still matches the store
+	public:
+		VelocityVerlet(void) :
+			acceleration_valid(false)
+		{}
+
+		static const char* name(void) { return "velocity Verlet"; }
+
+		void reset(void) { acceleration_valid = false; }
+
+		template <typename Forces>
+		void step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, Forces forces, ThreadPool* pool);
+	};
+
+
+	/*
+	Class RungeKutta4 - the classical fourth order Runge-Kutta method on positions and velocities together.
+	Most accurate per step, at four force evaluations; unlike the Verlet methods it is not symplectic, so
+	energy slowly decays rather than oscillating about the true value. Static particles stay put during the
+	intermediate stages.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	class RungeKutta4 {
+	private:
+		std::vector<Tuple<_Size, _Scalar> > start_pos, start_vel;  // State at the start of the step
+		std::vector<Tuple<_Size, _Scalar> > sum_pos, sum_vel;  // Weighted sums of the stage derivatives
+	public:
+		static const char* name(void) { return "RK4"; }
+
+		void reset(void) {}
+
+		template <typename Forces>
+		void step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, Forces forces, ThreadPool* pool);
+	};
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	template <typename Forces>
+	void VelocityVerlet<_Size, _Scalar>::step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, Forces forces, ThreadPool* pool) {
+		const _Scalar dt = seconds_per_cycle, half_dt = seconds_per_cycle / 2;
+		const std::uint32_t count = integratedCount(particles);
+
+		beginStep(particles, seconds_per_cycle, pool);
+
+		// The first step after a reset needs the accelerations at its start
+		if (!acceleration_valid || acceleration.size() != particles.size()) {
+			acceleration.resize(particles.size());
+			forces();
+			forEachParticleChunk(count, pool, [this, &particles](std::uint32_t begin, std::uint32_t end) {
+				for (std::uint32_t i = begin; i < end; i++) {
+					acceleration[i] = particles.F[i] * particles.invMass[i];
+					particles.F[i].setZero();
+				}
+			});
+			acceleration_valid = true;
+		}
+
+		forEachParticleChunk(count, pool, [this, &particles, dt, half_dt](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++) {
+				particles.vel[i] += acceleration[i] * half_dt;
+				particles.pos[i] += particles.vel[i] * dt;
+			}
+		});
+
+		forces();
+		forEachParticleChunk(count, pool, [this, &particles, half_dt](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++) {
+				acceleration[i] = particles.F[i] * particles.invMass[i];
+				particles.vel[i] += acceleration[i] * half_dt;
+				particles.F[i].setZero();
+			}
+		});
+		endStep(particles, seconds_per_cycle);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	template <typename Forces>
+	void RungeKutta4<_Size, _Scalar>::step(ParticleStore<_Size, _Scalar>& particles, double seconds_per_cycle, Forces forces, ThreadPool* pool) {
+		const std::uint32_t count = integratedCount(particles);
+		const double stage_offset[4] = { .5, .5, 1., 0. };  // Fraction of the step at which the next stage is evaluated
+		const double stage_weight[4] = { 1., 2., 2., 1. };
+
+		beginStep(particles, seconds_per_cycle, pool);
+		start_pos.resize(particles.size());
+		start_vel.resize(particles.size());
+		sum_pos.resize(particles.size());
+		sum_vel.resize(particles.size());
+		forEachParticleChunk(count, pool, [this, &particles](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++) {
+				start_pos[i] = particles.pos[i];
+				start_vel[i] = particles.vel[i];
+				sum_pos[i].setZero();
+				sum_vel[i].setZero();
+			}
+		});
+
+		for (std::uint8_t stage = 0; stage < 4; stage++) {
+			const _Scalar weight = stage_weight[stage], offset = stage_offset[stage] * seconds_per_cycle;
+			const _Scalar sixth_dt = seconds_per_cycle / 6;
+			const bool last = stage == 3;
+
+			forces();
+			forEachParticleChunk(count, pool, [this, &particles, weight, offset, sixth_dt, last](std::uint32_t begin, std::uint32_t end) {
+				for (std::uint32_t i = begin; i < end; i++) {
+					// Derivatives at this stage: d(pos) = vel, d(vel) = F / m
+					const Tuple<_Size, _Scalar> d_pos = particles.vel[i];
+					const Tuple<_Size, _Scalar> d_vel = particles.F[i] * particles.invMass[i];
+					sum_pos[i] += d_pos * weight;
+					sum_vel[i] += d_vel * weight;
+					particles.F[i].setZero();
+
+					if (last) {
+						particles.pos[i] = start_pos[i] + sum_pos[i] * sixth_dt;
+						particles.vel[i] = start_vel[i] + sum_vel[i] * sixth_dt;
+					}
+					else {  // Move to the state the next stage is evaluated at
+						particles.pos[i] = start_pos[i] + d_pos * offset;
+						particles.vel[i] = start_vel[i] + d_vel * offset;
+					}
+				}
+			});
+		}
+		endStep(particles, seconds_per_cycle);
+	}
+}
+
+#endif
@@ -0,0 +1,269 @@
+// islands.h
+// Written by Weston Cook
+// Defines the classes DisjointSets and Islands
+
+#ifndef BRAZEN_ISLANDS_H
+#define BRAZEN_ISLANDS_H
+
+#include <vector>  // std::vector
+#include <utility>  // std::pair, std::swap
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Class DisjointSets - union-find over the elements 0 to size() - 1, with union by size and path halving, so any
+	sequence of "find()" and "unite()" calls takes nearly constant time per call. Every set also keeps its members
+	in a circular list, so a set can be visited in time proportional to its size.
+	*/
+	class DisjointSets {
+	private:
+		// ATTRIBUTES
+		std::vector<std::uint32_t> parent;  // Parent of every element; a root is its own parent
+		std::vector<std::uint32_t> set_size;  // Number of members of the set of every root
+		std::vector<std::uint32_t> next_member;  // Next member of every element's set, around a circular list
+	public:
+		// MEMBER FUNCTIONS
+		// Return the number of elements.
+		std::uint32_t size(void) const { return (std::uint32_t)parent.size(); }
+		// Reserve space for "count" elements.
+		void reserve(std::uint32_t count);
+		// Make "count" elements, each in a set of its own.
+		void assign(std::uint32_t count);
+		// Add an element in a set of its own and return it.
+		std::uint32_t add(void);
+
+		// Return the root of the given element's set.
+		std::uint32_t find(std::uint32_t element);
+		// Merge the sets of the two elements and return the root of the result.
+		std::uint32_t unite(std::uint32_t a, std::uint32_t b);
+		// Return the number of members of the set with the given root.
+		std::uint32_t setSize(std::uint32_t root) const { return set_size[root]; }
+		// Call "function(member)" for every member of the given element's set.
+		template <typename Function>
+		void forEachMember(std::uint32_t element, Function function) const;
+	};
+
+
+	/*
+	Class Islands - groups of particles joined by springs or objects, and which of them are asleep.
+
+	Islands only ever merge (springs and objects are never removed), so they are kept in a DisjointSets that grows
+	with every particle and unites the ends of every spring and the members of every object as they are added.
+	Static particles are left out of every island: a floor touching everything would otherwise merge it all.
+
+	Each step, the owner "measure()"s every awake dynamic particle and reports the islands whose objects "touch()."
+	"sleep()" then counts, per island, the consecutive steps its kinetic energy per unit mass (half its mass weighted
+	mean squared speed) stayed at or below the threshold. Touching islands are put to sleep together, once all of
+	them have been quiet long enough, so a stack never wakes itself by sleeping one body at a time. Putting an island
+	to sleep or waking it calls back for every member, leaving what that means to the owner.
+	*/
+	class Islands {
+	private:
+		// ATTRIBUTES
+		static constexpr std::uint32_t NOT_MEASURED = 0xffffffffu;  // "slot" of an island not measured this step
+
+		DisjointSets sets;  // Islands of the particles
+		std::vector<bool> dynamic;  // Whether every particle joins islands
+		std::vector<bool> island_asleep;  // Whether every island is asleep, by root
+		std::vector<std::uint32_t> quiet_steps;  // Consecutive steps every island stayed below the threshold, by root
+
+		// Measurements of this step, by slot: the islands measured, in the order they were first measured
+		std::vector<std::uint32_t> slot;  // Slot of every island measured this step, by root, else NOT_MEASURED
+		std::vector<std::uint32_t> measured;  // Root of every slot
+		std::vector<double> kinetic_energy, island_mass;  // Sums of .5 m v^2 and m over the members measured
+		std::vector<std::pair<std::uint32_t, std::uint32_t> > contacts;  // Pairs of particles whose islands touched
+		DisjointSets groups;  // Islands that touched, by slot
+		std::vector<bool> group_ready;  // Whether every island of a group was quiet long enough, by the slot of its root in "groups"
+	public:
+		// MEMBER FUNCTIONS
+		// Return the number of particles.
+		std::uint32_t size(void) const { return sets.size(); }
+		// Reserve space for "count" particles.
+		void reserve(std::uint32_t count);
+		// Add an awake particle in an island of its own (or in none, if it is static) and return its index.
+		std::uint32_t add(bool is_dynamic);
+
+		// Return the root of the given particle's island, the same for every member.
+		std::uint32_t island(std::uint32_t particle) { return sets.find(particle); }
+		// Return whether the given particle's island is asleep.
+		bool isAsleep(std::uint32_t particle) { return island_asleep[sets.find(particle)]; }
+		// Merge the islands of the two particles, unless one is static. A merged sleeping island is woken first,
+		//	calling "wake_member(particle)" for each of its members.
+		template <typename Function>
+		void connect(std::uint32_t a, std::uint32_t b, Function wake_member);
+		// Wake the given particle's island if it is asleep, calling "wake_member(particle)" for each member. Return whether it was asleep.
+		template <typename Function>
+		bool wake(std::uint32_t particle, Function wake_member);
+		// Wake every island, calling "wake_member(particle)" for each member of a sleeping one.
+		template <typename Function>
+		void wakeAll(Function wake_member);
+
+		// Add the kinetic energy of a dynamic particle with the given mass and squared speed to its island's.
+		void measure(std::uint32_t particle, double mass, double speed_squared);
+		// Record that the islands of the two particles touch this step.
+		void touch(std::uint32_t a, std::uint32_t b) { contacts.push_back(std::pair<std::uint32_t, std::uint32_t>(a, b)); }
+		// Update the quiet step counts of the islands measured this step and put every group of touching islands that
+		//	were all quiet for "steps" steps to sleep, calling "sleep_member(particle)" for each member. Forget this
+		//	step's measurements and contacts, and return the number of islands put to sleep.
+		template <typename Function>
+		std::uint32_t sleep(double energy_threshold, std::uint32_t steps, Function sleep_member);
+	};
+
+
+	inline void DisjointSets::reserve(std::uint32_t count) {
+		parent.reserve(count);
+		set_size.reserve(count);
+		next_member.reserve(count);
+	}
+
+	inline void DisjointSets::assign(std::uint32_t count) {
+		parent.resize(count);
+		set_size.assign(count, 1);
+		next_member.resize(count);
+		for (std::uint32_t i = 0; i < count; i++)
+			parent[i] = next_member[i] = i;
+	}
+
+	inline std::uint32_t DisjointSets::add(void) {
+		const std::uint32_t element = size();
+		parent.push_back(element);
+		set_size.push_back(1);
+		next_member.push_back(element);
+		return element;
+	}
+
+	inline std::uint32_t DisjointSets::find(std::uint32_t element) {
+		while (parent[element] != element) {
+			parent[element] = parent[parent[element]];  // Path halving
+			element = parent[element];
+		}
+		return element;
+	}
+
+	inline std::uint32_t DisjointSets::unite(std::uint32_t a, std::uint32_t b) {
+		a = find(a);
+		b = find(b);
+		if (a == b)
+			return a;
+
+		if (set_size[a] < set_size[b])
+			std::swap(a, b);
+		parent[b] = a;
+		set_size[a] += set_size[b];
+		std::swap(next_member[a], next_member[b]);  // Splices the two circular lists into one
+		return a;
+	}
+
+	template <typename Function>
+	void DisjointSets::forEachMember(std::uint32_t element, Function function) const {
+		std::uint32_t member = element;
+		do {
+			function(member);
+			member = next_member[member];
+		} while (member != element);
+	}
+
+
+	inline void Islands::reserve(std::uint32_t count) {
+		sets.reserve(count);
+		dynamic.reserve(count);
+		island_asleep.reserve(count);
+		quiet_steps.reserve(count);
+		slot.reserve(count);
+	}
+
+	inline std::uint32_t Islands::add(bool is_dynamic) {
+		dynamic.push_back(is_dynamic);
+		island_asleep.push_back(false);
+		quiet_steps.push_back(0);
+		slot.push_back(NOT_MEASURED);
+		return sets.add();
+	}
+
+	template <typename Function>
+	void Islands::connect(std::uint32_t a, std::uint32_t b, Function wake_member) {
+		if (!dynamic[a] || !dynamic[b])
+			return;
+
+		wake(a, wake_member);
+		wake(b, wake_member);
+		quiet_steps[sets.unite(a, b)] = 0;
+	}
+
+	template <typename Function>
+	bool Islands::wake(std::uint32_t particle, Function wake_member) {
+		const std::uint32_t root = sets.find(particle);
+		if (!island_asleep[root])
+			return false;
+
+		island_asleep[root] = false;
+		quiet_steps[root] = 0;
+		sets.forEachMember(root, wake_member);
+		return true;
+	}
+
+	template <typename Function>
+	void Islands::wakeAll(Function wake_member) {
+		for (std::uint32_t particle = 0; particle < size(); particle++)
+			if (island_asleep[particle])  // Only roots are ever marked
+				wake(particle, wake_member);
+	}
+
+	inline void Islands::measure(std::uint32_t particle, double mass, double speed_squared) {
+		const std::uint32_t root = sets.find(particle);
+		if (slot[root] == NOT_MEASURED) {
+			slot[root] = (std::uint32_t)measured.size();
+			measured.push_back(root);
+			kinetic_energy.push_back(0.);
+			island_mass.push_back(0.);
+		}
+		kinetic_energy[slot[root]] += .5 * mass * speed_squared;
+		island_mass[slot[root]] += mass;
+	}
+
+	template <typename Function>
+	std::uint32_t Islands::sleep(double energy_threshold, std::uint32_t steps, Function sleep_member) {
+		const std::uint32_t count = (std::uint32_t)measured.size();
+		std::uint32_t slept = 0;
+
+		for (std::uint32_t s = 0; s < count; s++) {
+			const std::uint32_t root = measured[s];
+			quiet_steps[root] = kinetic_energy[s] <= energy_threshold * island_mass[s] ? quiet_steps[root] + 1 : 0;
+		}
+
+		// Group the measured islands that touched; an island touching one that was not measured (asleep) stays awake
+		groups.assign(count);
+		group_ready.assign(count, true);
+		for (const std::pair<std::uint32_t, std::uint32_t>& contact : contacts) {
+			const std::uint32_t a = slot[sets.find(contact.first)], b = slot[sets.find(contact.second)];
+			if (a != NOT_MEASURED && b != NOT_MEASURED)
+				groups.unite(a, b);
+		}
+		for (const std::pair<std::uint32_t, std::uint32_t>& contact : contacts) {
+			const std::uint32_t a = slot[sets.find(contact.first)], b = slot[sets.find(contact.second)];
+			if ((a == NOT_MEASURED) != (b == NOT_MEASURED))
+				group_ready[groups.find(a != NOT_MEASURED ? a : b)] = false;
+		}
+		for (std::uint32_t s = 0; s < count; s++)
+			if (quiet_steps[measured[s]] < steps)
+				group_ready[groups.find(s)] = false;
+
+		for (std::uint32_t s = 0; s < count; s++) {
+			const std::uint32_t root = measured[s];
+			if (group_ready[groups.find(s)]) {
+				island_asleep[root] = true;
+				sets.forEachMember(root, sleep_member);
+				slept++;
+			}
+			slot[root] = NOT_MEASURED;
+		}
+
+		measured.clear();
+		kinetic_energy.clear();
+		island_mass.clear();
+		contacts.clear();
+		return slept;
+	}
+}
+
+#endif
@@ -0,0 +1,108 @@
+// object.h
+// Written by Weston Cook
+// Defines the function resolveObjectCollision
+
+#ifndef BRAZEN_OBJECT_H
+#define BRAZEN_OBJECT_H
+
+#include "tuple.h"
+#include "particle_store.h"
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Object collisions. An object is a list of particle indices (see "ObjectStore"), and for colliding it is treated as
+	the sphere around the mean position of its members that reaches the farthest one. When the spheres of two objects
+	overlap, both are pushed apart along the line between their centers until they just touch, and the part of their
+	velocities that brings them closer is removed, as in a perfectly inelastic collision. Both changes are split by
+	the objects' inverse masses, so momentum is conserved, and every member of an object moves with it.
+
+	The changes go into the members' ragdoll corrections ("m_delta_pos" and "m_delta_vel"), which are applied, scaled
+	by each particle's inverse mass, before the particles next move. An object with a static member is immovable.
+	*/
+
+	/*
+	Struct ObjectSphere - what a collision needs to know about an object.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	struct ObjectSphere {
+		// ATTRIBUTES
+		Tuple<_Size, _Scalar> center;  // Mean position of the members
+		Tuple<_Size, _Scalar> vel;  // Velocity of the members' center of mass
+		_Scalar radius;  // Distance from "center" to the farthest member
+		_Scalar invMass;  // Inverse of the members' total mass, 0 if one is static
+
+		// CONSTRUCTORS
+		// Bound the members of "members" (a non-empty list of particle indices) at their current positions.
+		template <typename MemberList>
+		ObjectSphere(const ParticleStore<_Size, _Scalar>& particles, const MemberList& members);
+	};
+
+	// Resolve the collision of the two objects with the given members, if their spheres overlap. Returns whether they did.
+	template <std::uint8_t _Size, typename _Scalar, typename MemberList>
+	bool resolveObjectCollision(ParticleStore<_Size, _Scalar>& particles, const MemberList& a, const MemberList& b);
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	template <typename MemberList>
+	ObjectSphere<_Size, _Scalar>::ObjectSphere(const ParticleStore<_Size, _Scalar>& particles, const MemberList& members) :
+		center(true), vel(true), radius(0), invMass(0)
+	{
+		_Scalar mass = 0;
+		bool immovable = false;
+
+		for (std::uint32_t i : members) {
+			center += particles.pos[i];
+			vel += particles.vel[i] * particles.mass[i];
+			mass += particles.mass[i];
+			immovable |= !(particles.invMass[i] > 0);
+		}
+		center /= _Scalar((double)members.size());
+		if (mass > 0)
+			vel /= mass;
+		if (!immovable)
+			invMass = _Scalar(1) / mass;
+
+		for (std::uint32_t i : members) {
+			const _Scalar distance = magnitude(particles.pos[i] - center);
+			if (distance > radius)
+				radius = distance;
+		}
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, typename MemberList>
+	bool resolveObjectCollision(ParticleStore<_Size, _Scalar>& particles, const MemberList& a, const MemberList& b) {
+		const ObjectSphere<_Size, _Scalar> sphere_a(particles, a), sphere_b(particles, b);
+		const _Scalar total_invMass = sphere_a.invMass + sphere_b.invMass;
+		if (!(total_invMass > 0))  // Neither can move
+			return false;
+
+		const Tuple<_Size, _Scalar> d = sphere_b.center - sphere_a.center;
+		const _Scalar distance = magnitude(d);
+		const _Scalar overlap = sphere_a.radius + sphere_b.radius - distance;
+		if (!(overlap > 0) || !(distance > 0))  // Apart, or concentric with no axis to separate along
+			return false;
+
+		// Separation and inelastic impulse along the axis from a to b, each per unit inverse mass. A correction
+		//	is scaled by the inverse mass of the particle it goes to, so each member gets its mass times the
+		//	change of its object.
+		const Tuple<_Size, _Scalar> axis = d / distance;
+		const _Scalar approach = dot(sphere_b.vel - sphere_a.vel, axis);
+		const Tuple<_Size, _Scalar> separation = axis * (overlap / total_invMass);
+		const Tuple<_Size, _Scalar> impulse = axis * ((approach < 0 ? approach : _Scalar(0)) / total_invMass);
+
+		if (sphere_a.invMass > 0)
+			for (std::uint32_t i : a) {
+				particles[i].m_delta_pos -= separation * (sphere_a.invMass * particles.mass[i]);
+				particles[i].m_delta_vel += impulse * (sphere_a.invMass * particles.mass[i]);
+			}
+		if (sphere_b.invMass > 0)
+			for (std::uint32_t i : b) {
+				particles[i].m_delta_pos += separation * (sphere_b.invMass * particles.mass[i]);
+				particles[i].m_delta_vel -= impulse * (sphere_b.invMass * particles.mass[i]);
+			}
+		return true;
+	}
+}
+
+#endif
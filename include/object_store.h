@@ -0,0 +1,128 @@
+// object_store.h
+// Written by Weston Cook
+// Defines the struct ObjectView and the class ObjectStore
+
+#ifndef BRAZEN_OBJECT_STORE_H
+#define BRAZEN_OBJECT_STORE_H
+
+#include "tuple.h"
+#include "aabb.h"
+#include <vector>  // std::vector
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Struct ObjectView - the particle indices of one object in an ObjectStore, as a read-only range.
+	*/
+	struct ObjectView {
+		// ATTRIBUTES
+		const std::uint32_t* first;
+		const std::uint32_t* last;
+
+		// MEMBER FUNCTIONS
+		const std::uint32_t* begin(void) const { return first; }
+		const std::uint32_t* end(void) const { return last; }
+		std::uint32_t size(void) const { return (std::uint32_t)(last - first); }
+		bool empty(void) const { return first == last; }
+		std::uint32_t operator[](std::uint32_t i) const { return first[i]; }
+	};
+
+
+	/*
+	Class ObjectStore - the particle membership of every object in compressed sparse row form, with each object's
+	bounding box and centroid cached next to it.
+
+	A vector of vectors cost a heap allocation per object and a pointer chase per object on every collision pass.
+	Here all member indices sit in one array, object i owning [offsets[i], offsets[i + 1]), so bounding every object
+	is a single linear sweep. Objects are only ever appended, which extends the arrays without touching earlier
+	objects. Bounds and centroids are in double precision whatever the scalar type of the positions, as with
+	"boundsOf()", and are only as current as the last call to "updateBounds()".
+	*/
+	template <std::uint8_t _Size>
+	class ObjectStore {
+	private:
+		// ATTRIBUTES
+		std::vector<std::uint32_t> offsets;  // Members of object i are members[offsets[i]] to members[offsets[i + 1] - 1]
+		std::vector<std::uint32_t> members;  // Particle indices of every object, object after object
+		std::vector<AABB<_Size> > object_bounds;  // Bounding box of every object
+		std::vector<Tuple<_Size> > object_centroids;  // Mean member position of every object
+	public:
+		// CONSTRUCTORS
+		ObjectStore(void) :
+			offsets(1, 0)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Return the number of objects.
+		std::uint32_t size(void) const { return (std::uint32_t)object_bounds.size(); }
+		// Return the total number of object members.
+		std::uint32_t memberCount(void) const { return (std::uint32_t)members.size(); }
+		// Reserve space for the given numbers of objects and members.
+		void reserve(std::uint32_t object_count, std::uint32_t member_count);
+
+		// Append an object with the given members, bounding it at the given positions.
+		template <typename _Scalar>
+		void push_back(const std::vector<std::uint32_t>& indices, const std::vector<Tuple<_Size, _Scalar> >& positions);
+		// Return the members of the given object.
+		ObjectView operator[](std::uint32_t object) const { return ObjectView{ members.data() + offsets[object], members.data() + offsets[object + 1] }; }
+
+		// Return the bounding box of every object.
+		const std::vector<AABB<_Size> >& bounds(void) const { return object_bounds; }
+		// Return the centroid of every object.
+		const std::vector<Tuple<_Size> >& centroids(void) const { return object_centroids; }
+
+		// Recompute the bounds and centroids of objects [begin, end) at the given positions.
+		template <typename _Scalar>
+		void updateBounds(const std::vector<Tuple<_Size, _Scalar> >& positions, std::uint32_t begin, std::uint32_t end);
+		// Replace every member index i with new_index[i].
+		void remap(const std::vector<std::uint32_t>& new_index);
+	};
+
+
+	template <std::uint8_t _Size>
+	void ObjectStore<_Size>::reserve(std::uint32_t object_count, std::uint32_t member_count) {
+		offsets.reserve(object_count + 1);
+		members.reserve(member_count);
+		object_bounds.reserve(object_count);
+		object_centroids.reserve(object_count);
+	}
+
+	template <std::uint8_t _Size>
+	template <typename _Scalar>
+	void ObjectStore<_Size>::push_back(const std::vector<std::uint32_t>& indices, const std::vector<Tuple<_Size, _Scalar> >& positions) {
+		members.insert(members.end(), indices.begin(), indices.end());
+		offsets.push_back((std::uint32_t)members.size());
+		object_bounds.push_back(AABB<_Size>());
+		object_centroids.push_back(Tuple<_Size>());
+		updateBounds(positions, size() - 1, size());
+	}
+
+	template <std::uint8_t _Size>
+	template <typename _Scalar>
+	void ObjectStore<_Size>::updateBounds(const std::vector<Tuple<_Size, _Scalar> >& positions, std::uint32_t begin, std::uint32_t end) {
+		for (std::uint32_t object = begin; object < end; object++) {
+			if (offsets[object] == offsets[object + 1])  // An empty object keeps an empty box at the origin
+				continue;
+
+			Tuple<_Size> point(positions[members[offsets[object]]]);
+			AABB<_Size> box(point, point);
+			Tuple<_Size> sum(point);
+			for (std::uint32_t m = offsets[object] + 1; m < offsets[object + 1]; m++) {
+				point = Tuple<_Size>(positions[members[m]]);
+				box.expand(point);
+				sum += point;
+			}
+
+			object_bounds[object] = box;
+			object_centroids[object] = sum / (double)(offsets[object + 1] - offsets[object]);
+		}
+	}
+
+	template <std::uint8_t _Size>
+	void ObjectStore<_Size>::remap(const std::vector<std::uint32_t>& new_index) {
+		for (std::uint32_t& member : members)
+			member = new_index[member];
+	}
+}
+
+#endif
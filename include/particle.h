@@ -6,6 +6,7 @@
 #define BRAZEN_PARTICLE_H
 
 #include "tuple.h"
+#include "tuple_expression.h"
 #include <stdlib.h>  // std::uint8_t
 
 struct color {
@@ -22,51 +23,54 @@ struct color {
 namespace Brazen {
 	/*
 	Struct Particle - represents a massive, infinitessimal particle in N-dimensional Euclidean space.
+	_Scalar is the type of every component and of the mass (see "Tuple").
 	*/
-	template <std::uint8_t _Size>
+	template <std::uint8_t _Size, typename _Scalar = double>
 	struct Particle {
 		// ATTRIBUTES
-		Tuple<_Size> pos, vel, F;  // Classical particle descriptions
-		Tuple<_Size> m_delta_pos, m_delta_vel;  // Additional properties for ragdoll physics
-		Tuple<_Size> m_delta_pos_hard, m_delta_vel_hard;  // Even more properties for ragdoll physics
-		double mass, invMass;
+		Tuple<_Size, _Scalar> pos, vel, F;  // Classical particle descriptions
+		Tuple<_Size, _Scalar> m_delta_pos, m_delta_vel;  // Additional properties for ragdoll physics (kept sparsely by ParticleStore)
+		Tuple<_Size, _Scalar> m_delta_pos_hard, m_delta_vel_hard;  // Even more properties for ragdoll physics
+		_Scalar mass, invMass;
 
 		// CONSTRUCTORS
-		Particle(Tuple<_Size> pos, double mass) :
+		Particle(Tuple<_Size, _Scalar> pos, _Scalar mass) :
 			pos(pos), vel(true), F(true),
 			mass(mass),
-			invMass(mass > 0 ? 1. / mass : 0.)
+			invMass(mass > 0 ? _Scalar(1) / mass : _Scalar(0))
 		{}
-		Particle(Tuple<_Size> pos, double mass, double invMass) :
+		Particle(Tuple<_Size, _Scalar> pos, _Scalar mass, _Scalar invMass) :
 			pos(pos), vel(true), F(true),
 			mass(mass),
 			invMass(invMass)
 		{}
-		Particle(Tuple<_Size> pos, Tuple<_Size> vel, double mass) :
+		Particle(Tuple<_Size, _Scalar> pos, Tuple<_Size, _Scalar> vel, _Scalar mass) :
 			pos(pos), vel(vel), F(true),
 			mass(mass),
-			invMass(mass > 0 ? 1. / mass : 0.)
+			invMass(mass > 0 ? _Scalar(1) / mass : _Scalar(0))
 		{}
-		Particle(Tuple<_Size> pos, Tuple<_Size> vel, double mass, double invMass)) :
+		Particle(Tuple<_Size, _Scalar> pos, Tuple<_Size, _Scalar> vel, _Scalar mass, _Scalar invMass) :
 			pos(pos), vel(vel), F(true),
 			mass(mass),
 			invMass(invMass)
 		{}
-		Particle(const Particle<_Size>& p) :
+		Particle(const Particle<_Size, _Scalar>& p) :
 			pos(p.pos), vel(p.vel), F(true),
-			mass(p.mass), invMass(p.invmass)
+			mass(p.mass), invMass(p.invMass)
 		{}
 		
 		// MEMBER FUNCTIONS
 		void update(double seconds_per_cycle) {
+			const _Scalar dt = seconds_per_cycle;
+
 			// Update the particle's acceleration, velocity, and position to reflect the forces applied to it
 			if (invMass > 0) {
 				// Ragdoll physics updates
-				vel += m_delta_vel * invMass;
-				pos += m_delta_pos * invMass;
+				vel += lazy(m_delta_vel) * invMass;
+				pos += lazy(m_delta_pos) * invMass;
 
 				// Classical velocity update
-				vel += F * (invMass * seconds_per_cycle);
+				vel += lazy(F) * (invMass * dt);
 			}
 			else {
 				// Other ragdoll physics updates
@@ -82,7 +86,7 @@ namespace Brazen {
 			m_delta_pos.setZero();
 
 			// Classical position update
-			pos += vel * seconds_per_cycle;
+			pos += lazy(vel) * dt;
 
 			F.setZero();  // Reset the net force on the particle
 		}
@@ -95,15 +99,15 @@ namespace Brazen {
 	/*
 	Struct OutputParticle - same as "Particle," except only contains information required to display it.
 	*/
-	template <std::uint8_t _Size>
+	template <std::uint8_t _Size, typename _Scalar = double>
 	struct OutputParticle {
-		Tuple<_Size> pos;
+		Tuple<_Size, _Scalar> pos;
 		color colorVal;
 
 		OutputParticle(void) :
 			pos(true)
 		{}
-		OutputParticle(const Particle<_Size>& p) :
+		OutputParticle(const Particle<_Size, _Scalar>& p) :
 			pos(p.pos)
 		{}
 	};
@@ -0,0 +1,306 @@
+// particle_store.h
+// Written by Weston Cook
+// Defines the structs ParticleRef and ParticleStore
+
+#ifndef BRAZEN_PARTICLE_STORE_H
+#define BRAZEN_PARTICLE_STORE_H
+
+#include "tuple.h"
+#include "particle.h"
+#include "integration_kernels.h"
+#include "ragdoll_corrections.h"
+#include <vector>  // std::vector
+#include <cstdint>  // std::uint8_t, std::uint32_t
+#include <utility>  // std::swap
+
+namespace Brazen {
+	/*
+	Struct ParticleRef - array-of-structs view of one particle in a ParticleStore.
+	Has the same members as "Particle," but each one refers to the particle's entry in the store,
+	so code written against "particles[i].pos" works unchanged on a ParticleStore.
+	The ragdoll corrections refer to the store's sparse correction table (see "CorrectionRef").
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	struct ParticleRef {
+		// ATTRIBUTES
+		Tuple<_Size, _Scalar> &pos, &vel, &F;
+		CorrectionRef<_Size, _Scalar> m_delta_pos, m_delta_vel;
+		CorrectionRef<_Size, _Scalar> m_delta_pos_hard, m_delta_vel_hard;
+		_Scalar &mass, &invMass;
+
+		// CONSTRUCTORS
+		ParticleRef(Tuple<_Size, _Scalar>& pos, Tuple<_Size, _Scalar>& vel, Tuple<_Size, _Scalar>& F,
+			RagdollCorrections<_Size, _Scalar>& corrections, std::uint32_t index,
+			_Scalar& mass, _Scalar& invMass) :
+			pos(pos), vel(vel), F(F),
+			m_delta_pos(corrections, index, &RagdollCorrection<_Size, _Scalar>::delta_pos),
+			m_delta_vel(corrections, index, &RagdollCorrection<_Size, _Scalar>::delta_vel),
+			m_delta_pos_hard(corrections, index, &RagdollCorrection<_Size, _Scalar>::delta_pos_hard),
+			m_delta_vel_hard(corrections, index, &RagdollCorrection<_Size, _Scalar>::delta_vel_hard),
+			mass(mass), invMass(invMass)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Return a copy of the referenced particle.
+		operator Particle<_Size, _Scalar>(void) const {
+			return Particle<_Size, _Scalar>(pos, vel, mass, invMass);
+		}
+	};
+
+	/*
+	Struct ParticleStore - structure-of-arrays storage for particles.
+
+	Every particle attribute lives in its own contiguous array, so the integration loop
+	streams linearly through exactly the data it needs instead of striding over whole
+	"Particle" structs. "operator[]" returns a ParticleRef for array-of-structs style access.
+
+	Ragdoll corrections are cold data: few particles receive any in a cycle, so they are kept in the sparse
+	"corrections" table rather than in arrays beside the hot state, and the integration kernels only stream
+	positions, velocities, forces and inverse masses.
+
+	Static particles (invMass == 0) do not respond to forces, so once "partition()" has moved them behind the
+	dynamic ones, "integrate()" runs the batch kernel over the dynamic range only. A static particle is touched
+	again only when it receives a correction or has a velocity (a "kinematic" particle, moved by vel * dt).
+	The forces accumulated on static particles are never read, so they are not reset either.
+
+	A dynamic particle can also be put to sleep ("setAsleep()"), which partitions it out of the integrated range
+	with the static ones until it is woken. It keeps its mass; the caller zeroes its velocity.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	struct ParticleStore {
+		static_assert(sizeof(Tuple<_Size, _Scalar>) == _Size * sizeof(_Scalar), "Batch kernels require Tuple<_Size, _Scalar> to be _Size packed scalars.");
+
+		// ATTRIBUTES
+		std::vector<Tuple<_Size, _Scalar> > pos, vel, F;  // Classical particle descriptions
+		std::vector<_Scalar> mass, invMass;
+		RagdollCorrections<_Size, _Scalar> corrections;  // Ragdoll physics corrections received this cycle, by particle index
+	private:
+		std::uint32_t dynamic_count;  // Particles [0, dynamic_count) are dynamic
+		bool partitioned;  // Whether particles [dynamic_count, size()) are all static
+		std::vector<std::uint32_t> kinematic;  // Static particles that may have a velocity, if partitioned
+		std::vector<bool> is_kinematic;  // Whether each particle is in "kinematic"
+		std::vector<bool> asleep;  // Whether each particle is asleep
+
+		// Add the given static particle to "kinematic" if it is not already there.
+		void addKinematic(std::uint32_t i);
+	public:
+		// CONSTRUCTORS
+		ParticleStore(void) :
+			dynamic_count(0), partitioned(true)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Return the number of particles in the store.
+		std::uint32_t size(void) const { return (std::uint32_t)pos.size(); }
+		// Reserve space for "count" particles in every array.
+		void reserve(std::uint32_t count);
+		// Append a copy of the given particle.
+		void push_back(const Particle<_Size, _Scalar>& p);
+
+		// Return an array-of-structs view of the particle with the given index.
+		ParticleRef<_Size, _Scalar> operator[](std::uint32_t i) {
+			return ParticleRef<_Size, _Scalar>(pos[i], vel[i], F[i],
+				corrections, i, mass[i], invMass[i]);
+		}
+		// Return a copy of the particle with the given index.
+		Particle<_Size, _Scalar> get(std::uint32_t i) const {
+			return Particle<_Size, _Scalar>(pos[i], vel[i], mass[i], invMass[i]);
+		}
+
+		// Return the flat arrays the batch integration kernels work on.
+		IntegrationArrays<_Scalar> arrays(void);
+
+		// Return the number of leading particles that are dynamic: particles [0, dynamicCount()) all have invMass > 0 and are awake.
+		std::uint32_t dynamicCount(void) const { return dynamic_count; }
+		// Return whether every particle from "dynamicCount()" on is static or asleep. Appending a dynamic particle after
+		//	a static one, or putting a particle to sleep or waking it, clears it.
+		bool isPartitioned(void) const { return partitioned; }
+		// Move every static or sleeping particle behind the awake dynamic ones, keeping the relative order of each, and
+		//	pending corrections with them. Stores the new index of the particle that had index i in new_index[i].
+		void partition(std::vector<std::uint32_t>& new_index);
+
+		// Return whether the particle with the given index is asleep.
+		bool isAsleep(std::uint32_t i) const { return asleep[i]; }
+		// Put the dynamic particle with the given index to sleep, or wake it.
+		void setAsleep(std::uint32_t i, bool sleep);
+
+		// Apply and clear every particle's ragdoll corrections. Only visits the particles that received some.
+		void applyCorrections(void);
+
+		// Update the velocity and position of every particle to reflect the forces and corrections applied to it.
+		//	Equivalent to calling "Particle::update()" on every particle. Runs the most capable batch kernel the CPU supports.
+		void integrate(double seconds_per_cycle);
+		// Same as "integrate(seconds_per_cycle)," but only for the particles [begin, end), and without applying
+		//	ragdoll corrections: call "applyCorrections()" first, once for the whole store. With a partitioned
+		//	store, run this over [0, dynamicCount()) and "integrateStatic()" once.
+		void integrate(double seconds_per_cycle, std::uint32_t begin, std::uint32_t end);
+		// Move the static particles that have a velocity. Only valid if the store is partitioned.
+		void integrateStatic(double seconds_per_cycle);
+	};
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::reserve(std::uint32_t count) {
+		pos.reserve(count);
+		vel.reserve(count);
+		F.reserve(count);
+		mass.reserve(count);
+		invMass.reserve(count);
+		corrections.reserve(count);
+		is_kinematic.reserve(count);
+		asleep.reserve(count);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::push_back(const Particle<_Size, _Scalar>& p) {
+		if (p.invMass > 0) {
+			if (dynamic_count == size())
+				dynamic_count++;
+			else
+				partitioned = false;  // Dynamic particle behind a static one
+		}
+
+		pos.push_back(p.pos);
+		vel.push_back(p.vel);
+		F.push_back(p.F);
+		mass.push_back(p.mass);
+		invMass.push_back(p.invMass);
+
+		RagdollCorrection<_Size, _Scalar> c;
+		c.delta_pos = p.m_delta_pos;
+		c.delta_vel = p.m_delta_vel;
+		c.delta_pos_hard = p.m_delta_pos_hard;
+		c.delta_vel_hard = p.m_delta_vel_hard;
+		corrections.resize(size());
+		corrections.add(size() - 1, c);
+
+		is_kinematic.push_back(false);
+		asleep.push_back(false);
+		if (!(p.invMass > 0))
+			addKinematic(size() - 1);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::addKinematic(std::uint32_t i) {
+		if (partitioned && !is_kinematic[i]) {
+			is_kinematic[i] = true;
+			kinematic.push_back(i);
+		}
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::setAsleep(std::uint32_t i, bool sleep) {
+		if (asleep[i] == sleep)
+			return;
+
+		asleep[i] = sleep;
+		if (sleep ? i < dynamic_count : invMass[i] > 0)  // Now on the wrong side of the partition
+			partitioned = false;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::partition(std::vector<std::uint32_t>& new_index) {
+		// Awake dynamic particles first, then static and sleeping ones, each in their current order
+		std::vector<std::uint32_t> old_index;
+		old_index.reserve(size());
+		for (std::uint32_t i = 0; i < size(); i++)
+			if (invMass[i] > 0 && !asleep[i])
+				old_index.push_back(i);
+		dynamic_count = (std::uint32_t)old_index.size();
+		for (std::uint32_t i = 0; i < size(); i++)
+			if (!(invMass[i] > 0) || asleep[i])
+				old_index.push_back(i);
+
+		new_index.resize(size());
+		for (std::uint32_t i = 0; i < size(); i++)
+			new_index[old_index[i]] = i;
+
+		// Gather every array into its new order
+		std::vector<Tuple<_Size, _Scalar> > tuples(size());
+		for (std::vector<Tuple<_Size, _Scalar> >* attribute : { &pos, &vel, &F }) {
+			for (std::uint32_t i = 0; i < size(); i++)
+				tuples[i] = (*attribute)[old_index[i]];
+			std::swap(*attribute, tuples);
+		}
+		std::vector<_Scalar> scalars(size());
+		for (std::vector<_Scalar>* attribute : { &mass, &invMass }) {
+			for (std::uint32_t i = 0; i < size(); i++)
+				scalars[i] = (*attribute)[old_index[i]];
+			std::swap(*attribute, scalars);
+		}
+		corrections.permute(new_index);
+		std::vector<bool> flags(size());
+		for (std::uint32_t i = 0; i < size(); i++)
+			flags[i] = asleep[old_index[i]];
+		std::swap(asleep, flags);
+
+		// Every static particle may have a velocity until "integrateStatic()" finds otherwise
+		partitioned = true;
+		kinematic.clear();
+		is_kinematic.assign(size(), false);
+		for (std::uint32_t i = dynamic_count; i < size(); i++)
+			addKinematic(i);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::applyCorrections(void) {
+		// Hard corrections can give a static particle a velocity
+		for (std::uint32_t i : corrections.correctedParticles())
+			if (!(invMass[i] > 0))
+				addKinematic(i);
+
+		corrections.apply(pos, vel, invMass);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	IntegrationArrays<_Scalar> ParticleStore<_Size, _Scalar>::arrays(void) {
+		IntegrationArrays<_Scalar> a;
+
+		a.pos = reinterpret_cast<_Scalar*>(pos.data());
+		a.vel = reinterpret_cast<_Scalar*>(vel.data());
+		a.F = reinterpret_cast<_Scalar*>(F.data());
+		a.invMass = invMass.data();
+		a.count = size();
+
+		return a;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::integrate(double seconds_per_cycle) {
+		applyCorrections();
+
+		if (partitioned) {
+			integrateBatch<_Size, _Scalar>(arrays(), seconds_per_cycle, 0, dynamic_count);
+			integrateStatic(seconds_per_cycle);
+		}
+		else  // The batch kernels are correct for static particles too, just not selective
+			integrateBatch<_Size, _Scalar>(arrays(), seconds_per_cycle, 0, size());
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::integrate(double seconds_per_cycle, std::uint32_t begin, std::uint32_t end) {
+		integrateBatch<_Size, _Scalar>(arrays(), seconds_per_cycle, begin, end);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void ParticleStore<_Size, _Scalar>::integrateStatic(double seconds_per_cycle) {
+		const _Scalar dt = seconds_per_cycle, zero = _Scalar(0);
+		std::uint32_t kept = 0;
+
+		for (std::uint32_t i : kinematic) {
+			bool moving = false;
+			for (std::uint8_t k = 0; k < _Size; k++)
+				moving |= !(vel[i][k] == zero);
+
+			if (moving) {
+				pos[i] += vel[i] * dt;
+				kinematic[kept++] = i;
+			}
+			else  // At rest until a correction moves it
+				is_kinematic[i] = false;
+		}
+		kinematic.resize(kept);
+	}
+}
+
+#endif
@@ -0,0 +1,192 @@
+// ragdoll_corrections.h
+// Written by Weston Cook
+// Defines the structs RagdollCorrection and CorrectionRef and the class RagdollCorrections
+
+#ifndef BRAZEN_RAGDOLL_CORRECTIONS_H
+#define BRAZEN_RAGDOLL_CORRECTIONS_H
+
+#include "tuple.h"
+#include <vector>  // std::vector
+#include <memory>  // std::unique_ptr
+#include <mutex>  // std::mutex, std::lock_guard
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Struct RagdollCorrection - the ragdoll physics corrections one particle has received since it was last integrated.
+	Dynamic particles apply "delta_pos" and "delta_vel" scaled by their inverse mass; static particles apply the "hard"
+	corrections as they are.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	struct RagdollCorrection {
+		Tuple<_Size, _Scalar> delta_pos, delta_vel;
+		Tuple<_Size, _Scalar> delta_pos_hard, delta_vel_hard;
+
+		// Zero every correction
+		void setZero(void) {
+			delta_pos.setZero();
+			delta_vel.setZero();
+			delta_pos_hard.setZero();
+			delta_vel_hard.setZero();
+		}
+	};
+
+	/*
+	Class RagdollCorrections - sparse storage for the ragdoll corrections of a set of particles, keyed by particle index.
+
+	Most particles never receive a correction, so storing four correction Tuples next to every particle's position,
+	velocity and force made the integration loop stream (and re-zero) mostly zeros. Here a particle only gets an entry
+	the first time it is corrected in a cycle; "apply()" visits just those entries and then empties the table.
+
+	Entries live in fixed-size pages that are kept between cycles, so a steady state allocates nothing, and an entry
+	never moves once created. Creating entries is serialized by a mutex, so corrections may be added from several
+	threads at once as long as no two threads correct the same particle concurrently (which spring colors guarantee).
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	class RagdollCorrections {
+	private:
+		// ATTRIBUTES
+		static constexpr std::uint32_t PAGE_SIZE = 256;  // Entries per page
+
+		std::vector<RagdollCorrection<_Size, _Scalar>*> entry_of;  // Entry of every particle, or nullptr if it has none this cycle
+		std::vector<std::uint32_t> corrected;  // Index of the particle owning each entry, in creation order
+		std::vector<std::unique_ptr<RagdollCorrection<_Size, _Scalar>[]> > pages;  // Entry storage
+		std::mutex insertion_mutex;  // Serializes entry creation
+	public:
+		// CONSTRUCTORS
+		RagdollCorrections(void) = default;
+		RagdollCorrections(const RagdollCorrections<_Size, _Scalar>& c) = delete;
+
+		// MEMBER FUNCTIONS
+		// Return the number of particles the table covers.
+		std::uint32_t particleCount(void) const { return (std::uint32_t)entry_of.size(); }
+		// Cover "count" particles. Particles past the old count start without corrections.
+		void resize(std::uint32_t count) { entry_of.resize(count, nullptr); }
+		// Reserve space to cover "count" particles.
+		void reserve(std::uint32_t count) { entry_of.reserve(count); }
+
+		// Return the number of particles with a correction this cycle.
+		std::uint32_t size(void) const { return (std::uint32_t)corrected.size(); }
+		// Return the indices of the particles with a correction this cycle, in the order they received their first one.
+		const std::vector<std::uint32_t>& correctedParticles(void) const { return corrected; }
+		// Return the corrections of the given particle, creating a zeroed entry if it has none.
+		RagdollCorrection<_Size, _Scalar>& at(std::uint32_t particle);
+		// Add the given corrections to those of the given particle. Creates no entry if they are all zero.
+		void add(std::uint32_t particle, const RagdollCorrection<_Size, _Scalar>& c);
+		// Return the corrections of the given particle, or nullptr if it has none.
+		const RagdollCorrection<_Size, _Scalar>* find(std::uint32_t particle) const { return entry_of[particle]; }
+
+		// Apply every correction to the given particle velocities and positions (indexed like the table) and remove it.
+		void apply(std::vector<Tuple<_Size, _Scalar> >& pos, std::vector<Tuple<_Size, _Scalar> >& vel, const std::vector<_Scalar>& invMass);
+		// Remove every correction without applying it.
+		void clear(void);
+		// Move the corrections of particle i to particle new_index[i], for every i.
+		void permute(const std::vector<std::uint32_t>& new_index);
+	};
+
+
+	/*
+	Struct CorrectionRef - one correction of one particle in a RagdollCorrections table, used by "ParticleRef"
+	so "particles[i].m_delta_pos += d" keeps working. Reading gives zero for a particle without corrections;
+	only adding to it creates an entry.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	struct CorrectionRef {
+		// ATTRIBUTES
+		RagdollCorrections<_Size, _Scalar>& corrections;
+		std::uint32_t particle;
+		Tuple<_Size, _Scalar> RagdollCorrection<_Size, _Scalar>::* field;
+
+		// CONSTRUCTORS
+		CorrectionRef(RagdollCorrections<_Size, _Scalar>& corrections, std::uint32_t particle, Tuple<_Size, _Scalar> RagdollCorrection<_Size, _Scalar>::* field) :
+			corrections(corrections), particle(particle), field(field)
+		{}
+
+		// MEMBER FUNCTIONS
+		operator Tuple<_Size, _Scalar>(void) const {
+			const RagdollCorrection<_Size, _Scalar>* entry = corrections.find(particle);
+			return entry ? entry->*field : Tuple<_Size, _Scalar>();
+		}
+
+		CorrectionRef<_Size, _Scalar>& operator+=(const Tuple<_Size, _Scalar>& v) {
+			corrections.at(particle).*field += v;
+			return *this;
+		}
+		CorrectionRef<_Size, _Scalar>& operator-=(const Tuple<_Size, _Scalar>& v) {
+			corrections.at(particle).*field -= v;
+			return *this;
+		}
+	};
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	RagdollCorrection<_Size, _Scalar>& RagdollCorrections<_Size, _Scalar>::at(std::uint32_t particle) {
+		if (entry_of[particle])
+			return *entry_of[particle];
+
+		std::lock_guard<std::mutex> insertion_lock(insertion_mutex);
+		std::uint32_t entry = (std::uint32_t)corrected.size();
+		if (entry == pages.size() * PAGE_SIZE)
+			pages.emplace_back(new RagdollCorrection<_Size, _Scalar>[PAGE_SIZE]);  // Zeroed by Tuple's constructor
+
+		corrected.push_back(particle);
+		entry_of[particle] = &pages[entry / PAGE_SIZE][entry % PAGE_SIZE];
+		return *entry_of[particle];
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void RagdollCorrections<_Size, _Scalar>::add(std::uint32_t particle, const RagdollCorrection<_Size, _Scalar>& c) {
+		const _Scalar zero = _Scalar(0);
+		bool any = false;
+		for (std::uint8_t k = 0; k < _Size; k++)
+			any |= !(c.delta_pos[k] == zero) || !(c.delta_vel[k] == zero) || !(c.delta_pos_hard[k] == zero) || !(c.delta_vel_hard[k] == zero);
+		if (!any)
+			return;
+
+		RagdollCorrection<_Size, _Scalar>& entry = at(particle);
+		entry.delta_pos += c.delta_pos;
+		entry.delta_vel += c.delta_vel;
+		entry.delta_pos_hard += c.delta_pos_hard;
+		entry.delta_vel_hard += c.delta_vel_hard;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void RagdollCorrections<_Size, _Scalar>::apply(std::vector<Tuple<_Size, _Scalar> >& pos, std::vector<Tuple<_Size, _Scalar> >& vel, const std::vector<_Scalar>& invMass) {
+		for (std::uint32_t particle : corrected) {
+			const RagdollCorrection<_Size, _Scalar>& c = *entry_of[particle];
+
+			if (invMass[particle] > 0) {
+				vel[particle] += c.delta_vel * invMass[particle];
+				pos[particle] += c.delta_pos * invMass[particle];
+			}
+			else {
+				vel[particle] += c.delta_vel_hard;
+				pos[particle] += c.delta_pos_hard;
+			}
+		}
+
+		clear();
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void RagdollCorrections<_Size, _Scalar>::clear(void) {
+		for (std::uint32_t particle : corrected) {
+			entry_of[particle]->setZero();  // Pages are reused, so entries must be zero when they are handed out again
+			entry_of[particle] = nullptr;
+		}
+		corrected.clear();
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void RagdollCorrections<_Size, _Scalar>::permute(const std::vector<std::uint32_t>& new_index) {
+		std::vector<RagdollCorrection<_Size, _Scalar>*> moved(entry_of.size(), nullptr);
+
+		for (std::uint32_t& particle : corrected) {
+			moved[new_index[particle]] = entry_of[particle];
+			particle = new_index[particle];
+		}
+		entry_of.swap(moved);
+	}
+}
+
+#endif
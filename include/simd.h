@@ -0,0 +1,107 @@
+// simd.h
+// Written by Weston Cook
+// Defines runtime detection of the SIMD instruction sets used by Brazen's batch kernels
+
+#ifndef BRAZEN_SIMD_H
+#define BRAZEN_SIMD_H
+
+#include <cstdint>  // std::uint32_t, std::uint64_t
+
+// Compile the AVX2/AVX-512 kernels on x86 unless BRAZEN_NO_SIMD is defined.
+//	The kernels are compiled for their instruction set function-by-function (BRAZEN_TARGET),
+//	so no compiler flags are needed; which one runs is decided at runtime by "detectSimdLevel()".
+#if !defined(BRAZEN_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define BRAZEN_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>  // __cpuidex, _xgetbv
+#define BRAZEN_TARGET(isa)
+#else
+#include <cpuid.h>  // __get_cpuid_count
+#define BRAZEN_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace Brazen {
+	/*
+	Enum SimdLevel - instruction sets a batch kernel can be implemented with, from least to most capable.
+	*/
+	enum class SimdLevel {
+		SCALAR,  // Portable C++
+		AVX2,  // 256-bit vectors
+		AVX512  // 512-bit vectors (AVX-512F)
+	};
+
+	// Return the name of the given SIMD level.
+	inline const char* simdLevelName(SimdLevel level) {
+		switch (level) {
+		case SimdLevel::AVX2:
+			return "AVX2";
+		case SimdLevel::AVX512:
+			return "AVX-512";
+		default:
+			return "scalar";
+		}
+	}
+
+#ifdef BRAZEN_X86_SIMD
+	// Query CPUID leaf "leaf," subleaf "subleaf" into registers[4] = { eax, ebx, ecx, edx }. Return false if the leaf is unsupported.
+	inline bool cpuid(std::uint32_t leaf, std::uint32_t subleaf, std::uint32_t registers[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		int max_leaf[4];
+		__cpuidex(max_leaf, leaf & 0x80000000, 0);
+		if ((std::uint32_t)max_leaf[0] < leaf)
+			return false;
+		__cpuidex((int*)registers, leaf, subleaf);
+		return true;
+#else
+		return __get_cpuid_count(leaf, subleaf, &registers[0], &registers[1], &registers[2], &registers[3]) != 0;
+#endif
+	}
+
+	// Return the OS-enabled register state mask (XCR0). Only valid when CPUID reports OSXSAVE.
+	BRAZEN_TARGET("xsave") inline std::uint64_t xcr0(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		return _xgetbv(0);
+#else
+		std::uint32_t eax, edx;
+		__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return ((std::uint64_t)edx << 32) | eax;
+#endif
+	}
+#endif
+
+	// Return the most capable SIMD level supported by both the CPU and the operating system.
+	inline SimdLevel detectSimdLevel(void) {
+#ifdef BRAZEN_X86_SIMD
+		std::uint32_t registers[4];
+
+		// The OS must save AVX state across context switches (OSXSAVE, then XCR0 bits for XMM/YMM)
+		if (!cpuid(1, 0, registers) || !(registers[2] & (1u << 27)))
+			return SimdLevel::SCALAR;
+		std::uint64_t enabled_state = xcr0();
+		if ((enabled_state & 0x6) != 0x6)
+			return SimdLevel::SCALAR;
+
+		if (!cpuid(7, 0, registers))
+			return SimdLevel::SCALAR;
+		bool avx2 = (registers[1] & (1u << 5)) != 0;
+		bool avx512f = (registers[1] & (1u << 16)) != 0;
+
+		// AVX-512 additionally needs the opmask and upper ZMM state enabled
+		if (avx512f && (enabled_state & 0xe6) == 0xe6)
+			return SimdLevel::AVX512;
+		if (avx2)
+			return SimdLevel::AVX2;
+#endif
+		return SimdLevel::SCALAR;
+	}
+
+	// Return the SIMD level batch kernels dispatch to. Detected once, on first use.
+	inline SimdLevel simdLevel(void) {
+		static const SimdLevel level = detectSimdLevel();
+		return level;
+	}
+}
+
+#endif
@@ -7,207 +7,851 @@
 
 #include "tuple.h"
 #include "particle.h"
+#include "particle_store.h"
+#include "integrators.h"
+#include "implicit_euler.h"
 #include "spring.h"
 #include "object.h"
+#include "triple_buffer.h"
+#include "aabb.h"
+#include "object_store.h"
+#include "topology.h"
+#include "command_queue.h"
+#include "islands.h"
+#include "validation.h"
+#include "uniform_grid.h"
+#include "sweep_and_prune.h"
+#include "aabb_tree.h"
+#include "spring_coloring.h"
+#include "thread_pool.h"
 #include <vector>  // std::vector
-#include <chrono>
-#include <atomic>  // std::atomic_bool
+#include <chrono>  // std::chrono::steady_clock, std::chrono::duration
+#include <atomic>  // std::atomic_bool, std::atomic
 #include <mutex>  // std::mutex, std::lock_guard
 #include <thread>  // std::thread
+#include <memory>  // std::unique_ptr
+#include <iterator>  // std::make_move_iterator, std::distance
 #include <stdlib.h>  // std::uint32_t
 #include <algorithm>  // std::find
+#include <utility>  // std::move
 
 namespace Brazen {
 	typedef std::chrono::time_point<std::chrono::steady_clock> time_point;
 
+	/*
+	Enum BroadPhase - ways the Simulator can find the pairs of objects that may be colliding.
+	*/
+	enum class BroadPhase {
+		ALL_PAIRS,  // Test every pair of objects
+		UNIFORM_GRID,  // Hash object bounding boxes into a uniform grid (UniformGrid)
+		SWEEP_AND_PRUNE,  // Sort object bounding boxes along their widest axis, incrementally (SweepAndPrune)
+		AABB_TREE  // Query a dynamic bounding volume hierarchy of object bounding boxes (AABBTree)
+	};
+
 	/*
 	Class Simulator - stores and manages all particle information and exposes environment state through a std::vector<OutputParticle>.
+	_Scalar is the type particle state is stored and integrated in (see "Tuple"). Broad phase bounding boxes and
+	object queries stay in double precision whatever it is.
+	_Integrator is the policy that advances the particles each cycle (see "integrators.h"): SymplecticEuler (the default),
+	PositionVerlet, VelocityVerlet, RungeKutta4 or ImplicitEuler. Springs are evaluated as many times per cycle as it asks;
+	ImplicitEuler builds their Jacobian instead, and is told to rebuild its sparsity pattern whenever springs are added.
+
+	Particles keep the index "addParticle()" gave them, but are stored with the static ones (invMass == 0) behind the
+	dynamic ones so integration can skip them (see "ParticleStore::partition()"). Springs and objects are stored with
+	storage indices, remapped whenever new particles break the partition.
+
+	Islands of particles joined by springs or objects can be put to sleep (see "setSleepThreshold()" and "Islands"). A
+	sleeping island is partitioned out of integration with the static particles, its springs are set aside, and its
+	objects keep their last bounds and skip the narrow phase against other sleeping or static objects, so it costs
+	nothing but its place in the broad phase. An awake object overlapping it, new springs or objects joining it,
+	"applyImpulse()" and "wakeParticle()" wake it. Sleeping or waking an island repartitions the particles and
+	recolors the springs, which is as much work as a cycle, so it should happen far less often than every cycle.
+
+	Mutators that take particle or edge indices return a Status (see "validation.h"): a call with an index out of range
+	adds nothing and returns the ErrorCode, so the simulation keeps running.
 	*/
-	template <std::uint8_t _Size>
+	template <std::uint8_t _Size, typename _Scalar = double, template <std::uint8_t, typename> class _Integrator = SymplecticEuler>
 	class Simulator {
 	private:
 		// ATTRIBUTES
-		std::vector<Particle<_Size> > particles;  // Stores all the particles
-		std::vector<Spring<_Size> > springs;  // Stores all the particle connections
-		std::vector<std::vector<std::uint32_t> > objects;  // Stores all the objects lists of associated particles
+		ParticleStore<_Size, _Scalar> particles;  // Stores all the particles, static and sleeping ones last
+		std::vector<std::uint32_t> particle_slot;  // Index in "particles" of every particle, by the index it was added with
+		std::vector<std::uint32_t> particle_index;  // Index every particle was added with, by its index in "particles"
+		std::vector<std::uint32_t> new_slot;  // Scratch space for "partitionParticles()"
+		_Integrator<_Size, _Scalar> integrator;  // Advances the particles each cycle
+		std::vector<Spring<_Size, _Scalar> > springs;  // Stores all the particle connections, grouped by color (see "spring_colors")
+		ObjectStore<_Size> objects;  // Stores the particles of every object, with each object's bounding box and centroid
+
+		static constexpr std::uint32_t NO_ISLAND = 0xffffffffu;  // "object_island" of an object without dynamic particles
+
+		Islands islands;  // Islands of particles joined by springs or objects, by the index particles were added with
+		std::vector<Spring<_Size, _Scalar> > sleeping_springs;  // Springs of sleeping particles, set aside from "springs"
+		std::vector<std::uint32_t> object_island;  // A dynamic particle of every object (by the index it was added with), or NO_ISLAND
+		std::vector<bool> object_asleep;  // Whether every object's island is asleep, as of the last "updateSleeping()"
+		double sleep_threshold;  // Kinetic energy per unit mass an island must stay at or below to fall asleep, 0 to never sleep
+		std::uint32_t sleep_cycles;  // Cycles an island must stay below "sleep_threshold" to fall asleep
+		std::uint32_t sleeping_particle_count;  // Number of dynamic particles asleep
+		bool sleep_changed;  // Whether particles fell asleep or woke since the last "updateSleeping()"
+
+		// Put the particle with the given index (as added) to sleep or wake it, if it is dynamic.
+		void setParticleAsleep(std::uint32_t index, bool sleep);
+		// Set the springs of sleeping particles aside, bring back those of woken ones and refresh "object_asleep," if anything fell asleep or woke.
+		void updateSleeping(void);
+		// Return whether a collision between the two objects must be resolved, waking a sleeping one an awake one overlaps.
+		bool touchObjects(std::uint32_t a, std::uint32_t b);
+		// Measure the kinetic energy of every awake island and put the islands that stayed quiet to sleep.
+		void sleepIslands(void);
+
+		BroadPhase broad_phase;  // Method used to find candidate object collisions
+		std::vector<BoxPair> object_pairs;  // Candidate object collisions found by the ALL_PAIRS broad phase
+		UniformGrid<_Size> object_grid;  // Broad phase structure for UNIFORM_GRID
+		SweepAndPrune<_Size> object_sweep;  // Broad phase structure for SWEEP_AND_PRUNE
+		AABBTree<_Size> object_tree;  // Broad phase structure for AABB_TREE, also used by object queries
+
+		// Find the pairs of objects whose bounding boxes overlap and resolve their collisions.
+		void resolveCollisions(void);
+
+		SpringColoring spring_colors;  // Batches of springs that share no particles and can be applied in parallel
+		bool springs_changed;  // Whether springs were added since "spring_colors" was built
+		std::unique_ptr<ThreadPool> thread_pool;  // Work-stealing worker threads for the parallel phases of a physics cycle
+
+		static constexpr std::uint32_t SPRING_CHUNK = 256;  // Springs applied per task when a color is split across threads
+		static constexpr std::uint32_t OBJECT_CHUNK = 64;  // Objects bounded per task
+		static constexpr std::uint32_t PARTICLE_CHUNK = 4096;  // Particles integrated or output per task (a multiple of the SIMD block size)
+
+		// Apply the force of every spring to the particles it connects, one color at a time.
+		void applySprings(void);
+		// Move static and sleeping particles behind awake dynamic ones if particles were added out of order or fell asleep
+		//	or woke, and remap springs and objects.
+		void partitionParticles(void);
+
+		// Output data. The physics loop fills "output.writeBuffer()" and publishes it, and
+		//	"updateOutput()" takes the latest published list for "getOutput()" to return.
+		//	Neither side ever waits on the other.
+		TripleBuffer<std::vector<OutputParticle<_Size, _Scalar> > > output;
+		std::atomic<std::uint64_t> output_allocation_count;  // Number of times filling an output list had to grow its storage
+
+		// Copy the state of every particle into the output list owned by the physics loop.
+		void writeOutput(void);
 
-		// Vectors containing the output data. Basically, the output generator juggles
-		//	the "write_output" and "latest_output" pointers and the "getOutput()" function
-		//	swaps the "latest_output" and "read_output" pointers.
-		std::vector<OutputParticle<_Size> >* write_output;  // Output list that is currently being written to
-		std::vector<OutputParticle<_Size> >* latest_output;  // Output list that has just been written to
-		std::vector<OutputParticle<_Size> >* read_output;  // Output list that is protected for reading
+		std::mutex physics_mutex;  // Mutex required to read/modify "particles," "springs," or "objects"
 
-		std::mutex output_mutex;  // Mutex required to modify the three output list pointers above
-		bool output_is_ready;  // Marked true at the end of every physics loop and marked false every time "updateOutput" returns true
+		// Edits waiting for the physics loop. Every mutator goes through the queue, so particle indices follow call order.
+		CommandQueue<_Size, _Scalar, Spring<_Size, _Scalar> > commands;
+		CommandBatch<_Size, _Scalar, Spring<_Size, _Scalar> > applying;  // Batch being applied, kept for its storage
 
-		std::mutex physics_mutex;  // Mutex required to read/modify "particles," "springs," or "objects"
+		// Add every queued particle, spring and object. "physics_mutex" must be held.
+		void applyCommands(void);
+		// Add the particles, springs and objects in "applying" and empty it. "physics_mutex" must be held.
+		void applyBatch(void);
 
 		std::atomic_bool running;
 		std::thread physics_thread;
+
+		std::atomic<double> target_cycle_rate;  // Number of physics cycles per second the physics thread aims for
+		std::atomic<double> achieved_cycle_rate;  // Number of physics cycles per second the physics thread actually ran over the last measurement window
+		std::atomic<std::uint64_t> cycle_count;  // Total number of physics cycles run by the physics thread
+		std::atomic<std::uint64_t> dropped_cycle_count;  // Total number of physics cycles skipped because the physics thread fell too far behind
+		std::atomic<double> step_time_mean;  // Mean wall-clock time of one "updateState()" call over the last measurement window, in seconds
+		std::atomic<double> step_time_jitter;  // Standard deviation of the wall-clock time of one "updateState()" call over the last measurement window, in seconds
+
+		static constexpr std::uint32_t MAX_CATCHUP_CYCLES = 8;  // Most cycles the physics thread will run back-to-back to catch up before dropping the backlog
+
+		// Body of the physics thread. Runs "updateState()" at the target cycle rate until "running" is cleared.
+		void physicsLoop(void);
 	public:
 		// CONSTRUCTORS
-		Simulator(void) :  // Allocate output pointers and initialize booleans
-			write_output(new std::vector<OutputParticle<_Size> >),
-			latest_output(new std::vector<OutputParticle<_Size> >),
-			read_output(new std::vector<OutputParticle<_Size> >),
-			output_is_ready(false), running(false)
-		{}
-		~Simulator(void) {  // Free memory used by output pointers
-			delete write_output;
-			delete latest_output;
-			delete read_output;
+		Simulator(double cycles_per_second = 60.) :  // Initialize booleans and counters
+			sleep_threshold(0.), sleep_cycles(0), sleeping_particle_count(0), sleep_changed(false),
+			broad_phase(BroadPhase::UNIFORM_GRID),
+			springs_changed(false), thread_pool(new ThreadPool()),
+			output_allocation_count(0),
+			running(false),
+			target_cycle_rate(60.), achieved_cycle_rate(0.),
+			cycle_count(0), dropped_cycle_count(0),
+			step_time_mean(0.), step_time_jitter(0.)
+		{
+			setCycleRate(cycles_per_second);  // A non-positive rate is ignored with a warning, leaving 60
+		}
+		~Simulator(void) {  // Stop the physics thread
+			stop();
 		}
 
 		// MEMBER FUNCTIONS
 		// Copy the given Particle into the simulation environment.
-		void addParticle(Particle<_Size> new_particle);
+		void addParticle(Particle<_Size, _Scalar> new_particle);
+		// Copy the Particles in [first, last) into the simulation environment under a single lock and return the index of the first one.
+		template <typename Iterator>
+		std::uint32_t addParticles(Iterator first, Iterator last);
+		// Return a copy of the Particle with the given index.
+		Particle<_Size, _Scalar> getParticle(std::uint32_t index);
+		// Return the number of particles in the simulation environment.
+		std::uint32_t getParticleCount(void);
 		// Create a copy of the given Spring that connects the two particles with the given indices.
-		void attachParticles(Spring<_Size> spring);
+		Status attachParticles(Spring<_Size, _Scalar> spring);
+		// Add the given Springs (moved in), each connecting the two particles with its indices, under a single lock.
+		Status attachSprings(std::vector<Spring<_Size, _Scalar> > new_springs);
 		// Create an object composed of the particles with the given indices.
-		void createObject(std::vector<std::uint32_t> indices);
+		Status createObject(std::vector<std::uint32_t> indices);
 		// Create an object composed of the particles with the given indices as a fully-connected graph using copies the given spring.
-		void createObject(std::vector<std::uint32_t> indices, Spring<_Size> spring);
+		Status createObject(std::vector<std::uint32_t> indices, Spring<_Size, _Scalar> spring);
+		// Create an object composed of the particles with the given indices, connected by copies of the given spring along
+		//	the given edges, which index "indices" (see "topology.h" for builders of sparse, rigid edge sets).
+		Status createObject(std::vector<std::uint32_t> indices, const std::vector<SpringEdge>& edges, Spring<_Size, _Scalar> spring);
+		// Return the number of objects.
+		std::uint32_t getObjectCount(void);
+		// Return the bounding box of the object with the given index, as of the last physics cycle.
+		AABB<_Size> getObjectBounds(std::uint32_t index);
+		// Return the mean position of the particles of the object with the given index, as of the last physics cycle.
+		Tuple<_Size> getObjectCentroid(std::uint32_t index);
+		// Reserve storage for the given total numbers of particles, springs, objects and object members, so loading a
+		//	scene of known size does not regrow them.
+		void reserve(std::uint32_t particle_count, std::uint32_t spring_count, std::uint32_t object_count = 0, std::uint32_t member_count = 0);
+
+		// Put every island of particles joined by springs or objects to sleep once its kinetic energy per unit mass
+		//	(half its mean squared speed) stays at or below "energy_per_mass" for "cycles" cycles in a row, along with
+		//	every island its objects overlap. 0 (the default) never puts islands to sleep, and wakes every sleeping one.
+		void setSleepThreshold(double energy_per_mass, std::uint32_t cycles);
+		// Wake the island of the particle with the given index.
+		Status wakeParticle(std::uint32_t index);
+		// Add the given impulse, divided by the particle's mass, to the velocity of the particle with the given index, waking its island.
+		Status applyImpulse(std::uint32_t index, const Tuple<_Size, _Scalar>& impulse);
+		// Return whether the particle with the given index is asleep.
+		bool isParticleAsleep(std::uint32_t index);
+		// Return the number of particles asleep.
+		std::uint32_t getSleepingParticleCount(void);
+
+		// Deferred versions of the functions above, for producer threads that must not wait for a physics cycle.
+		//	Edits are queued and the physics loop applies them at the start of its next cycle, in the order they were
+		//	queued. Particles get their indices as they are queued, so queued springs and objects may use them at
+		//	once.
+		template <typename Iterator>
+		std::uint32_t queueParticles(Iterator first, Iterator last) { return commands.addParticles(first, last); }
+		Status queueSprings(std::vector<Spring<_Size, _Scalar> > new_springs) { return commands.addSprings(std::move(new_springs)); }
+		Status queueObject(std::vector<std::uint32_t> indices) { return commands.addObject(std::move(indices)); }
+		Status queueObject(std::vector<std::uint32_t> indices, const std::vector<SpringEdge>& edges, Spring<_Size, _Scalar> spring) {
+			return commands.addObject(std::move(indices), edges, spring);
+		}
+
+
+		// Set the method used to find candidate object collisions.
+		void setBroadPhase(BroadPhase method);
+		// Set the side length of a UNIFORM_GRID cell. 0 (the default) picks one from the object sizes every cycle.
+		void setGridCellSize(double size);
+
+
+		// Find the objects whose bounding boxes (as of the last physics cycle) overlap the given box and store their indices in "hits."
+		void queryObjects(const AABB<_Size>& box, std::vector<std::uint32_t>& hits);
+		// Find the objects whose bounding boxes (as of the last physics cycle, grown by the tree margin) are hit by the ray
+		//	origin + t * direction, 0 <= t <= max_t, and store (object index, t at which the ray enters the box) in "hits," nearest first.
+		void rayCastObjects(const Tuple<_Size>& origin, const Tuple<_Size>& direction, double max_t, std::vector<std::pair<std::uint32_t, double> >& hits);
+
+
+		// Set the number of threads a physics cycle is split across, including the thread calling "updateState()."
+		//	With "pin_threads," each worker thread is pinned to its own core.
+		void setThreadCount(std::uint32_t thread_count, bool pin_threads = false);
+		// Return the number of threads a physics cycle is split across.
+		std::uint32_t getThreadCount(void);
 
 
 		// Start the physics engine in a separate thread.
 		void start(void);
 		// Stop the physics engine.
 		void stop(void);
+		// Return whether the physics thread is running.
+		bool isRunning(void) const { return running; }
+
+		// Set the number of physics cycles per second run by the physics thread. Each cycle advances the simulation by 1 / cycles_per_second seconds.
+		void setCycleRate(double cycles_per_second);
+		// Return the number of physics cycles per second the physics thread aims for.
+		double getTargetCycleRate(void) const { return target_cycle_rate; }
+		// Return the number of physics cycles per second the physics thread achieved over the last second.
+		double getAchievedCycleRate(void) const { return achieved_cycle_rate; }
+		// Return the total number of physics cycles run by the physics thread.
+		std::uint64_t getCycleCount(void) const { return cycle_count; }
+		// Return the total number of physics cycles dropped because the physics thread could not keep up.
+		std::uint64_t getDroppedCycleCount(void) const { return dropped_cycle_count; }
+		// Return the mean wall-clock time of one physics cycle over the last second, in seconds.
+		double getStepTimeMean(void) const { return step_time_mean; }
+		// Return the standard deviation of the wall-clock time of one physics cycle over the last second, in seconds.
+		double getStepTimeJitter(void) const { return step_time_jitter; }
 
 
 		// Update the output source and return whether it contains new data.
+		//	Wait-free; must only be called from one (reader) thread at a time.
 		bool updateOutput(void);
-		// Return a reference to the latest std::vector<OutputParticle>.
-		const std::vector<OutputParticle<_Size> >& getOutput(void);
+		// Return a reference to the latest std::vector<OutputParticle>. The reference stays valid until the next "updateOutput()".
+		const std::vector<OutputParticle<_Size, _Scalar> >& getOutput(void);
+		// Return the number of times publishing output had to allocate. Stops increasing once all output lists have
+		//	grown to the particle count, so steady-state publishing performs no heap allocations.
+		std::uint64_t getOutputAllocationCount(void) const { return output_allocation_count; }
 
 		// Perform one cycle of physics calculations and update the output pointers.
 		void updateState(double seconds_per_cycle);
 	};
 
 
-	template <std::uint8_t _Size>
-	void Simulator<_Size>::addParticle(Particle<_Size> new_particle) {  // Add a copy of the given particle to "particles"
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::addParticle(Particle<_Size, _Scalar> new_particle) {  // Add a copy of the given particle to "particles"
 		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing of Particle insertion with physics loop
-		particles.push_back(new_particle);
+		commands.addParticles(&new_particle, &new_particle + 1);
+		applyCommands();
 	}
 
-	template <std::uint8_t _Size>
-	void Simulator<_Size>::attachParticles(Spring<_Size> spring) {  // Add a copy of the given spring to "springs"
-		if (spring.p1_index < particles.size() && spring.p2_index < particles.size()) {
-			std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing of Spring insertion with physics loop
-			springs.push_back(spring);
-		}
-		else {
-			std::cerr << "ERROR: Attempting to create spring using invalid particle indices. Exiting." << std::endl;
-			exit(EXIT_FAILURE);
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	template <typename Iterator>
+	std::uint32_t Simulator<_Size, _Scalar, _Integrator>::addParticles(Iterator first, Iterator last) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // One lock for the whole range
+
+		// Apply what was queued before, then add the range straight into the store
+		const std::uint32_t first_index = commands.takeAndIssue(applying, (std::uint32_t)std::distance(first, last));
+		applyBatch();
+		for (; first != last; ++first) {
+			particle_index.push_back((std::uint32_t)particle_slot.size());
+			particle_slot.push_back(particles.size());
+			particles.push_back(*first);
+			islands.add(first->invMass > 0);
 		}
+		integrator.reset();
+		return first_index;
 	}
 
-	template <std::uint8_t _Size>
-	void Simulator<_Size>::createObject(std::vector<std::uint32_t> indices) {
-		// Make sure the indices are valid
-		for (std::uint32_t index : indices)
-			if (index >= particles.size()) {
-				std::cerr << "ERROR: Attempting to create object using invalid particle indices. Exiting." << std::endl;
-				exit(EXIT_FAILURE);
-			}
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Particle<_Size, _Scalar> Simulator<_Size, _Scalar, _Integrator>::getParticle(std::uint32_t index) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		if (index >= particles.size())
+			throw std::out_of_range("Particle index " + std::to_string(index) + " out of range for " + std::to_string(particles.size()) + " particles.");
+		return particles.get(particle_slot[index]);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	std::uint32_t Simulator<_Size, _Scalar, _Integrator>::getParticleCount(void) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		return particles.size();
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Status Simulator<_Size, _Scalar, _Integrator>::attachParticles(Spring<_Size, _Scalar> spring) {  // Add a copy of the given spring to "springs"
+		return attachSprings(std::vector<Spring<_Size, _Scalar> >(1, spring));
+	}
 
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Status Simulator<_Size, _Scalar, _Integrator>::attachSprings(std::vector<Spring<_Size, _Scalar> > new_springs) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing of Spring insertion with physics loop
+		const Status status = commands.addSprings(std::move(new_springs));
+		applyCommands();
+		return status;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Status Simulator<_Size, _Scalar, _Integrator>::createObject(std::vector<std::uint32_t> indices) {
 		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing of object insertion with physics loop
-		objects.push_back(indices);
+		const Status status = commands.addObject(std::move(indices));
+		applyCommands();
+		return status;
 	}
 	
-	template <std::uint8_t _Size>
-	void Simulator<_Size>::createObject(std::vector<std::uint32_t> indices, Spring<_Size> spring) {
-		// Make sure the indices are valid
-		for (std::uint32_t index : indices)
-			if (index >= particles.size()) {
-				std::cerr << "ERROR: Attempting to create object using invalid particle indices. Exiting." << std::endl;
-				exit(EXIT_FAILURE);
-			}
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Status Simulator<_Size, _Scalar, _Integrator>::createObject(std::vector<std::uint32_t> indices, Spring<_Size, _Scalar> spring) {
+		const std::vector<SpringEdge> edges = fullyConnectedEdges((std::uint32_t)indices.size());
+		return createObject(std::move(indices), edges, spring);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Status Simulator<_Size, _Scalar, _Integrator>::createObject(std::vector<std::uint32_t> indices, const std::vector<SpringEdge>& edges, Spring<_Size, _Scalar> spring) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		const Status status = commands.addObject(std::move(indices), edges, spring);
+		applyCommands();
+		return status;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::reserve(std::uint32_t particle_count, std::uint32_t spring_count, std::uint32_t object_count, std::uint32_t member_count) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		particles.reserve(particle_count);
+		particle_slot.reserve(particle_count);
+		particle_index.reserve(particle_count);
+		islands.reserve(particle_count);
+		springs.reserve(spring_count);
+		objects.reserve(object_count, member_count);
+		object_island.reserve(object_count);
+		object_asleep.reserve(object_count);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::setSleepThreshold(double energy_per_mass, std::uint32_t cycles) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		sleep_threshold = energy_per_mass > 0. ? energy_per_mass : 0.;
+		sleep_cycles = cycles;
+		if (!(sleep_threshold > 0.))
+			islands.wakeAll([this](std::uint32_t particle) { setParticleAsleep(particle, false); });
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Status Simulator<_Size, _Scalar, _Integrator>::wakeParticle(std::uint32_t index) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		applyCommands();
+		if (VALIDATION_ENABLED && index >= particle_slot.size())
+			return ErrorCode::INVALID_PARTICLE_INDEX;
+
+		islands.wake(index, [this](std::uint32_t particle) { setParticleAsleep(particle, false); });
+		return ErrorCode::OK;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Status Simulator<_Size, _Scalar, _Integrator>::applyImpulse(std::uint32_t index, const Tuple<_Size, _Scalar>& impulse) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		applyCommands();
+		if (VALIDATION_ENABLED && index >= particle_slot.size())
+			return ErrorCode::INVALID_PARTICLE_INDEX;
+
+		islands.wake(index, [this](std::uint32_t particle) { setParticleAsleep(particle, false); });
+		particles.vel[particle_slot[index]] += impulse * particles.invMass[particle_slot[index]];
+		return ErrorCode::OK;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	bool Simulator<_Size, _Scalar, _Integrator>::isParticleAsleep(std::uint32_t index) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		if (index >= particles.size())
+			throw std::out_of_range("Particle index " + std::to_string(index) + " out of range for " + std::to_string(particles.size()) + " particles.");
+		return particles.isAsleep(particle_slot[index]);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	std::uint32_t Simulator<_Size, _Scalar, _Integrator>::getSleepingParticleCount(void) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		return sleeping_particle_count;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	std::uint32_t Simulator<_Size, _Scalar, _Integrator>::getObjectCount(void) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		return objects.size();
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	AABB<_Size> Simulator<_Size, _Scalar, _Integrator>::getObjectBounds(std::uint32_t index) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		if (index >= objects.size())
+			throw std::out_of_range("Object index " + std::to_string(index) + " out of range for " + std::to_string(objects.size()) + " objects.");
+		return objects.bounds()[index];
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	Tuple<_Size> Simulator<_Size, _Scalar, _Integrator>::getObjectCentroid(std::uint32_t index) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		if (index >= objects.size())
+			throw std::out_of_range("Object index " + std::to_string(index) + " out of range for " + std::to_string(objects.size()) + " objects.");
+		return objects.centroids()[index];
+	}
+
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::setBroadPhase(BroadPhase method) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		broad_phase = method;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::setGridCellSize(double size) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		object_grid.setCellSize(size);
+	}
 
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::queryObjects(const AABB<_Size>& box, std::vector<std::uint32_t>& hits) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+
+		if (broad_phase != BroadPhase::AABB_TREE)
+			object_tree.update(objects.bounds());  // Only kept up to date by the physics loop when it is the broad phase
+
+		hits.clear();
+		object_tree.query(box, [this, &box, &hits](std::uint32_t object) {
+			if (objects.bounds()[object].overlaps(box))
+				hits.push_back(object);
+			return true;
+		});
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::rayCastObjects(const Tuple<_Size>& origin, const Tuple<_Size>& direction, double max_t, std::vector<std::pair<std::uint32_t, double> >& hits) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+
+		if (broad_phase != BroadPhase::AABB_TREE)
+			object_tree.update(objects.bounds());  // Only kept up to date by the physics loop when it is the broad phase
+
+		hits.clear();
+		object_tree.rayCast(origin, direction, max_t, [&hits, max_t](std::uint32_t object, double t) {
+			hits.push_back(std::make_pair(object, t));
+			return max_t;
+		});
+
+		std::sort(hits.begin(), hits.end(), [](const std::pair<std::uint32_t, double>& a, const std::pair<std::uint32_t, double>& b) {
+			return a.second < b.second;
+		});
+	}
+
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::setThreadCount(std::uint32_t thread_count, bool pin_threads) {
 		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
-		// Add object
-		objects.push_back(indices);
-		// Add springs
-		std::uint32_t i, j;
-		for (i = 0; i < indices.size(); i++) {
-			for (j = i + 1; j < indices.size(); j++) {
-				spring.p1_index = indices.at(i);
-				spring.p2_index = indices.at(j);
+		thread_pool.reset(new ThreadPool(thread_count, pin_threads));
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	std::uint32_t Simulator<_Size, _Scalar, _Integrator>::getThreadCount(void) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with physics loop
+		return thread_pool->threadCount();
+	}
+
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::start(void) {
+		if (running.exchange(true)) {
+			std::cerr << "WARNING: Simulator::start() called while the physics thread is already running." << std::endl;
+			return;
+		}
+
+		achieved_cycle_rate = 0.;
+		physics_thread = std::thread(&Simulator<_Size, _Scalar, _Integrator>::physicsLoop, this);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::stop(void) {
+		running = false;  // Signal the physics thread to exit after its current cycle
+
+		if (physics_thread.joinable())
+			physics_thread.join();
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::setCycleRate(double cycles_per_second) {
+		if (cycles_per_second > 0.)
+			target_cycle_rate = cycles_per_second;
+		else
+			std::cerr << "WARNING: Ignoring non-positive physics cycle rate " << cycles_per_second << "." << std::endl;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::physicsLoop(void) {
+		typedef std::chrono::steady_clock::duration duration;
+
+		double cycles_per_second = target_cycle_rate;
+		duration cycle_period = std::chrono::duration_cast<duration>(std::chrono::duration<double>(1. / cycles_per_second));
+		duration accumulator = duration::zero();  // Real time that has elapsed but has not been simulated yet
+
+		time_point previous_time = std::chrono::steady_clock::now();
+		time_point window_start = previous_time;  // Start of the current achieved-rate measurement window
+		std::uint64_t window_cycles = 0;  // Cycles run during the current measurement window
+		double window_step_time = 0., window_step_time_squared = 0.;  // Sums of cycle wall-clock times (and their squares) during the current measurement window
+
+		while (running) {
+			// Pick up changes to the target cycle rate
+			if (target_cycle_rate != cycles_per_second) {
+				cycles_per_second = target_cycle_rate;
+				cycle_period = std::chrono::duration_cast<duration>(std::chrono::duration<double>(1. / cycles_per_second));
+			}
+
+			// Accumulate elapsed real time. Whatever is left over after running whole cycles
+			//	carries into the next iteration, so the simulation clock never drifts from the real one.
+			time_point now = std::chrono::steady_clock::now();
+			accumulator += now - previous_time;
+			previous_time = now;
+
+			// If the physics loop has fallen too far behind, drop the backlog instead of spiralling
+			if (accumulator > cycle_period * MAX_CATCHUP_CYCLES) {
+				dropped_cycle_count += accumulator / cycle_period - MAX_CATCHUP_CYCLES;
+				accumulator = cycle_period * MAX_CATCHUP_CYCLES;
+			}
 
-				springs.push_back(spring);
+			// Run every cycle that is due
+			while (accumulator >= cycle_period && running) {
+				time_point step_start = std::chrono::steady_clock::now();
+				updateState(1. / cycles_per_second);
+				double step_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - step_start).count();
+
+				window_step_time += step_time;
+				window_step_time_squared += step_time * step_time;
+				accumulator -= cycle_period;
+				cycle_count++;
+				window_cycles++;
 			}
+
+			// Update the achieved cycle rate about once a second
+			std::chrono::duration<double> window_length = now - window_start;
+			if (window_length.count() >= 1.) {
+				achieved_cycle_rate = window_cycles / window_length.count();
+				if (window_cycles > 0) {
+					double mean = window_step_time / window_cycles;
+					step_time_mean = mean;
+					step_time_jitter = std::sqrt(std::max(window_step_time_squared / window_cycles - mean * mean, 0.));
+				}
+				window_start = now;
+				window_cycles = 0;
+				window_step_time = 0.;
+				window_step_time_squared = 0.;
+			}
+
+			// Sleep until the next cycle is due
+			std::this_thread::sleep_until(now + (cycle_period - accumulator));
 		}
 	}
 
 
-	template <std::uint8_t _Size>
-	void Simulator<_Size>::start(void) {
-		std::cerr << "ERROR: Simulator::start() not implemented." << std::endl;
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	bool Simulator<_Size, _Scalar, _Integrator>::updateOutput(void) {
+		// Take the latest list published by the physics loop, if it published one since the last call
+		return output.update();
 	}
 
-	template <std::uint8_t _Size>
-	void Simulator<_Size>::stop(void) {
-		std::cerr << "ERROR: Simulator::stop() not implemented." << std::endl;
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	const std::vector<OutputParticle<_Size, _Scalar> >& Simulator<_Size, _Scalar, _Integrator>::getOutput(void) {
+		// Return a reference to the list owned by the reader.
+		return output.readBuffer();
 	}
 
 
-	template <std::uint8_t _Size>
-	bool Simulator<_Size>::updateOutput(void) {
-		std::lock_guard<std::mutex> output_lock(output_mutex);  // Coordinate timing with physics loop
-		if (output_is_ready) {
-			output_is_ready = false;  // Set to false until next time "write_output" and "latest_output" are swapped by the physics loop.
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::writeOutput(void) {
+		std::vector<OutputParticle<_Size, _Scalar> >& out = output.writeBuffer();
+		std::size_t previous_capacity = out.capacity();
 
-			// Swap "read_output" and "latest_output" pointers
-			std::vector<OutputParticle<_Size> >* swap_ptr = latest_output;
-			latest_output = read_output;
-			read_output = swap_ptr;
+		// Reuse the list's storage from earlier cycles; it is only reallocated when the particle count outgrows it
+		out.resize(particles.size());
+		if (out.capacity() != previous_capacity)
+			output_allocation_count++;
+
+		// Convert in place
+		thread_pool->parallelFor(0, (std::uint32_t)out.size(), PARTICLE_CHUNK, [this, &out](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++)
+				out[i].pos = particles.pos[particle_slot[i]];  // Output is in the order particles were added
+		});
+	}
 
-			return true;  // Indicate that there is new data available.
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::applySprings(void) {
+		// Recolor after the spring topology changes
+		if (springs_changed) {
+			spring_colors.build(springs, particles.size());
+			springs_changed = false;
 		}
-		
-		return false;  // Indicate that nothing happened.
+
+		// No two springs of one color share a particle, so each color can be split across threads without
+		//	racing on the particles' force accumulators. Colors run one after another.
+		for (std::uint32_t c = 0; c < spring_colors.colorCount(); c++)
+			thread_pool->parallelFor(spring_colors.begin(c), spring_colors.end(c), SPRING_CHUNK, [this](std::uint32_t begin, std::uint32_t end) {
+				for (std::uint32_t i = begin; i < end; i++)
+					springs[i].update(particles);
+			});
 	}
 
-	template <std::uint8_t _Size>
-	const std::vector<OutputParticle<_Size> >& Simulator<_Size>::getOutput(void) {
-		std::lock_guard<std::mutex> output_lock(output_mutex);  // Coordinate timing with physics loop
-		// Return a reference to the read-protected output list.
-		return *read_output;
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::applyCommands(void) {
+		if (commands.take(applying))
+			applyBatch();
 	}
 
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::applyBatch(void) {
+		const auto wake = [this](std::uint32_t particle) { setParticleAsleep(particle, false); };
 
-	template <std::uint8_t _Size>
-	void Simulator<_Size>::updateState(double seconds_per_cycle) {
-		// Do physics stuff
-		std::uint16_t i, j
-		// Run calculations for particle connections
-		for (const Spring<_Size>& s : this.springs) {
-			s.update(this.particles);
+		for (const Particle<_Size, _Scalar>& p : applying.particles) {
+			particle_index.push_back((std::uint32_t)particle_slot.size());
+			particle_slot.push_back(particles.size());
+			particles.push_back(p);
+			islands.add(p.invMass > 0);
 		}
-		// Resolve object collisions
-		for (i = 0; i < this.objects.size(); i++) {
-			for (j = i + 1; j < this.objects.size(); i++) {
-				resolveObjectCollision(this.particles, this.objects[i], this.objects[2]);
-			}
+
+		for (Spring<_Size, _Scalar>& spring : applying.springs) {
+			islands.connect(spring.p1_index, spring.p2_index, wake);
+			spring.p1_index = particle_slot[spring.p1_index];
+			spring.p2_index = particle_slot[spring.p2_index];
 		}
-		// Update the position and velocity of all particles
-		for (Particle<_Size>& p : this.particles) {
-			p.update(seconds_per_cycle);
+		springs.insert(springs.end(), std::make_move_iterator(applying.springs.begin()), std::make_move_iterator(applying.springs.end()));
+
+		for (std::vector<std::uint32_t>& indices : applying.objects) {
+			// Join the dynamic members into one island, awake
+			std::uint32_t island = NO_ISLAND;
+			for (std::uint32_t index : indices)
+				if (particles.invMass[particle_slot[index]] > 0) {
+					if (island == NO_ISLAND)
+						islands.wake(island = index, wake);
+					else
+						islands.connect(island, index, wake);
+				}
+			object_island.push_back(island);
+			object_asleep.push_back(false);
+
+			for (std::uint32_t& index : indices)
+				index = particle_slot[index];
+			objects.push_back(indices, particles.pos);
 		}
 
-		// Update output pointers
-		{
-			std::lock_guard<std::mutex> output_lock(output_mutex);  // Coordinate timing with updateOutput() and getOutput()
+		if (!applying.springs.empty())
+			springs_changed = true;
+		if (!applying.particles.empty() || !applying.springs.empty())
+			integrator.reset();
+		applying.clear();
+	}
 
-			// Swap "write_output" and "latest_output"
-			std::vector<OutputParticle<_Size> >* swap_ptr = latest_output;
-			latest_output = write_output;
-			write_output = swap_ptr;
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::partitionParticles(void) {
+		if (particles.isPartitioned())
+			return;
 
-			output_is_ready = true;  // Set to true until next time "read_output" and "latest_output" are swapped by updateOutput()
+		particles.partition(new_slot);
+		integrator.reset();
+
+		for (std::uint32_t index = 0; index < particle_slot.size(); index++) {
+			particle_slot[index] = new_slot[particle_slot[index]];
+			particle_index[particle_slot[index]] = index;
 		}
+		for (std::vector<Spring<_Size, _Scalar> >* spring_set : { &springs, &sleeping_springs })
+			for (Spring<_Size, _Scalar>& spring : *spring_set) {  // Remapping keeps every color free of shared particles
+				spring.p1_index = new_slot[spring.p1_index];
+				spring.p2_index = new_slot[spring.p2_index];
+			}
+		objects.remap(new_slot);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::resolveCollisions(void) {
+		// Broad phase: bound every object
+		thread_pool->parallelFor(0, objects.size(), OBJECT_CHUNK, [this](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t object = begin; object < end; object++)
+				if (!object_asleep[object])  // A sleeping object has not moved
+					objects.updateBounds(particles.pos, object, object + 1);
+		});
+		const std::vector<AABB<_Size> >& object_bounds = objects.bounds();
+
+		// Broad phase: find overlapping bounding boxes
+		const std::vector<BoxPair>* pairs = &object_pairs;
+		switch (broad_phase) {
+		case BroadPhase::UNIFORM_GRID:
+			pairs = &object_grid.findPairs(object_bounds);
+			break;
+		case BroadPhase::SWEEP_AND_PRUNE:
+			pairs = &object_sweep.findPairs(object_bounds);
+			break;
+		case BroadPhase::AABB_TREE:
+			pairs = &object_tree.findPairs(object_bounds);
+			break;
+		default:
+			object_pairs.clear();
+			for (std::uint32_t i = 0; i < objects.size(); i++)
+				for (std::uint32_t j = i + 1; j < objects.size(); j++)
+					if (object_bounds[i].overlaps(object_bounds[j]))
+						object_pairs.push_back(BoxPair(i, j));
+		}
+
+		// Narrow phase
+		const bool sleeping = sleep_threshold > 0.;
+		for (const BoxPair& pair : *pairs)
+			if (!objects[pair.first].empty() && !objects[pair.second].empty() && (!sleeping || touchObjects(pair.first, pair.second)))
+				resolveObjectCollision(particles, objects[pair.first], objects[pair.second]);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	bool Simulator<_Size, _Scalar, _Integrator>::touchObjects(std::uint32_t a, std::uint32_t b) {
+		const std::uint32_t island_a = object_island[a], island_b = object_island[b];
+		const bool asleep_a = island_a != NO_ISLAND && islands.isAsleep(island_a);
+		const bool asleep_b = island_b != NO_ISLAND && islands.isAsleep(island_b);
+
+		if (asleep_a || asleep_b) {
+			// Sleeping against sleeping or static stays asleep; an awake object wakes the one it overlaps
+			if ((asleep_a || island_a == NO_ISLAND) && (asleep_b || island_b == NO_ISLAND))
+				return false;
+			islands.wake(asleep_a ? island_a : island_b, [this](std::uint32_t particle) { setParticleAsleep(particle, false); });
+		}
+
+		if (island_a != NO_ISLAND && island_b != NO_ISLAND)
+			islands.touch(island_a, island_b);
+		return true;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::setParticleAsleep(std::uint32_t index, bool sleep) {
+		const std::uint32_t slot = particle_slot[index];
+		if (!(particles.invMass[slot] > 0) || particles.isAsleep(slot) == sleep)
+			return;
+
+		particles.setAsleep(slot, sleep);
+		particles.vel[slot].setZero();
+		particles.F[slot].setZero();
+		sleeping_particle_count += sleep ? 1 : -1;
+		sleep_changed = true;
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::updateSleeping(void) {
+		if (!sleep_changed)
+			return;
+		sleep_changed = false;
+
+		// Bring back the springs of woken particles, then set aside those of sleeping ones
+		const auto asleep = [this](const Spring<_Size, _Scalar>& spring) {
+			return particles.isAsleep(spring.p1_index) || particles.isAsleep(spring.p2_index);
+		};
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < sleeping_springs.size(); i++)
+			if (!asleep(sleeping_springs[i]))
+				springs.push_back(std::move(sleeping_springs[i]));
+			else if (kept++ != i)
+				sleeping_springs[kept - 1] = std::move(sleeping_springs[i]);
+		sleeping_springs.erase(sleeping_springs.begin() + kept, sleeping_springs.end());
+
+		kept = 0;
+		for (std::size_t i = 0; i < springs.size(); i++)
+			if (asleep(springs[i]))
+				sleeping_springs.push_back(std::move(springs[i]));
+			else if (kept++ != i)
+				springs[kept - 1] = std::move(springs[i]);
+		springs.erase(springs.begin() + kept, springs.end());
+
+		springs_changed = true;
+		integrator.reset();
+
+		for (std::uint32_t object = 0; object < objects.size(); object++)
+			object_asleep[object] = object_island[object] != NO_ISLAND && islands.isAsleep(object_island[object]);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::sleepIslands(void) {
+		const std::uint32_t count = integratedCount(particles);
+		for (std::uint32_t i = 0; i < count; i++)
+			if (particles.invMass[i] > 0 && !particles.isAsleep(i))
+				islands.measure(particle_index[i], (double)particles.mass[i], (double)magnitudeSquared(particles.vel[i]));
+
+		islands.sleep(sleep_threshold, sleep_cycles, [this](std::uint32_t particle) { setParticleAsleep(particle, true); });
+	}
+
+
+	template <std::uint8_t _Size, typename _Scalar, template <std::uint8_t, typename> class _Integrator>
+	void Simulator<_Size, _Scalar, _Integrator>::updateState(double seconds_per_cycle) {
+		std::lock_guard<std::mutex> physics_lock(physics_mutex);  // Coordinate timing with Particle, Spring, and object insertion
+
+		// Take in queued edits
+		applyCommands();
+		updateSleeping();
+
+		// Do physics stuff
+		// Resolve object collisions, waking the sleeping objects awake ones hit
+		resolveCollisions();
+		updateSleeping();
+		// Keep static and sleeping particles out of the integration range
+		partitionParticles();
+		// Update the position and velocity of all particles, running calculations for particle connections whenever the integrator needs forces
+		integrator.step(particles, seconds_per_cycle, springForces(springs, [this]() { applySprings(); }), thread_pool.get());
+		// Put the islands that stayed quiet to sleep
+		if (sleep_threshold > 0.)
+			sleepIslands();
+
+		// Snapshot and publish the output list
+		writeOutput();
+		output.publish();
 	}
 }
 
@@ -0,0 +1,69 @@
+// spring.h
+// Written by Weston Cook
+// Defines the struct Spring
+
+#ifndef BRAZEN_SPRING_H
+#define BRAZEN_SPRING_H
+
+#include "tuple.h"
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Struct Spring - a damped linear spring between two particles, referred to by index.
+
+	Pulls the particles together when stretched past "rest_length" and pushes them apart when compressed, with the
+	force (stiffness * (length - rest_length) + damping * relative speed) along the axis between them. That is the
+	force "ImplicitEuler" linearizes, so every integrator sees the same springs.
+
+	A Spring handed to "Simulator::createObject()" or "queueObject()" is a template: its indices are replaced by
+	those of every pair the topology connects.
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	struct Spring {
+		// ATTRIBUTES
+		std::uint32_t p1_index, p2_index;  // Particles at either end
+		_Scalar stiffness, rest_length, damping;
+
+		// CONSTRUCTORS
+		Spring(std::uint32_t p1_index, std::uint32_t p2_index, _Scalar stiffness, _Scalar rest_length, _Scalar damping = 0) :
+			p1_index(p1_index), p2_index(p2_index),
+			stiffness(stiffness), rest_length(rest_length), damping(damping)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Return the spring's force on the particle at "p1_index"; the other particle gets its negative. "particles"
+		//	is anything indexed by particle index that gives "pos" and "vel," like a ParticleStore. Coincident
+		//	particles have no axis to push along and get no force.
+		template <typename ParticleList>
+		Tuple<_Size, _Scalar> force(ParticleList& particles) const;
+		// Add the spring's force to the forces ("F") of both particles.
+		template <typename ParticleList>
+		void update(ParticleList& particles) const;
+	};
+
+
+	template <std::uint8_t _Size, typename _Scalar>
+	template <typename ParticleList>
+	Tuple<_Size, _Scalar> Spring<_Size, _Scalar>::force(ParticleList& particles) const {
+		const Tuple<_Size, _Scalar> d = particles[p2_index].pos - particles[p1_index].pos;
+		const _Scalar length = magnitude(d);
+		if (!(length > 0))
+			return Tuple<_Size, _Scalar>(true);
+
+		const Tuple<_Size, _Scalar> u = d / length;
+		const Tuple<_Size, _Scalar> relative_vel = particles[p2_index].vel - particles[p1_index].vel;
+		return u * (stiffness * (length - rest_length) + damping * dot(relative_vel, u));
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	template <typename ParticleList>
+	void Spring<_Size, _Scalar>::update(ParticleList& particles) const {
+		const Tuple<_Size, _Scalar> f = force(particles);
+
+		particles[p1_index].F += f;
+		particles[p2_index].F -= f;
+	}
+}
+
+#endif
@@ -0,0 +1,106 @@
+// spring_coloring.h
+// Written by Weston Cook
+// Defines the class SpringColoring
+
+#ifndef BRAZEN_SPRING_COLORING_H
+#define BRAZEN_SPRING_COLORING_H
+
+#include <vector>  // std::vector
+#include <cstdint>  // std::uint32_t
+
+namespace Brazen {
+	/*
+	Class SpringColoring - partitions springs into "colors" such that no two springs of the same color share a particle.
+
+	All springs of one color can be applied at the same time without two of them accumulating force on the
+	same particle, so each color is a batch that can be split across threads without atomics or locks.
+
+	"build()" greedily colors the spring graph and reorders the springs so every color is one contiguous range.
+	It works with any spring type that has "p1_index" and "p2_index" members.
+	*/
+	class SpringColoring {
+	private:
+		// ATTRIBUTES
+		std::vector<std::uint32_t> color_offsets;  // Springs of color c are [color_offsets[c], color_offsets[c + 1])
+	public:
+		// MEMBER FUNCTIONS
+		// Color the springs and reorder them so every color is contiguous. Springs keep their relative order within a color.
+		template <typename SpringType>
+		void build(std::vector<SpringType>& springs, std::uint32_t particle_count);
+
+		// Return the number of colors.
+		std::uint32_t colorCount(void) const { return color_offsets.empty() ? 0 : (std::uint32_t)color_offsets.size() - 1; }
+		// Return the index of the first spring of the given color.
+		std::uint32_t begin(std::uint32_t color) const { return color_offsets[color]; }
+		// Return one past the index of the last spring of the given color.
+		std::uint32_t end(std::uint32_t color) const { return color_offsets[color + 1]; }
+	};
+
+
+	template <typename SpringType>
+	void SpringColoring::build(std::vector<SpringType>& springs, std::uint32_t particle_count) {
+		const std::uint32_t NO_COLOR = 0xFFFFFFFF;
+		const std::uint32_t spring_count = (std::uint32_t)springs.size();
+
+		// Index the springs attached to every particle (compressed rows)
+		std::vector<std::uint32_t> attached_offsets(particle_count + 1, 0), attached(2 * spring_count);
+		for (const SpringType& s : springs) {
+			attached_offsets[s.p1_index + 1]++;
+			attached_offsets[s.p2_index + 1]++;
+		}
+		for (std::uint32_t p = 0; p < particle_count; p++)
+			attached_offsets[p + 1] += attached_offsets[p];
+		{
+			std::vector<std::uint32_t> fill(attached_offsets.begin(), attached_offsets.end() - 1);
+			for (std::uint32_t s = 0; s < spring_count; s++) {
+				attached[fill[springs[s].p1_index]++] = s;
+				attached[fill[springs[s].p2_index]++] = s;
+			}
+		}
+
+		// Greedy coloring: give every spring the lowest color not used by a spring sharing one of its particles
+		std::vector<std::uint32_t> color(spring_count, NO_COLOR);
+		std::vector<std::uint32_t> forbidden;  // forbidden[c] == s while coloring spring s means color c is taken
+		std::uint32_t color_count = 0;
+
+		for (std::uint32_t s = 0; s < spring_count; s++) {
+			const std::uint32_t ends[2] = { springs[s].p1_index, springs[s].p2_index };
+			for (std::uint32_t p : ends)
+				for (std::uint32_t k = attached_offsets[p]; k < attached_offsets[p + 1]; k++) {
+					std::uint32_t neighbor_color = color[attached[k]];
+					if (neighbor_color != NO_COLOR)
+						forbidden[neighbor_color] = s;
+				}
+
+			std::uint32_t c = 0;
+			while (c < color_count && forbidden[c] == s)
+				c++;
+			if (c == color_count) {
+				color_count++;
+				forbidden.push_back(NO_COLOR);
+			}
+			color[s] = c;
+		}
+
+		// Stable counting sort of the springs by color
+		color_offsets.assign(color_count + 1, 0);
+		for (std::uint32_t s = 0; s < spring_count; s++)
+			color_offsets[color[s] + 1]++;
+		for (std::uint32_t c = 0; c < color_count; c++)
+			color_offsets[c + 1] += color_offsets[c];
+
+		std::vector<std::uint32_t> fill(color_offsets.begin(), color_offsets.end() - 1);
+		std::vector<std::uint32_t> order(spring_count);
+		for (std::uint32_t s = 0; s < spring_count; s++)
+			order[fill[color[s]]++] = s;
+
+		std::vector<SpringType> sorted;
+		sorted.reserve(spring_count);
+		for (std::uint32_t s : order)
+			sorted.push_back(springs[s]);
+
+		springs.swap(sorted);
+	}
+}
+
+#endif
@@ -0,0 +1,193 @@
+// sweep_and_prune.h
+// Written by Weston Cook
+// Defines the class SweepAndPrune
+
+#ifndef BRAZEN_SWEEP_AND_PRUNE_H
+#define BRAZEN_SWEEP_AND_PRUNE_H
+
+#include "aabb.h"
+#include <vector>  // std::vector
+#include <algorithm>  // std::sort, std::unique
+#include <cmath>  // std::isfinite
+#include <cstdint>  // std::uint8_t, std::uint32_t
+
+namespace Brazen {
+	/*
+	Class SweepAndPrune - broad phase that finds overlapping boxes by sorting their endpoints along one axis.
+
+	The min and max endpoint of every box along the sweep axis are kept in one sorted list. Sweeping the
+	list in order, a box is tested (on the remaining axes) only against the boxes whose intervals are open
+	when its min endpoint is reached. The list persists between calls and is re-sorted with insertion sort,
+	which is close to O(n) when boxes move little between calls.
+
+	The sweep axis is the one along which box centers vary most, so the fewest intervals overlap on it.
+	Changing axes (or the number of boxes) rebuilds the list from scratch, so the axis only changes once
+	another axis is clearly wider.
+
+	A box with a NaN or infinite bound, or a min above its max, has no consistent place in the sorted list.
+	Like the oversized boxes of "UniformGrid," such boxes are kept out of it and tested against every box.
+	*/
+	template <std::uint8_t _Size>
+	class SweepAndPrune {
+	private:
+		/*
+		Struct Endpoint - one end of a box's interval along the sweep axis.
+		*/
+		struct Endpoint {
+			double value;
+			std::uint32_t box;
+			bool is_max;
+
+			// Min endpoints sort before max endpoints at the same value, so touching boxes overlap
+			bool operator<(const Endpoint& e) const {
+				return value < e.value || (value == e.value && !is_max && e.is_max);
+			}
+		};
+
+		// ATTRIBUTES
+		std::uint8_t axis;  // Sweep axis
+		std::vector<Endpoint> endpoints;  // Endpoints of every box along "axis," sorted
+		std::vector<std::uint32_t> active;  // Boxes whose interval is open during the sweep
+		std::vector<std::uint32_t> active_slot;  // Position of every box in "active"
+		std::vector<std::uint32_t> unsorted, next_unsorted;  // Boxes kept out of "endpoints" on the last and the current call
+		std::vector<BoxPair> pairs;  // Output of the last call to "findPairs()"
+
+		static constexpr double AXIS_SWITCH_RATIO = 1.25;  // How much more variance another axis needs before the sweep switches to it
+
+		// Return whether the box has finite bounds with min <= max on every axis, so its endpoints can be sorted.
+		static bool sortable(const AABB<_Size>& box);
+		// Return the axis along which the centers of the sortable boxes vary most, preferring "current" unless another is clearly wider.
+		static std::uint8_t widestAxis(const std::vector<AABB<_Size> >& boxes, std::uint8_t current);
+	public:
+		// CONSTRUCTORS
+		SweepAndPrune(void) :
+			axis(0)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Return every pair of overlapping boxes, each once, sorted. The reference stays valid until the next call.
+		//	Boxes are identified by index, so index i should refer to the same box on every call.
+		const std::vector<BoxPair>& findPairs(const std::vector<AABB<_Size> >& boxes);
+		// Return the axis the last call swept along.
+		std::uint8_t sweepAxis(void) const { return axis; }
+	};
+
+
+	template <std::uint8_t _Size>
+	bool SweepAndPrune<_Size>::sortable(const AABB<_Size>& box) {
+		for (std::uint8_t i = 0; i < _Size; i++)
+			if (!(box.min[i] <= box.max[i]) || !std::isfinite(box.min[i]) || !std::isfinite(box.max[i]))
+				return false;
+		return true;
+	}
+
+	template <std::uint8_t _Size>
+	std::uint8_t SweepAndPrune<_Size>::widestAxis(const std::vector<AABB<_Size> >& boxes, std::uint8_t current) {
+		Tuple<_Size> sum(true), sum_squared(true);
+		double count = 0.;
+
+		for (const AABB<_Size>& box : boxes) {
+			if (!sortable(box))
+				continue;
+			count++;
+
+			Tuple<_Size> center = box.center();
+			for (std::uint8_t i = 0; i < _Size; i++) {
+				sum[i] += center[i];
+				sum_squared[i] += center[i] * center[i];
+			}
+		}
+
+		// The variance is proportional to n * sum_squared - sum^2
+		std::uint8_t widest = 0;
+		double widest_variance = -1.;
+		for (std::uint8_t i = 0; i < _Size; i++) {
+			double variance = count * sum_squared[i] - sum[i] * sum[i];
+			if (variance > widest_variance) {
+				widest = i;
+				widest_variance = variance;
+			}
+		}
+
+		double current_variance = count * sum_squared[current] - sum[current] * sum[current];
+		return widest_variance > AXIS_SWITCH_RATIO * current_variance ? widest : current;
+	}
+
+	template <std::uint8_t _Size>
+	const std::vector<BoxPair>& SweepAndPrune<_Size>::findPairs(const std::vector<AABB<_Size> >& boxes) {
+		pairs.clear();
+
+		// Find the boxes that cannot be sorted; the endpoint list only stays valid while they are the same ones
+		next_unsorted.clear();
+		for (std::uint32_t b = 0; b < boxes.size(); b++)
+			if (!sortable(boxes[b]))
+				next_unsorted.push_back(b);
+		const bool unsorted_changed = next_unsorted != unsorted;
+		unsorted.swap(next_unsorted);
+
+		std::uint8_t widest = widestAxis(boxes, axis);
+		if (widest != axis || unsorted_changed || endpoints.size() != 2 * (boxes.size() - unsorted.size())) {
+			// Rebuild the endpoint list
+			axis = widest;
+			endpoints.clear();
+			for (std::uint32_t b = 0, u = 0; b < boxes.size(); b++) {
+				if (u < unsorted.size() && unsorted[u] == b) {
+					u++;
+					continue;
+				}
+				endpoints.push_back(Endpoint{ boxes[b].min[axis], b, false });
+				endpoints.push_back(Endpoint{ boxes[b].max[axis], b, true });
+			}
+			std::sort(endpoints.begin(), endpoints.end());
+			active_slot.resize(boxes.size());
+		}
+		else {
+			// Refresh the endpoint values and restore the order with insertion sort
+			for (Endpoint& e : endpoints)
+				e.value = e.is_max ? boxes[e.box].max[axis] : boxes[e.box].min[axis];
+
+			for (std::size_t i = 1; i < endpoints.size(); i++) {
+				Endpoint e = endpoints[i];
+				std::size_t j = i;
+				for (; j > 0 && e < endpoints[j - 1]; j--)
+					endpoints[j] = endpoints[j - 1];
+				endpoints[j] = e;
+			}
+		}
+
+		// Sweep
+		active.clear();
+		for (const Endpoint& e : endpoints) {
+			if (e.is_max) {
+				// Close the interval: swap-remove the box from "active"
+				std::uint32_t last = active.back();
+				active[active_slot[e.box]] = last;
+				active_slot[last] = active_slot[e.box];
+				active.pop_back();
+			}
+			else {
+				// Open the interval: the box overlaps every open interval along "axis"
+				for (std::uint32_t other : active)
+					if (boxes[e.box].overlaps(boxes[other]))
+						pairs.push_back(BoxPair(std::min(e.box, other), std::max(e.box, other)));
+
+				active_slot[e.box] = (std::uint32_t)active.size();
+				active.push_back(e.box);
+			}
+		}
+
+		// Test the unsorted boxes against every box
+		for (std::uint32_t a : unsorted)
+			for (std::uint32_t b = 0; b < boxes.size(); b++)
+				if (a != b && boxes[a].overlaps(boxes[b]))
+					pairs.push_back(BoxPair(std::min(a, b), std::max(a, b)));
+
+		// Two unsorted boxes produce their pair twice
+		std::sort(pairs.begin(), pairs.end());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+		return pairs;
+	}
+}
+
+#endif
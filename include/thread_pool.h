@@ -0,0 +1,238 @@
+// thread_pool.h
+// Written by Weston Cook
+// Defines the class ThreadPool
+
+#ifndef BRAZEN_THREAD_POOL_H
+#define BRAZEN_THREAD_POOL_H
+
+#include <vector>  // std::vector
+#include <deque>  // std::deque
+#include <memory>  // std::unique_ptr
+#include <thread>  // std::thread
+#include <mutex>  // std::mutex, std::lock_guard, std::unique_lock
+#include <condition_variable>  // std::condition_variable
+#include <atomic>  // std::atomic
+#include <utility>  // std::pair
+#include <algorithm>  // std::min
+#include <cstdint>  // std::uint32_t, std::uint64_t
+#if defined(__linux__)
+#include <pthread.h>  // pthread_setaffinity_np
+#include <sched.h>  // cpu_set_t
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX  // Keep windows.h from defining min/max macros
+#endif
+#include <windows.h>  // SetThreadAffinityMask
+#endif
+
+namespace Brazen {
+	/*
+	Class ThreadPool - persistent work-stealing worker threads for splitting loops across cores.
+
+	"parallelFor()" splits a loop into chunks and deals them out, a contiguous run per thread, into one
+	deque per thread. Every thread works through its own deque from the back and, once it runs dry, steals
+	from the front of the others, so uneven chunks even out without a shared queue everyone contends on.
+	The calling thread works on the loop too, and "parallelFor()" returns only once every chunk has run,
+	so consecutive calls act as phases separated by barriers.
+
+	The workers are created once and sleep between loops, so a loop costs a wake-up rather than a thread spawn.
+	*/
+	class ThreadPool {
+	private:
+		typedef std::pair<std::uint32_t, std::uint32_t> Chunk;  // Iterations [first, second)
+
+		/*
+		Struct TaskQueue - the chunks dealt to one thread. Thread 0 is the thread calling "parallelFor()."
+		*/
+		struct TaskQueue {
+			std::mutex mutex;
+			std::deque<Chunk> chunks;
+		};
+
+		// ATTRIBUTES
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<TaskQueue> > queues;  // One per thread, including the calling thread
+
+		// Current loop body, stored as a function pointer and context so posting a loop never allocates
+		void (*invoke)(void* context, std::uint32_t begin, std::uint32_t end);
+		void* context;
+		std::atomic<std::uint32_t> remaining_chunks;  // Chunks of the current loop that have not finished running
+
+		std::mutex mutex;  // Protects "generation" and "stopping"
+		std::condition_variable job_ready;  // Signalled when a loop is posted or the pool is stopping
+		std::condition_variable job_done;  // Signalled when the last chunk of a loop finishes
+		std::uint64_t generation;  // Incremented for every loop, so workers can tell a new loop from the last one
+		bool stopping;
+
+		// Take a chunk for thread "self": from the back of its own queue, else from the front of another's.
+		bool takeChunk(std::uint32_t self, Chunk& chunk);
+		// Run chunks as thread "self" until there are none left to take.
+		void work(std::uint32_t self);
+		// Body of worker thread "self."
+		void workerLoop(std::uint32_t self);
+		// Pin the given thread to the given core. Does nothing on platforms without thread affinity.
+		static void pin(std::thread& thread, std::uint32_t core);
+
+		template <typename Function>
+		static void invokeFunction(void* function, std::uint32_t begin, std::uint32_t end) {
+			(*static_cast<Function*>(function))(begin, end);
+		}
+	public:
+		// CONSTRUCTORS
+		// "thread_count" includes the calling thread. With "pin_threads," worker t is pinned to core t (the calling thread is left alone).
+		ThreadPool(std::uint32_t thread_count = std::thread::hardware_concurrency(), bool pin_threads = false);
+		~ThreadPool(void);
+
+		// MEMBER FUNCTIONS
+		// Return the number of threads working on a loop, including the calling thread.
+		std::uint32_t threadCount(void) const { return (std::uint32_t)queues.size(); }
+
+		// Call "function(chunk_begin, chunk_end)" over [begin, end) in chunks of at most "chunk" iterations, in parallel.
+		//	Returns once every chunk has run. Must only be called from one thread at a time, and not from inside a loop body.
+		template <typename Function>
+		void parallelFor(std::uint32_t begin, std::uint32_t end, std::uint32_t chunk, Function function);
+	};
+
+
+	inline ThreadPool::ThreadPool(std::uint32_t thread_count, bool pin_threads) :
+		invoke(nullptr), context(nullptr), remaining_chunks(0), generation(0), stopping(false)
+	{
+		if (thread_count == 0)
+			thread_count = 1;
+
+		for (std::uint32_t t = 0; t < thread_count; t++)
+			queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue));
+
+		for (std::uint32_t t = 1; t < thread_count; t++) {
+			workers.push_back(std::thread(&ThreadPool::workerLoop, this, t));
+			if (pin_threads)
+				pin(workers.back(), t);
+		}
+	}
+
+	inline ThreadPool::~ThreadPool(void) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		job_ready.notify_all();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	inline void ThreadPool::pin(std::thread& thread, std::uint32_t core) {
+#if defined(__linux__)
+		cpu_set_t cores;
+		CPU_ZERO(&cores);
+		CPU_SET(core % CPU_SETSIZE, &cores);
+		pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cores);
+#elif defined(_WIN32)
+		SetThreadAffinityMask(thread.native_handle(), (DWORD_PTR)1 << (core % (8 * sizeof(DWORD_PTR))));
+#else
+		(void)thread;
+		(void)core;
+#endif
+	}
+
+	inline bool ThreadPool::takeChunk(std::uint32_t self, Chunk& chunk) {
+		{
+			TaskQueue& own = *queues[self];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.chunks.empty()) {
+				chunk = own.chunks.back();
+				own.chunks.pop_back();
+				return true;
+			}
+		}
+
+		// Steal, starting with the next thread so thieves spread out over their victims
+		for (std::uint32_t k = 1; k < queues.size(); k++) {
+			TaskQueue& victim = *queues[(self + k) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.chunks.empty()) {
+				chunk = victim.chunks.front();
+				victim.chunks.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	inline void ThreadPool::work(std::uint32_t self) {
+		Chunk chunk;
+
+		while (takeChunk(self, chunk)) {
+			invoke(context, chunk.first, chunk.second);
+
+			if (remaining_chunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				// Last chunk of the loop: wake the calling thread
+				std::lock_guard<std::mutex> lock(mutex);
+				job_done.notify_all();
+			}
+		}
+	}
+
+	inline void ThreadPool::workerLoop(std::uint32_t self) {
+		std::uint64_t seen_generation = 0;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				job_ready.wait(lock, [this, seen_generation]() { return stopping || generation != seen_generation; });
+				if (stopping)
+					return;
+				seen_generation = generation;
+			}
+
+			work(self);
+		}
+	}
+
+	template <typename Function>
+	void ThreadPool::parallelFor(std::uint32_t begin, std::uint32_t end, std::uint32_t chunk, Function function) {
+		if (chunk == 0)
+			chunk = 1;
+		if (begin >= end)
+			return;
+		if (workers.empty() || end - begin <= chunk) {
+			// Not worth waking anyone
+			function(begin, end);
+			return;
+		}
+
+		invoke = &invokeFunction<Function>;
+		context = &function;
+
+		// Deal the chunks out, a contiguous run per thread. Chunk bounds are worked out in 64 bits, since near
+		//	the top of the range they can pass 2^32 before being clamped to "end."
+		std::uint32_t chunk_count = (std::uint32_t)(((std::uint64_t)end - begin + chunk - 1) / chunk);
+		std::uint32_t thread_count = threadCount();
+		remaining_chunks = chunk_count;
+		for (std::uint32_t t = 0; t < thread_count; t++) {
+			std::uint32_t first = (std::uint32_t)((std::uint64_t)chunk_count * t / thread_count);
+			std::uint32_t last = (std::uint32_t)((std::uint64_t)chunk_count * (t + 1) / thread_count);
+			std::lock_guard<std::mutex> lock(queues[t]->mutex);
+			for (std::uint32_t c = first; c < last; c++) {
+				std::uint64_t chunk_begin = begin + (std::uint64_t)c * chunk;
+				std::uint64_t chunk_end = std::min(chunk_begin + chunk, (std::uint64_t)end);
+				queues[t]->chunks.push_back(Chunk((std::uint32_t)chunk_begin, (std::uint32_t)chunk_end));
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			generation++;
+		}
+		job_ready.notify_all();
+
+		work(0);
+
+		// Barrier: wait for chunks still running on other threads
+		std::unique_lock<std::mutex> lock(mutex);
+		job_done.wait(lock, [this]() { return remaining_chunks.load(std::memory_order_acquire) == 0; });
+	}
+}
+
+#endif
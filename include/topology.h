@@ -0,0 +1,256 @@
+// topology.h
+// Written by Weston Cook
+// Defines builders for sparse spring topologies: lattices, k nearest neighbors and distance thresholds
+
+#ifndef BRAZEN_TOPOLOGY_H
+#define BRAZEN_TOPOLOGY_H
+
+#include "tuple.h"
+#include "hypercube.h"
+#include <vector>  // std::vector
+#include <array>  // std::array
+#include <algorithm>  // std::sort, std::unique, std::push_heap, std::pop_heap
+#include <utility>  // std::pair
+#include <stdexcept>  // std::length_error
+#include <string>  // std::to_string
+#include <limits>  // std::numeric_limits
+#include <cstdint>  // std::uint8_t, std::uint32_t, std::uint64_t
+
+namespace Brazen {
+	/*
+	Spring topologies - which pairs of an object's particles get a spring.
+
+	Connecting every pair (what "Simulator::createObject(indices, spring)" does) makes n (n - 1) / 2 springs, so a
+	1000 particle body costs half a million springs per step, and each particle feels ~n springs, which raises the
+	fastest mode and so shrinks the stable time step. The builders here return O(n) edges that still hold a body's
+	shape:
+
+		latticeEdges()          a grid of points joined along its axes ("N-cube lattice," any _Size), and with
+		                        "triangulated," along every cell diagonal that splits the cells into simplices
+		                        (triangles in 2D, tetrahedra in 3D). Only the triangulated lattice is rigid.
+		kNearestEdges()         every particle joined to its k nearest neighbors. k >= 3 * _Size is usually rigid.
+		distanceEdges()         every pair closer than a distance.
+		fullyConnectedEdges()   every pair, for comparison.
+
+	Edges index the given positions (or lattice points), so they can be passed to
+	"Simulator::createObject(indices, edges, spring)" with the particle indices of those positions. Every builder
+	returns each edge once, with p1_index < p2_index, sorted. Edge lists are indexed with std::uint32_t, so a builder
+	that would return more edges than that holds throws a std::length_error.
+	*/
+
+	// An edge of a spring topology, as the indices of the two particles it joins.
+	typedef HypercubeEdge SpringEdge;
+
+
+	// Throw a std::length_error if "edge_count" edges cannot be indexed with std::uint32_t.
+	inline void checkEdgeCount(std::uint64_t edge_count, const char* builder) {
+		if (edge_count > std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error(std::string(builder) + " would make " + std::to_string(edge_count) + " edges, more than 32-bit indices can address.");
+	}
+
+
+	// Return the number of points in a lattice with the given number of points along every axis.
+	template <std::uint8_t _Size>
+	std::uint32_t latticePointCount(const std::array<std::uint32_t, _Size>& counts) {
+		std::uint32_t total = 1;
+		for (std::uint8_t i = 0; i < _Size; i++)
+			total *= counts[i];
+		return total;
+	}
+
+	// Return the points of a lattice with the given number of points along every axis, "spacing" apart, the first at
+	//	"origin." Axis 0 varies fastest.
+	template <std::uint8_t _Size, typename _Scalar = double>
+	std::vector<Tuple<_Size, _Scalar> > latticePoints(const std::array<std::uint32_t, _Size>& counts, _Scalar spacing, const Tuple<_Size, _Scalar>& origin = Tuple<_Size, _Scalar>()) {
+		std::vector<Tuple<_Size, _Scalar> > points(latticePointCount<_Size>(counts));
+
+		for (std::uint32_t p = 0; p < points.size(); p++) {
+			std::uint32_t rest = p;
+			Tuple<_Size, _Scalar> offset;
+			for (std::uint8_t i = 0; i < _Size; i++) {
+				offset[i] = spacing * _Scalar(rest % counts[i]);
+				rest /= counts[i];
+			}
+			points[p] = origin + offset;
+		}
+
+		return points;
+	}
+
+	/*
+	Return the edges of the lattice whose points "latticePoints()" returns.
+
+	Every point is joined to its neighbor one step along each axis. With "triangulated," it is also joined to every
+	neighbor whose offset is a combination of single steps along several axes (the far corners of the cells it is
+	the near corner of), which is the Freudenthal (Kuhn) triangulation of the lattice: each cell splits into _Size!
+	simplices. Offsets use the vertex numbering of "hypercubeVertices()", bit i for a step along axis i.
+	*/
+	template <std::uint8_t _Size>
+	std::vector<SpringEdge> latticeEdges(const std::array<std::uint32_t, _Size>& counts, bool triangulated) {
+		static_assert(_Size <= 16, "lattice offsets are limited to 16 dimensions");
+		std::vector<SpringEdge> edges;
+		std::array<std::uint32_t, _Size> stride;
+		std::uint32_t total = 1;
+		for (std::uint8_t i = 0; i < _Size; i++) {
+			stride[i] = total;
+			total *= counts[i];
+		}
+
+		for (std::uint32_t p = 0; p < total; p++)
+			for (std::uint32_t offset = 1; offset < hypercubeVertexCount<_Size>(); offset++) {
+				if (!triangulated && (offset & (offset - 1)))  // More than one axis
+					continue;
+
+				std::uint32_t neighbor = p;
+				bool inside = true;
+				for (std::uint8_t i = 0; i < _Size && inside; i++)
+					if (offset >> i & 1) {
+						inside = (p / stride[i]) % counts[i] + 1 < counts[i];
+						neighbor += stride[i];
+					}
+				if (inside)
+					edges.push_back(SpringEdge{ p, neighbor });
+			}
+
+		std::sort(edges.begin(), edges.end(), [](const SpringEdge& a, const SpringEdge& b) {
+			return a.p1_index < b.p1_index || (a.p1_index == b.p1_index && a.p2_index < b.p2_index);
+		});
+		return edges;
+	}
+
+
+	// Sort the given edges, with p1_index < p2_index in each, and remove duplicates.
+	inline void normalizeEdges(std::vector<SpringEdge>& edges) {
+		for (SpringEdge& edge : edges)
+			if (edge.p2_index < edge.p1_index)
+				std::swap(edge.p1_index, edge.p2_index);
+
+		std::sort(edges.begin(), edges.end(), [](const SpringEdge& a, const SpringEdge& b) {
+			return a.p1_index < b.p1_index || (a.p1_index == b.p1_index && a.p2_index < b.p2_index);
+		});
+		edges.erase(std::unique(edges.begin(), edges.end(), [](const SpringEdge& a, const SpringEdge& b) {
+			return a.p1_index == b.p1_index && a.p2_index == b.p2_index;
+		}), edges.end());
+	}
+
+	// Return the indices of the given positions sorted along the axis they vary most on, and that axis.
+	template <std::uint8_t _Size, typename _Scalar>
+	std::pair<std::vector<std::uint32_t>, std::uint8_t> sortAlongWidestAxis(const std::vector<Tuple<_Size, _Scalar> >& positions) {
+		std::vector<std::uint32_t> order(positions.size());
+		std::uint8_t axis = 0;
+		double widest = -1.;
+
+		for (std::uint8_t i = 0; i < _Size && !positions.empty(); i++) {
+			double low = positions[0][i], high = positions[0][i];
+			for (const Tuple<_Size, _Scalar>& p : positions) {
+				low = std::min(low, (double)p[i]);
+				high = std::max(high, (double)p[i]);
+			}
+			if (high - low > widest) {
+				widest = high - low;
+				axis = i;
+			}
+		}
+
+		for (std::uint32_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&positions, axis](std::uint32_t a, std::uint32_t b) {
+			return positions[a][axis] < positions[b][axis];
+		});
+		return std::make_pair(order, axis);
+	}
+
+	/*
+	Return edges joining every position to its k nearest others (so a particle may end up with more than k, when it is
+	among the nearest of particles that are not among its own). k is capped at the number of other positions.
+
+	Positions are sorted along their widest axis, and each one searches outward from its place in that order until the
+	distance along the axis alone exceeds its k-th nearest distance so far: about O(n log n) for bodies that are not
+	much thinner along that axis than across it.
+	*/
+	template <std::uint8_t _Size, typename _Scalar>
+	std::vector<SpringEdge> kNearestEdges(const std::vector<Tuple<_Size, _Scalar> >& positions, std::uint32_t k) {
+		std::vector<SpringEdge> edges;
+		if (positions.size() < 2 || k == 0)
+			return edges;
+
+		const std::pair<std::vector<std::uint32_t>, std::uint8_t> sorted = sortAlongWidestAxis(positions);
+		const std::vector<std::uint32_t>& order = sorted.first;
+		const std::uint8_t axis = sorted.second;
+		const std::uint32_t n = (std::uint32_t)positions.size();
+		k = std::min(k, n - 1);
+		std::vector<std::pair<double, std::uint32_t> > nearest;  // Max-heap of (squared distance, index) of the k nearest so far
+		checkEdgeCount((std::uint64_t)n * k, "kNearestEdges()");
+		edges.reserve((std::size_t)n * k);
+
+		for (std::uint32_t s = 0; s < n; s++) {
+			const Tuple<_Size, _Scalar>& p = positions[order[s]];
+			nearest.clear();
+
+			// Step outward on both sides, nearer side first along the axis
+			std::uint32_t below = s, above = s + 1;
+			while (below > 0 || above < n) {
+				const double gap_below = below > 0 ? (double)p[axis] - positions[order[below - 1]][axis] : -1.;
+				const double gap_above = above < n ? (double)positions[order[above]][axis] - p[axis] : -1.;
+				const bool take_below = gap_above < 0. || (gap_below >= 0. && gap_below <= gap_above);
+				const double gap = take_below ? gap_below : gap_above;
+				if (nearest.size() == k && gap * gap > nearest.front().first)
+					break;
+
+				const std::uint32_t other = take_below ? order[--below] : order[above++];
+				const double distance_squared = magnitudeSquared(positions[other] - p);
+				if (nearest.size() < k) {
+					nearest.push_back(std::make_pair(distance_squared, other));
+					std::push_heap(nearest.begin(), nearest.end());
+				}
+				else if (distance_squared < nearest.front().first) {
+					std::pop_heap(nearest.begin(), nearest.end());
+					nearest.back() = std::make_pair(distance_squared, other);
+					std::push_heap(nearest.begin(), nearest.end());
+				}
+			}
+
+			for (const std::pair<double, std::uint32_t>& neighbor : nearest)
+				edges.push_back(SpringEdge{ order[s], neighbor.second });
+		}
+
+		normalizeEdges(edges);
+		return edges;
+	}
+
+	// Return edges joining every pair of positions at most "max_distance" apart. Sweeps along the widest axis.
+	template <std::uint8_t _Size, typename _Scalar>
+	std::vector<SpringEdge> distanceEdges(const std::vector<Tuple<_Size, _Scalar> >& positions, double max_distance) {
+		std::vector<SpringEdge> edges;
+		const std::pair<std::vector<std::uint32_t>, std::uint8_t> sorted = sortAlongWidestAxis(positions);
+		const std::vector<std::uint32_t>& order = sorted.first;
+		const std::uint8_t axis = sorted.second;
+
+		for (std::uint32_t s = 0; s < order.size(); s++)
+			for (std::uint32_t t = s + 1; t < order.size(); t++) {
+				if ((double)positions[order[t]][axis] - positions[order[s]][axis] > max_distance)
+					break;
+				if (magnitudeSquared(positions[order[t]] - positions[order[s]]) <= max_distance * max_distance)
+					edges.push_back(SpringEdge{ order[s], order[t] });
+			}
+
+		normalizeEdges(edges);
+		return edges;
+	}
+
+	// Return edges joining every pair of "count" particles.
+	inline std::vector<SpringEdge> fullyConnectedEdges(std::uint32_t count) {
+		std::vector<SpringEdge> edges;
+		const std::uint64_t edge_count = count > 1 ? (std::uint64_t)count * (count - 1) / 2 : 0;
+		checkEdgeCount(edge_count, "fullyConnectedEdges()");
+		edges.reserve((std::size_t)edge_count);
+
+		for (std::uint32_t i = 0; i < count; i++)
+			for (std::uint32_t j = i + 1; j < count; j++)
+				edges.push_back(SpringEdge{ i, j });
+
+		return edges;
+	}
+}
+
+#endif
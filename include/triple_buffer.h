@@ -0,0 +1,63 @@
+// triple_buffer.h
+// Written by Weston Cook
+// Defines the class TripleBuffer
+
+#ifndef BRAZEN_TRIPLE_BUFFER_H
+#define BRAZEN_TRIPLE_BUFFER_H
+
+#include <array>  // std::array
+#include <atomic>  // std::atomic
+#include <cstdint>  // std::uint8_t
+
+namespace Brazen {
+	/*
+	Class TripleBuffer - lock-free single-producer/single-consumer exchange of the latest value of type T.
+
+	The producer always owns one buffer to write to and the consumer always owns one buffer to read from.
+	The third ("middle") buffer holds the latest published value. Its index and a "fresh" bit that marks
+	whether it has been published since the consumer last took it are packed into one atomic byte, so
+	publishing and taking are each a single atomic exchange: neither side ever blocks or waits on the other.
+	*/
+	template <typename T>
+	class TripleBuffer {
+	private:
+		// ATTRIBUTES
+		static constexpr std::uint8_t INDEX_MASK = 0x3;  // Bits of "middle" holding the index of the middle buffer
+		static constexpr std::uint8_t FRESH_BIT = 0x4;  // Bit of "middle" marking that the middle buffer holds unread data
+
+		std::array<T, 3> buffers;
+		std::atomic<std::uint8_t> middle;  // Index of the middle buffer, plus FRESH_BIT
+		std::uint8_t write_index;  // Index of the buffer owned by the producer
+		std::uint8_t read_index;  // Index of the buffer owned by the consumer
+	public:
+		// CONSTRUCTORS
+		TripleBuffer(void) :
+			middle(1), write_index(0), read_index(2)
+		{}
+
+		// MEMBER FUNCTIONS
+		// PRODUCER SIDE
+		// Return the buffer currently owned by the producer.
+		T& writeBuffer(void) { return buffers[write_index]; }
+		// Publish the producer's buffer as the latest value and take ownership of the old middle buffer.
+		void publish(void) {
+			// Release makes the writes to the published buffer visible to the consumer; acquire makes
+			//	sure the consumer is done with the buffer the producer gets back.
+			write_index = middle.exchange(write_index | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+		}
+
+		// CONSUMER SIDE
+		// Take the latest published value if there is one. Return whether the read buffer changed.
+		bool update(void) {
+			if (!(middle.load(std::memory_order_relaxed) & FRESH_BIT))
+				return false;  // Nothing new since the last update
+
+			read_index = middle.exchange(read_index, std::memory_order_acq_rel) & INDEX_MASK;
+			return true;
+		}
+		// Return the buffer currently owned by the consumer.
+		const T& readBuffer(void) const { return buffers[read_index]; }
+	};
+}
+
+#endif
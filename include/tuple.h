@@ -21,9 +21,23 @@
 #include <array>  // std::array
 #include <stdexcept>  // std::out_of_range
 #include <string>  // std::to_string
-#include <random> // std:: default_random_engine, std::uniform_real_distribution
+#include <random> // std::mt19937_64, std::random_device, std::uniform_real_distribution, std::normal_distribution
+#include <type_traits>  // std::enable_if, std::conjunction, std::is_convertible, std::is_same
 #include <stdlib.h>
 #include <iostream>
+#include "validation.h"
+
+
+template <typename _Expr, std::uint8_t _Size, typename _Scalar>
+struct TupleExpression;  // Defined in tuple_expression.h
+
+
+// Scalar arguments are taken as the Tuple's scalar type rather than deduced from, so "v * 2" and
+//	"v * .5" work whatever the scalar type is.
+template <typename T>
+struct ScalarArgument {
+	typedef T type;
+};
 
 
 /*
@@ -39,63 +53,91 @@
 // -Cross product (N-dimensional generalization)
 // -Return scalar projection of two vectors
 // -Return vector projection of two vectors
+// -Random unit vectors, uniformly distributed over the N-sphere
+// -Construction and arithmetic are constexpr, so constant Tuples are built at compile time
+//	(magnitude, unit and projection_scalar are not: they need a square root)
+//
+// The scalar type defaults to double. float halves the memory traffic of large particle clouds (and
+//	doubles SIMD width); Brazen::Fixed32 (fixed_point.h) is a deterministic 16.16 fixed-point type.
 //
-// NOTE: Explicit specializations are defined for _Size = 2, 3 for computational efficiency.
+// NOTE: Partial specializations are defined for _Size = 2, 3 for computational efficiency.
 // WARNING: For efficiency, Tuple uses type std::uint8_t for its dimension, so dimensions
 //	greater than 255 are not allowed.
 //
 */
-template <std::uint8_t _Size>
+template <std::uint8_t _Size, typename _Scalar = double>
 struct Tuple {
-	std::array<double, _Size> value;
+	typedef _Scalar scalar_type;
 
-	// Initialize with all zeros if zeros is true
-	Tuple(bool zeros = true) {
-		if (zeros)
-			setZero();
+	std::array<_Scalar, _Size> value;
+
+	// Initialize with all zeros. "zeros" is kept for callers that pass false to skip it, but a constexpr
+	//	constructor must initialize every member, so the zeros are always written (and are dead stores the
+	//	compiler drops whenever every component is assigned right after).
+	constexpr Tuple(bool zeros = true) :
+		value{}
+	{
+		(void)zeros;
 	}
 
 	// Initialize with the given values
-	template <typename... T>
-	Tuple(T... v) :
-		value({ v... })
+	template <typename... T, typename = typename std::enable_if<std::conjunction<std::is_convertible<T, _Scalar>...>::value>::type>
+	constexpr Tuple(T... v) :
+		value({ static_cast<_Scalar>(v)... })
 	{}
 
 	// Initialize with the given std::array of values
 	template <typename T>
-	Tuple(const std::array<T, _Size> v) :
+	constexpr Tuple(const std::array<T, _Size> v) :
 		value(v)
 	{}
 
 	// Initialize with the given Tuple
-	Tuple(const Tuple<_Size>& v) :
+	constexpr Tuple(const Tuple<_Size, _Scalar>& v) :
 		value(v.value)
 	{}
 
+	// Initialize with the given Tuple of another scalar type
+	template <typename T>
+	constexpr explicit Tuple(const Tuple<_Size, T>& v) :
+		value{}
+	{
+		for (std::uint8_t i = 0; i < _Size; i++)
+			value[i] = static_cast<_Scalar>(v.value[i]);
+	}
+
 
 	// Assign this tuple to have the same value as the argument std::array
 	template <typename T>
-	const Tuple<_Size>& operator=(const std::array<T, _Size>& v) {
+	constexpr const Tuple<_Size, _Scalar>& operator=(const std::array<T, _Size>& v) {
 		for (std::uint8_t i = 0; i < _Size; i++)
 			value[i] = v[i];
+
+		return *this;
 	}
 
+	// Assign this tuple the value of a Tuple expression (see tuple_expression.h)
+	template <typename _Expr>
+	const Tuple<_Size, _Scalar>& operator=(const TupleExpression<_Expr, _Size, _Scalar>& e);
+
 	// Assign this tuple to have the same value as the argument tuple
-	const Tuple<_Size>& operator=(const Tuple<_Size>& v) {
+	constexpr const Tuple<_Size, _Scalar>& operator=(const Tuple<_Size, _Scalar>& v) {
 		for (std::uint8_t i = 0; i < _Size; i++)
 			value[i] = v.value[i];
+
+		return *this;
 	}
 
 
 	// Index the components - mutable
-	double& operator[](std::uint8_t i) {
+	constexpr _Scalar& operator[](std::uint8_t i) {
 		if (i < _Size)
 			return value[i];
 		throw std::out_of_range("Index " + std::to_string(i) + " out of range for " + std::to_string(_Size) + "-Tuple.");
 	}
 
 	// Index the components - immutable
-	double operator[](std::uint8_t i) const {
+	constexpr _Scalar operator[](std::uint8_t i) const {
 		if (i < _Size)
 			return value[i];
 		throw std::out_of_range("Index " + std::to_string(i) + " out of range for " + std::to_string(_Size) + "-Tuple.");
@@ -103,7 +145,7 @@ struct Tuple {
 
 
 	// Set all components to zero
-	void setZero(void) {
+	constexpr void setZero(void) {
 		for (std::uint8_t i = 0; i < _Size; i++)
 			value[i] = 0.;
 	}
@@ -112,53 +154,70 @@ struct Tuple {
 
 /*
 //
-// Explicit specialization of struct "Tuple" for 2-tuples.
+// Partial specialization of struct "Tuple" for 2-tuples.
 //
 */
-template <>
-struct Tuple<2> {
-	double x;
-	double y;
-
-	// Initialize with all zeros if zeros is true
-	Tuple(bool zeros = true) {
-		if (zeros)
-			setZero();
+template <typename _Scalar>
+struct Tuple<2, _Scalar> {
+	typedef _Scalar scalar_type;
+
+	_Scalar x;
+	_Scalar y;
+
+	// Initialize with all zeros (see the general Tuple)
+	constexpr Tuple(bool zeros = true) :
+		x(0.), y(0.)
+	{
+		(void)zeros;
 	}
 
 	// Initialize with the given values
 	template <typename T>
-	Tuple(T x, T y) :
+	constexpr Tuple(T x, T y) :
 		x(x), y(y)
 	{}
 
 	// Initialize with the given std::array of values
 	template <typename T>
-	Tuple(const std::array<T, 2> v) :
+	constexpr Tuple(const std::array<T, 2> v) :
 		x(v[0]), y(v[1])
 	{}
 
 	// Initialize with the given tuple
-	Tuple(const Tuple<2>& v) :
+	constexpr Tuple(const Tuple<2, _Scalar>& v) :
 		x(v.x), y(v.y)
 	{}
 
+	// Initialize with the given tuple of another scalar type
+	template <typename T>
+	constexpr explicit Tuple(const Tuple<2, T>& v) :
+		x(static_cast<_Scalar>(v.x)), y(static_cast<_Scalar>(v.y))
+	{}
+
 
 	// Assign this tuple to have the same value as the argument std::array
-	const Tuple<2>& operator=(const std::array<double, 2>& v) {
+	constexpr const Tuple<2, _Scalar>& operator=(const std::array<_Scalar, 2>& v) {
 		x = v[0];
 		y = v[1];
+
+		return *this;
 	}
 
+	// Assign this tuple the value of a Tuple expression (see tuple_expression.h)
+	template <typename _Expr>
+	const Tuple<2, _Scalar>& operator=(const TupleExpression<_Expr, 2, _Scalar>& e);
+
 	// Assign this tuple to have the same value as the argument tuple
-	const Tuple<2>& operator=(const Tuple<2>& v) {
+	constexpr const Tuple<2, _Scalar>& operator=(const Tuple<2, _Scalar>& v) {
 		x = v.x;
 		y = v.y;
+
+		return *this;
 	}
 
 
 	// Index the components - mutable
-	double& operator[](std::uint8_t i) {
+	constexpr _Scalar& operator[](std::uint8_t i) {
 		switch (i) {
 		case 0:
 			return x;
@@ -170,7 +229,7 @@ struct Tuple<2> {
 	}
 
 	// Index the components - immutable
-	double operator[](std::uint8_t i) const {
+	constexpr _Scalar operator[](std::uint8_t i) const {
 		switch (i) {
 		case 0:
 			return x;
@@ -183,7 +242,7 @@ struct Tuple<2> {
 
 
 	// Set all elements to zero
-	void setZero(void) {
+	constexpr void setZero(void) {
 		x = 0.;
 		y = 0.;
 	}
@@ -192,56 +251,73 @@ struct Tuple<2> {
 
 /*
 //
-// Explicit specialization of struct "Tuple" for 3-tuples.
+// Partial specialization of struct "Tuple" for 3-tuples.
 //
 */
-template <>
-struct Tuple<3> {
-	double x;
-	double y;
-	double z;
-
-	// Initialize with all zeros if zeros is true
-	Tuple(bool zeros = true) {
-		if (zeros)
-			setZero();
+template <typename _Scalar>
+struct Tuple<3, _Scalar> {
+	typedef _Scalar scalar_type;
+
+	_Scalar x;
+	_Scalar y;
+	_Scalar z;
+
+	// Initialize with all zeros (see the general Tuple)
+	constexpr Tuple(bool zeros = true) :
+		x(0.), y(0.), z(0.)
+	{
+		(void)zeros;
 	}
 
 	// Initialize with the given values
 	template <typename T>
-	Tuple(T x, T y, T z) :
+	constexpr Tuple(T x, T y, T z) :
 		x(x), y(y), z(z)
 	{}
 
 	// Initialize with the given std::array of values
 	template <typename T>
-	Tuple(const std::array<T, 3> v) :
+	constexpr Tuple(const std::array<T, 3> v) :
 		x(v[0]), y(v[1]), z(v[2])
 	{}
 
 	// Initialize with the given tuple
-	Tuple(const Tuple<3>& v) :
+	constexpr Tuple(const Tuple<3, _Scalar>& v) :
 		x(v.x), y(v.y), z(v.z)
 	{}
 
+	// Initialize with the given tuple of another scalar type
+	template <typename T>
+	constexpr explicit Tuple(const Tuple<3, T>& v) :
+		x(static_cast<_Scalar>(v.x)), y(static_cast<_Scalar>(v.y)), z(static_cast<_Scalar>(v.z))
+	{}
+
 
 	// Assign this tuple to have the same value as the argument std::array
-	const Tuple<3>& operator=(const std::array<double, 3>& v) {
+	constexpr const Tuple<3, _Scalar>& operator=(const std::array<_Scalar, 3>& v) {
 		x = v[0];
 		y = v[1];
 		z = v[2];
+
+		return *this;
 	}
 
+	// Assign this tuple the value of a Tuple expression (see tuple_expression.h)
+	template <typename _Expr>
+	const Tuple<3, _Scalar>& operator=(const TupleExpression<_Expr, 3, _Scalar>& e);
+
 	// Assign this tuple to have the same value as the argument tuple
-	const Tuple<3>& operator=(const Tuple<3>& v) {
+	constexpr const Tuple<3, _Scalar>& operator=(const Tuple<3, _Scalar>& v) {
 		x = v.x;
 		y = v.y;
 		z = v.z;
+
+		return *this;
 	}
 
 
 	// Index the components - mutable
-	double& operator[](std::uint8_t i) {
+	constexpr _Scalar& operator[](std::uint8_t i) {
 		switch (i) {
 		case 0:
 			return x;
@@ -255,7 +331,7 @@ struct Tuple<3> {
 	}
 
 	// Index the components - immutable
-	double operator[](std::uint8_t i) const {
+	constexpr _Scalar operator[](std::uint8_t i) const {
 		switch (i) {
 		case 0:
 			return x;
@@ -270,7 +346,7 @@ struct Tuple<3> {
 
 
 	// Set all elements to zero
-	void setZero(void) {
+	constexpr void setZero(void) {
 		x = 0.;
 		y = 0.;
 		z = 0.;
@@ -282,9 +358,9 @@ struct Tuple<3> {
 /*************NOT IN PLACE************/
 // SCALAR VECTOR MULTIPLICATION
 // vector, scalar
-template <std::uint8_t _Size>
-Tuple<_Size> operator*(const Tuple<_Size>& v, double s) {
-	Tuple<_Size> out(false);
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> operator*(const Tuple<_Size, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
+	Tuple<_Size, _Scalar> out(false);
 
 	for (std::uint8_t i = 0; i < _Size; i++)
 		out.value[i] = v.value[i] * s;
@@ -292,19 +368,21 @@ Tuple<_Size> operator*(const Tuple<_Size>& v, double s) {
 	return out;
 }
 
-inline Tuple<2> operator*(const Tuple<2>& v, double s) {
-	return Tuple<2>(v.x * s, v.y * s);
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar> operator*(const Tuple<2, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
+	return Tuple<2, _Scalar>(v.x * s, v.y * s);
 }
 
-inline Tuple<3> operator*(const Tuple<3>& v, double s) {
-	return Tuple<3>(v.x * s, v.y * s, v.z * s);
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> operator*(const Tuple<3, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
+	return Tuple<3, _Scalar>(v.x * s, v.y * s, v.z * s);
 }
 
 
 // vector, scalar
-template <std::uint8_t _Size>
-Tuple<_Size> operator*(double s, const Tuple<_Size>& v) {
-	Tuple<_Size> out(false);
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> operator*(typename ScalarArgument<_Scalar>::type s, const Tuple<_Size, _Scalar>& v) {
+	Tuple<_Size, _Scalar> out(false);
 
 	for (std::uint8_t i = 0; i < _Size; i++)
 		out.value[i] = v.value[i] * s;
@@ -312,19 +390,21 @@ Tuple<_Size> operator*(double s, const Tuple<_Size>& v) {
 	return out;
 }
 
-inline Tuple<2> operator*(double s, const Tuple<2>& v) {
-	return Tuple<2>(v.x * s, v.y * s);
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar> operator*(typename ScalarArgument<_Scalar>::type s, const Tuple<2, _Scalar>& v) {
+	return Tuple<2, _Scalar>(v.x * s, v.y * s);
 }
 
-inline Tuple<3> operator*(double s, const Tuple<3>& v) {
-	return Tuple<3>(v.x * s, v.y * s, v.z * s);
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> operator*(typename ScalarArgument<_Scalar>::type s, const Tuple<3, _Scalar>& v) {
+	return Tuple<3, _Scalar>(v.x * s, v.y * s, v.z * s);
 }
 
 
 // SCALAR VECTOR DIVISION
-template <std::uint8_t _Size>
-Tuple<_Size> operator/(const Tuple<_Size>& v, double s) {
-	Tuple<_Size> out(false);
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> operator/(const Tuple<_Size, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
+	Tuple<_Size, _Scalar> out(false);
 
 	for (std::uint8_t i = 0; i < _Size; i++)
 		out.value[i] = v.value[i] / s;
@@ -332,19 +412,21 @@ Tuple<_Size> operator/(const Tuple<_Size>& v, double s) {
 	return out;
 }
 
-inline Tuple<2> operator/(const Tuple<2>& v, double s) {
-	return Tuple<2>(v.x / s, v.y / s);
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar> operator/(const Tuple<2, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
+	return Tuple<2, _Scalar>(v.x / s, v.y / s);
 }
 
-inline Tuple<3> operator/(const Tuple<3>& v, double s) {
-	return Tuple<3>(v.x / s, v.y / s, v.z / s);
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> operator/(const Tuple<3, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
+	return Tuple<3, _Scalar>(v.x / s, v.y / s, v.z / s);
 }
 
 
 // VECTOR ADDITION
-template <std::uint8_t _Size>
-Tuple<_Size> operator+(const Tuple<_Size>& v1, const Tuple<_Size>& v2) {
-	Tuple<_Size> out(false);
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> operator+(const Tuple<_Size, _Scalar>& v1, const Tuple<_Size, _Scalar>& v2) {
+	Tuple<_Size, _Scalar> out(false);
 
 	for (std::uint8_t i = 0; i < _Size; i++)
 		out.value[i] = v1.value[i] + v2.value[i];
@@ -352,19 +434,21 @@ Tuple<_Size> operator+(const Tuple<_Size>& v1, const Tuple<_Size>& v2) {
 	return out;
 }
 
-inline Tuple<2> operator+(const Tuple<2>& v1, const Tuple<2>& v2) {
-	return Tuple<2>(v1.x + v2.x, v1.y + v2.y);
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar> operator+(const Tuple<2, _Scalar>& v1, const Tuple<2, _Scalar>& v2) {
+	return Tuple<2, _Scalar>(v1.x + v2.x, v1.y + v2.y);
 }
 
-inline Tuple<3> operator+(const Tuple<3>& v1, const Tuple<3>& v2) {
-	return Tuple<3>(v1.x + v2.x, v1.y + v2.y, v1.z + v2.z);
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> operator+(const Tuple<3, _Scalar>& v1, const Tuple<3, _Scalar>& v2) {
+	return Tuple<3, _Scalar>(v1.x + v2.x, v1.y + v2.y, v1.z + v2.z);
 }
 
 
 // VECTOR SUBTRACTION
-template <std::uint8_t _Size>
-Tuple<_Size> operator-(const Tuple<_Size>& v1, const Tuple<_Size>& v2) {
-	Tuple<_Size> out(false);
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> operator-(const Tuple<_Size, _Scalar>& v1, const Tuple<_Size, _Scalar>& v2) {
+	Tuple<_Size, _Scalar> out(false);
 
 	for (std::uint8_t i = 0; i < _Size; i++)
 		out.value[i] = v1.value[i] - v2.value[i];
@@ -372,43 +456,48 @@ Tuple<_Size> operator-(const Tuple<_Size>& v1, const Tuple<_Size>& v2) {
 	return out;
 }
 
-inline Tuple<2> operator-(const Tuple<2>& v1, const Tuple<2>& v2) {
-	return Tuple<2>(v1.x - v2.x, v1.y - v2.y);
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar> operator-(const Tuple<2, _Scalar>& v1, const Tuple<2, _Scalar>& v2) {
+	return Tuple<2, _Scalar>(v1.x - v2.x, v1.y - v2.y);
 }
 
-inline Tuple<3> operator-(const Tuple<3>& v1, const Tuple<3>& v2) {
-	return Tuple<3>(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z);
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> operator-(const Tuple<3, _Scalar>& v1, const Tuple<3, _Scalar>& v2) {
+	return Tuple<3, _Scalar>(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z);
 }
 
 
 // DOT PRODUCT
-template <std::uint8_t _Size>
-double dot(const Tuple<_Size>& v1, const Tuple<_Size>& v2) {
-	double sum = 0.;
+template <std::uint8_t _Size, typename _Scalar>
+constexpr _Scalar dot(const Tuple<_Size, _Scalar>& v1, const Tuple<_Size, _Scalar>& v2) {
+	_Scalar sum = 0.;
 
 	for (std::uint8_t i = 0; i < _Size; i++)
 		sum += v1.value[i] * v2.value[i];
 
 	return sum;
 }
-inline double dot(const Tuple<2>& v1, const Tuple<2>& v2) {
+template <typename _Scalar>
+constexpr _Scalar dot(const Tuple<2, _Scalar>& v1, const Tuple<2, _Scalar>& v2) {
 	return v1.x * v2.x + v1.y * v2.y;
 }
-inline double dot(const Tuple<3>& v1, const Tuple<3>& v2) {
+template <typename _Scalar>
+constexpr _Scalar dot(const Tuple<3, _Scalar>& v1, const Tuple<3, _Scalar>& v2) {
 	return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
 }
 
 
 // CROSS PRODUCT
-inline Tuple<3> cross(const Tuple<3>& v1, const Tuple<3>& v2) {
-	return Tuple<3>(v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x);
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> cross(const Tuple<3, _Scalar>& v1, const Tuple<3, _Scalar>& v2) {
+	return Tuple<3, _Scalar>(v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x);
 }
 
 
 // MAGNITUDE
-template <std::uint8_t _Size>
-double magnitudeSquared(const Tuple<_Size>& v) {
-	double sum = 0.;
+template <std::uint8_t _Size, typename _Scalar>
+constexpr _Scalar magnitudeSquared(const Tuple<_Size, _Scalar>& v) {
+	_Scalar sum = 0.;
 
 	for (std::uint8_t i = 0; i < _Size; i++)
 		sum += v.value[i] * v.value[i];
@@ -416,134 +505,145 @@ double magnitudeSquared(const Tuple<_Size>& v) {
 	return sum;
 }
 
-inline double magnitudeSquared(const Tuple<2>& v) {
+template <typename _Scalar>
+constexpr _Scalar magnitudeSquared(const Tuple<2, _Scalar>& v) {
 	return v.x * v.x + v.y * v.y;
 }
 
-inline double magnitudeSquared(const Tuple<3>& v) {
+template <typename _Scalar>
+constexpr _Scalar magnitudeSquared(const Tuple<3, _Scalar>& v) {
 	return v.x * v.x + v.y * v.y + v.z * v.z;
 }
 
-template <std::uint8_t _Size>
-inline double magnitude(const Tuple<_Size>& v) {
+template <std::uint8_t _Size, typename _Scalar>
+inline _Scalar magnitude(const Tuple<_Size, _Scalar>& v) {
+	using std::sqrt;  // Other scalar types provide their own sqrt, found by argument-dependent lookup
+
 	return sqrt(magnitudeSquared(v));
 }
 
-inline double magnitude(const Tuple<1>& v) {
-	return std::abs(v.value[0]);
+template <typename _Scalar>
+inline _Scalar magnitude(const Tuple<1, _Scalar>& v) {
+	using std::abs;
+
+	return abs(v.value[0]);
 }
 
 
 // RANDOMLY ORIENTED TUPLE
-double random_angle(void) {  // Helper function containing static objects used for generating random doubles
-	static std::random_device dev;
-	static std::default_random_engine generator(dev());
-	static std::uniform_real_distribution<double> distribution(0, 6.28318530718);
+// Return this thread's random number generator, seeded from std::random_device the first time a thread asks.
+//	Every thread has its own, so threads never contend for (or race on) generator state.
+inline std::mt19937_64& random_generator(void) {
+	thread_local std::mt19937_64 generator(std::random_device{}());
 
-	return distribution(generator);
-};
+	return generator;
+}
 
-template <std::uint8_t _Size>
-Tuple<_Size> random_unit(void) {  // Return a randomly oriented unit vector from a distribution that is uniform across the surface of the unit N-sphere.
-	std::array<double, _Size - 1> angles;  // Array containing the generalized spherical coordinates of the vector (without radius)
-	Tuple<_Size> out(false);  // Output Tuple
-	out.value[0] = 1.;  // Begin setting all output values to 1
+// Return an angle uniformly distributed on [0, 2*pi).
+inline double random_angle(void) {
+	return std::uniform_real_distribution<double>(0., 6.28318530718)(random_generator());
+}
 
-						// Generate the spherical coordinate angles from a uniform distribution on [0, 2*pi)
-	for (std::uint8_t i = 0; i < _Size - 1; i++) {
-		angles[i] = random_angle();
-		out.value[i + 1] = 1.;  // Finish setting all values of out to 1
+// Return a randomly oriented unit vector from a distribution that is uniform across the surface of the unit N-sphere,
+//	drawing from the given generator (any standard uniform random bit generator).
+//	In general, a vector of independent normally distributed components points in a uniformly distributed direction,
+//	so normalizing one takes _Size samples and a square root. 2 and 3 dimensions have cheaper exact methods.
+template <std::uint8_t _Size, typename _Scalar = double, typename Generator>
+Tuple<_Size, _Scalar> random_unit(Generator& generator) {
+	if constexpr (_Size == 2) {
+		const double angle = std::uniform_real_distribution<double>(0., 6.283185307179586)(generator);
+		return Tuple<2, _Scalar>(Tuple<2>(std::cos(angle), std::sin(angle)));
+	}
+	else if constexpr (_Size == 3) {  // Archimedes: z is uniformly distributed on [-1, 1] over the sphere's surface
+		const double z = std::uniform_real_distribution<double>(-1., 1.)(generator);
+		const double angle = std::uniform_real_distribution<double>(0., 6.283185307179586)(generator);
+		const double r = std::sqrt(1. - z * z);
+		return Tuple<3, _Scalar>(Tuple<3>(r * std::cos(angle), r * std::sin(angle), z));
 	}
+	else {
+		std::normal_distribution<double> normal;
+		Tuple<_Size, double> out(false);
+		double magnitude_squared;
 
-	// Convert the spherical coordinates to Euclidean coordinates
-	//	(there has to be a more computationally efficient way
-	//   to do this, but I haven't found it just yet)
-	for (std::uint8_t i = 0; i < _Size - 1; i++) {
-		out.value[i] *= std::cos(angles[i]);
+		do {
+			for (std::uint8_t i = 0; i < _Size; i++)
+				out[i] = normal(generator);
+			magnitude_squared = magnitudeSquared(out);
+		} while (!(magnitude_squared > 0.));  // All zeros: practically impossible, but has no direction
 
-		for (std::uint8_t j = i + 1; j < _Size; j++)
-			out.value[j] *= std::sin(angles[i]);
+		return Tuple<_Size, _Scalar>(out / std::sqrt(magnitude_squared));
 	}
-
-	return out;
 }
 
-template <>
-Tuple<1> random_unit(void) {  // Return a randomly oriented unit vector from a distribution that is uniform across the surface of the unit 1-sphere.
-	double direction = random_angle() - 3.14159265358979323846;  // Uniformly distributed on [-pi, pi)
-
-	return Tuple<1>(direction / std::abs(direction));
+// Return a randomly oriented unit vector, drawing from this thread's generator.
+template <std::uint8_t _Size, typename _Scalar = double>
+Tuple<_Size, _Scalar> random_unit(void) {
+	return random_unit<_Size, _Scalar>(random_generator());
 }
 
-template <>
-Tuple<2> random_unit(void) {  // Return a randomly oriented unit vector from a distribution that is uniform across the surface of the unit 2-sphere.
-	double theta = random_angle();
 
-	return Tuple<2>(std::cos(theta), std::sin(theta));
-}
-
-template <>
-Tuple<3> random_unit(void) {  // Return a randomly oriented unit vector from a distribution that is uniform across the surface of the unit 3-sphere.
-	double theta = random_angle();
-	double phi = random_angle();
+// UNIT
+// Return the unit vector of v, or ErrorCode::ZERO_VECTOR if v has no direction. Never prints.
+template <std::uint8_t _Size, typename _Scalar>
+Brazen::Result<Tuple<_Size, _Scalar> > checked_unit(const Tuple<_Size, _Scalar>& v) {
+	_Scalar mag = magnitude(v);
 
-	return Tuple<3>(std::sin(phi)*std::cos(theta), std::sin(phi)*std::sin(theta), std::cos(phi));
+	if (mag > 0.)  // Unit vector is defined
+		return v / mag;
+	return Brazen::ErrorCode::ZERO_VECTOR;
 }
 
+// Return the unit vector of v. The zero vector gets a warning and a randomly oriented unit vector, or, without
+//	"fake_it," a thrown Brazen::ValidationError.
+template <std::uint8_t _Size, typename _Scalar>
+Tuple<_Size, _Scalar> unit(const Tuple<_Size, _Scalar>& v, bool fake_it = true) {
+	Brazen::Result<Tuple<_Size, _Scalar> > result = checked_unit(v);
 
-// UNIT
-template <std::uint8_t _Size>
-Tuple<_Size> unit(const Tuple<_Size>& v, bool fake_it = true) {
-	// Compute the magnitude of the vector
-	double mag = magnitude(v);
+	if (result)  // Unit vector is defined
+		return *result;
+	if (!fake_it)
+		return result.value();  // Throws
 
-	if (mag > 0.)  // Unit vector is defined
-		return v / mag;
-	// Division by zero, unit vector is not defined
+	// Division by zero, return a randomly oriented unit vector
 	std::cerr << "Warning: division by zero in function Tuple<" + std::to_string(_Size) + "> unit(const Tuple<" + std::to_string(_Size) + ">& v)." << std::endl;
-
-	if (fake_it) {  // Return a randomly oriented unit vector
-		return random_unit<_Size>();
-	}
-	else {
-		std::cerr << "Finding the unit vector of the zero vector is fatal. Exiting." << std::endl;
-		exit(EXIT_FAILURE);
-	}
+	return random_unit<_Size, _Scalar>();
 }
 
 
 // VECTOR PROJECTION
 // Scalar projection of v1 onto v2.
-template <std::uint8_t _Size>
-double projection_scalar(const Tuple<_Size>& v1, const Tuple<_Size>& v2) {
+template <std::uint8_t _Size, typename _Scalar>
+_Scalar projection_scalar(const Tuple<_Size, _Scalar>& v1, const Tuple<_Size, _Scalar>& v2) {
 	return dot(v1, v2) / magnitude(v2);
 }
 
 // Vector projection of v1 onto v2.
-template <std::uint8_t _Size>
-Tuple<_Size> projection_vector(const Tuple<_Size>& v1, const Tuple<_Size>& v2) {
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> projection_vector(const Tuple<_Size, _Scalar>& v1, const Tuple<_Size, _Scalar>& v2) {
 	return v2 * (dot(v1, v2) / magnitudeSquared(v2));
 }
 
 
 /***************IN PLACE OPERATIONS***************/
 // SCALAR VECTOR MULTIPLICATION
-template <std::uint8_t _Size>
-Tuple<_Size>& operator*=(Tuple<_Size>& v, double s) {
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar>& operator*=(Tuple<_Size, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
 	for (std::uint8_t i = 0; i < _Size; i++)
 		v.value[i] *= s;
 
 	return v;
 }
 
-Tuple<2>& operator*=(Tuple<2>& v, double s) {
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar>& operator*=(Tuple<2, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
 	v.x *= s;
 	v.y *= s;
 
 	return v;
 }
 
-Tuple<3>& operator*=(Tuple<3>& v, double s) {
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar>& operator*=(Tuple<3, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
 	v.x *= s;
 	v.y *= s;
 	v.z *= s;
@@ -553,22 +653,24 @@ Tuple<3>& operator*=(Tuple<3>& v, double s) {
 
 
 // SCALAR VECTOR DIVISION
-template <std::uint8_t _Size>
-Tuple<_Size>& operator/=(Tuple<_Size>& v, double s) {
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar>& operator/=(Tuple<_Size, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
 	for (std::uint8_t i = 0; i < _Size; i++)
 		v.value[i] /= s;
 
 	return v;
 }
 
-Tuple<2>& operator/=(Tuple<2>& v, double s) {
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar>& operator/=(Tuple<2, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
 	v.x /= s;
 	v.y /= s;
 
 	return v;
 }
 
-Tuple<3>& operator/=(Tuple<3>& v, double s) {
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar>& operator/=(Tuple<3, _Scalar>& v, typename ScalarArgument<_Scalar>::type s) {
 	v.x /= s;
 	v.y /= s;
 	v.z /= s;
@@ -578,22 +680,24 @@ Tuple<3>& operator/=(Tuple<3>& v, double s) {
 
 
 // VECTOR ADDITION
-template <std::uint8_t _Size>
-Tuple<_Size> operator+=(Tuple<_Size>& v1, const Tuple<_Size>& v2) {
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> operator+=(Tuple<_Size, _Scalar>& v1, const Tuple<_Size, _Scalar>& v2) {
 	for (std::uint8_t i = 0; i < _Size; i++)
 		v1.value[i] += v2.value[i];
 
 	return v1;
 }
 
-Tuple<2> operator+=(Tuple<2>& v1, const Tuple<2>& v2) {
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar> operator+=(Tuple<2, _Scalar>& v1, const Tuple<2, _Scalar>& v2) {
 	v1.x += v2.x;
 	v1.y += v2.y;
 
 	return v1;
 }
 
-Tuple<3> operator+=(Tuple<3>& v1, const Tuple<3>& v2) {
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> operator+=(Tuple<3, _Scalar>& v1, const Tuple<3, _Scalar>& v2) {
 	v1.x += v2.x;
 	v1.y += v2.y;
 	v1.z += v2.z;
@@ -603,22 +707,24 @@ Tuple<3> operator+=(Tuple<3>& v1, const Tuple<3>& v2) {
 
 
 // VECTOR SUBTRACTION
-template <std::uint8_t _Size>
-Tuple<_Size> operator-=(Tuple<_Size>& v1, const Tuple<_Size>& v2) {
+template <std::uint8_t _Size, typename _Scalar>
+constexpr Tuple<_Size, _Scalar> operator-=(Tuple<_Size, _Scalar>& v1, const Tuple<_Size, _Scalar>& v2) {
 	for (std::uint8_t i = 0; i < _Size; i++)
 		v1.value[i] -= v2.value[i];
 
 	return v1;
 }
 
-Tuple<2> operator-=(Tuple<2>& v1, const Tuple<2>& v2) {
+template <typename _Scalar>
+constexpr Tuple<2, _Scalar> operator-=(Tuple<2, _Scalar>& v1, const Tuple<2, _Scalar>& v2) {
 	v1.x -= v2.x;
 	v1.y -= v2.y;
 
 	return v1;
 }
 
-Tuple<3> operator-=(Tuple<3>& v1, const Tuple<3>& v2) {
+template <typename _Scalar>
+constexpr Tuple<3, _Scalar> operator-=(Tuple<3, _Scalar>& v1, const Tuple<3, _Scalar>& v2) {
 	v1.x -= v2.x;
 	v1.y -= v2.y;
 	v1.z -= v2.z;
@@ -628,8 +734,8 @@ Tuple<3> operator-=(Tuple<3>& v1, const Tuple<3>& v2) {
 
 
 // STREAM INSERTION
-template <std::uint8_t _Size>
-std::ostream& operator<<(std::ostream &s, const Tuple<_Size>& v) {
+template <std::uint8_t _Size, typename _Scalar>
+std::ostream& operator<<(std::ostream &s, const Tuple<_Size, _Scalar>& v) {
 	s << "< " << v.value[0];
 
 	for (std::uint8_t i = 1; i < _Size; i++)
@@ -640,13 +746,15 @@ std::ostream& operator<<(std::ostream &s, const Tuple<_Size>& v) {
 	return s;
 }
 
-std::ostream& operator<<(std::ostream &s, const Tuple<2>& v) {
+template <typename _Scalar>
+std::ostream& operator<<(std::ostream &s, const Tuple<2, _Scalar>& v) {
 	s << "< " << v.x << ", " << v.y << " >";
 
 	return s;
 }
 
-std::ostream& operator<<(std::ostream &s, const Tuple<3>& v) {
+template <typename _Scalar>
+std::ostream& operator<<(std::ostream &s, const Tuple<3, _Scalar>& v) {
 	s << "< " << v.x << ", " << v.y << ", " << v.z << " >";
 
 	return s;
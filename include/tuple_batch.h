@@ -0,0 +1,696 @@
+// tuple_batch.h
+// Written by Weston Cook
+// Defines batch versions of the Tuple math functions that work on whole arrays of tuples
+
+#ifndef BRAZEN_TUPLE_BATCH_H
+#define BRAZEN_TUPLE_BATCH_H
+
+#include "tuple.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <cstdint>  // std::uint8_t, std::uint32_t, std::uint64_t
+#include <cstring>  // std::memcpy
+#include <cmath>  // std::sqrt, std::log, std::sin, std::cos
+#include <algorithm>  // std::min
+#include <type_traits>  // std::is_same
+
+namespace Brazen {
+	/*
+	Struct TupleComponents - structure-of-arrays view of tuples: component c of tuple i is component[c][i].
+	*/
+	template <std::uint8_t _Size, typename _Scalar = double>
+	struct TupleComponents {
+		_Scalar* component[_Size];
+	};
+
+	/*
+	Batch equivalents of the Tuple functions, over tuples [0, count):
+
+		axpyBatch:              y[i] += a * x[i]
+		dotBatch:               out[i] = dot(v1[i], v2[i])
+		magnitudeBatch:         out[i] = magnitude(v[i])
+		unitBatch:              out[i] = unit(v[i])
+		projectionVectorBatch:  out[i] = projection_vector(v1[i], v2[i])
+
+	Each takes either arrays of Tuple or TupleComponents views. Every result is computed in the same order as
+	the single-tuple function, so whichever kernel ran it matches to within rounding. It is exact only if the compiler
+	contracts neither into fused multiply-adds (-ffp-contract=off); GCC contracts by default when targeting FMA,
+	differently in each. Fixed point results always match exactly. Outputs may alias inputs.
+	Zero vectors passed to "unitBatch()" get the same warning and random unit vector as "unit()." Passing a
+	ThreadPool splits the tuples across its threads.
+
+	TupleComponents is the layout to use in hot loops: every component is a contiguous run, which the AVX2
+	kernels work through 4 doubles or 8 floats at a time. On arrays of Tuple only "axpyBatch()," which does not
+	care where one tuple ends and the next begins, is vectorized. Gathering the components of interleaved tuples
+	into vectors and scattering the results back costs more than the vector math saves, so the other functions
+	run the single-tuple functions in a loop there. The AVX2 kernels also run on AVX-512 CPUs, where these loops
+	are limited by memory bandwidth rather than vector width. Scalar types other than double and float, such as
+	Fixed32, always use the portable kernels.
+	*/
+
+	// Number of tuples per ThreadPool chunk. Large, since every tuple costs only a few instructions.
+	const std::uint32_t TUPLE_BATCH_CHUNK = 4096;
+
+	// Return the scalars of an array of Tuple, tuple after tuple.
+	template <std::uint8_t _Size, typename _Scalar>
+	inline _Scalar* scalarsOf(Tuple<_Size, _Scalar>* v) {
+		static_assert(sizeof(Tuple<_Size, _Scalar>) == _Size * sizeof(_Scalar), "Batch kernels require Tuple<_Size, _Scalar> to be _Size packed scalars.");
+		return reinterpret_cast<_Scalar*>(v);
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	inline const _Scalar* scalarsOf(const Tuple<_Size, _Scalar>* v) {
+		static_assert(sizeof(Tuple<_Size, _Scalar>) == _Size * sizeof(_Scalar), "Batch kernels require Tuple<_Size, _Scalar> to be _Size packed scalars.");
+		return reinterpret_cast<const _Scalar*>(v);
+	}
+
+	// Call "function(begin, end)" over [0, count), split across the pool's threads if there is one.
+	template <typename Function>
+	void forEachTupleChunk(std::uint32_t count, ThreadPool* pool, Function function) {
+		if (pool)
+			pool->parallelFor(0, count, TUPLE_BATCH_CHUNK, function);
+		else
+			function(0, count);
+	}
+
+
+	/*************PORTABLE KERNELS************/
+	// y[k] += a * x[k] for scalars [begin, end)
+	template <typename _Scalar>
+	void axpyScalar(_Scalar a, const _Scalar* x, _Scalar* y, std::uint32_t begin, std::uint32_t end) {
+		for (std::uint32_t k = begin; k < end; k++)
+			y[k] += a * x[k];
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void dotScalar(const TupleComponents<_Size, _Scalar>& v1, const TupleComponents<_Size, _Scalar>& v2, _Scalar* out, std::uint32_t begin, std::uint32_t end) {
+		for (std::uint32_t i = begin; i < end; i++) {
+			_Scalar sum = 0.;
+			for (std::uint8_t c = 0; c < _Size; c++)
+				sum += v1.component[c][i] * v2.component[c][i];
+			out[i] = sum;
+		}
+	}
+
+	// Magnitude of tuple i, computed the way "magnitude()" computes it
+	template <std::uint8_t _Size, typename _Scalar>
+	inline _Scalar magnitudeOf(const TupleComponents<_Size, _Scalar>& v, std::uint32_t i) {
+		using std::sqrt;
+		using std::abs;
+
+		if constexpr (_Size == 1)
+			return abs(v.component[0][i]);
+		else {
+			_Scalar sum = 0.;
+			for (std::uint8_t c = 0; c < _Size; c++)
+				sum += v.component[c][i] * v.component[c][i];
+			return sqrt(sum);
+		}
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void magnitudeScalar(const TupleComponents<_Size, _Scalar>& v, _Scalar* out, std::uint32_t begin, std::uint32_t end) {
+		for (std::uint32_t i = begin; i < end; i++)
+			out[i] = magnitudeOf(v, i);
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void unitScalar(const TupleComponents<_Size, _Scalar>& v, const TupleComponents<_Size, _Scalar>& out, std::uint32_t begin, std::uint32_t end) {
+		for (std::uint32_t i = begin; i < end; i++) {
+			const _Scalar mag = magnitudeOf(v, i);
+
+			if (mag > 0.) {
+				for (std::uint8_t c = 0; c < _Size; c++)
+					out.component[c][i] = v.component[c][i] / mag;
+			}
+			else {  // Let "unit()" warn and fake it
+				Tuple<_Size, _Scalar> zero_vector;
+				for (std::uint8_t c = 0; c < _Size; c++)
+					zero_vector[c] = v.component[c][i];
+				const Tuple<_Size, _Scalar> fallback = unit(zero_vector);
+				for (std::uint8_t c = 0; c < _Size; c++)
+					out.component[c][i] = fallback[c];
+			}
+		}
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	void projectionVectorScalar(const TupleComponents<_Size, _Scalar>& v1, const TupleComponents<_Size, _Scalar>& v2, const TupleComponents<_Size, _Scalar>& out,
+		std::uint32_t begin, std::uint32_t end) {
+		for (std::uint32_t i = begin; i < end; i++) {
+			_Scalar projection = 0., magnitude_squared = 0.;
+			for (std::uint8_t c = 0; c < _Size; c++) {
+				projection += v1.component[c][i] * v2.component[c][i];
+				magnitude_squared += v2.component[c][i] * v2.component[c][i];
+			}
+			const _Scalar scale = projection / magnitude_squared;
+
+			for (std::uint8_t c = 0; c < _Size; c++)
+				out.component[c][i] = v2.component[c][i] * scale;
+		}
+	}
+
+
+#ifdef BRAZEN_X86_SIMD
+	/*************AVX2 KERNELS************/
+	/*
+	Struct Avx2Ops - the AVX2 operations the batch kernels are written in, for one scalar type.
+	*/
+	template <typename _Scalar>
+	struct Avx2Ops {
+		static constexpr bool available = false;
+	};
+
+	template <>
+	struct Avx2Ops<double> {
+		typedef __m256d Vector;
+		static constexpr bool available = true;
+		static constexpr std::uint32_t WIDTH = 4;
+
+		static BRAZEN_TARGET("avx2") inline Vector load(const double* p) { return _mm256_loadu_pd(p); }
+		static BRAZEN_TARGET("avx2") inline void store(double* p, Vector a) { _mm256_storeu_pd(p, a); }
+		static BRAZEN_TARGET("avx2") inline Vector zero(void) { return _mm256_setzero_pd(); }
+		static BRAZEN_TARGET("avx2") inline Vector broadcast(double s) { return _mm256_set1_pd(s); }
+		static BRAZEN_TARGET("avx2") inline Vector add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+		static BRAZEN_TARGET("avx2") inline Vector mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+		static BRAZEN_TARGET("avx2") inline Vector div(Vector a, Vector b) { return _mm256_div_pd(a, b); }
+		static BRAZEN_TARGET("avx2") inline Vector sqrt(Vector a) { return _mm256_sqrt_pd(a); }
+		static BRAZEN_TARGET("avx2") inline Vector abs(Vector a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.), a); }
+		// Return true if any lane is not greater than zero, NaN included
+		static BRAZEN_TARGET("avx2") inline bool anyNotPositive(Vector a) { return _mm256_movemask_pd(_mm256_cmp_pd(a, zero(), _CMP_NGT_UQ)) != 0; }
+	};
+
+	template <>
+	struct Avx2Ops<float> {
+		typedef __m256 Vector;
+		static constexpr bool available = true;
+		static constexpr std::uint32_t WIDTH = 8;
+
+		static BRAZEN_TARGET("avx2") inline Vector load(const float* p) { return _mm256_loadu_ps(p); }
+		static BRAZEN_TARGET("avx2") inline void store(float* p, Vector a) { _mm256_storeu_ps(p, a); }
+		static BRAZEN_TARGET("avx2") inline Vector zero(void) { return _mm256_setzero_ps(); }
+		static BRAZEN_TARGET("avx2") inline Vector broadcast(float s) { return _mm256_set1_ps(s); }
+		static BRAZEN_TARGET("avx2") inline Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+		static BRAZEN_TARGET("avx2") inline Vector mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+		static BRAZEN_TARGET("avx2") inline Vector div(Vector a, Vector b) { return _mm256_div_ps(a, b); }
+		static BRAZEN_TARGET("avx2") inline Vector sqrt(Vector a) { return _mm256_sqrt_ps(a); }
+		static BRAZEN_TARGET("avx2") inline Vector abs(Vector a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+		static BRAZEN_TARGET("avx2") inline bool anyNotPositive(Vector a) { return _mm256_movemask_ps(_mm256_cmp_ps(a, zero(), _CMP_NGT_UQ)) != 0; }
+	};
+
+	template <typename _Scalar>
+	BRAZEN_TARGET("avx2") void axpyAvx2(_Scalar a, const _Scalar* x, _Scalar* y, std::uint32_t begin, std::uint32_t end) {
+		typedef Avx2Ops<_Scalar> Ops;
+		const typename Ops::Vector scale = Ops::broadcast(a);
+
+		std::uint32_t k = begin;
+		for (; k + Ops::WIDTH <= end; k += Ops::WIDTH)
+			Ops::store(y + k, Ops::add(Ops::load(y + k), Ops::mul(scale, Ops::load(x + k))));
+
+		axpyScalar(a, x, y, k, end);  // Leftover scalars
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	BRAZEN_TARGET("avx2") void dotAvx2(const TupleComponents<_Size, _Scalar>& v1, const TupleComponents<_Size, _Scalar>& v2, _Scalar* out, std::uint32_t begin, std::uint32_t end) {
+		typedef Avx2Ops<_Scalar> Ops;
+
+		std::uint32_t i = begin;
+		for (; i + Ops::WIDTH <= end; i += Ops::WIDTH) {
+			typename Ops::Vector sum = Ops::zero();
+			for (std::uint8_t c = 0; c < _Size; c++)
+				sum = Ops::add(sum, Ops::mul(Ops::load(v1.component[c] + i), Ops::load(v2.component[c] + i)));
+			Ops::store(out + i, sum);
+		}
+
+		dotScalar(v1, v2, out, i, end);  // Leftover tuples
+	}
+
+	// Magnitudes of tuples [i, i + WIDTH), computed the way "magnitude()" computes them
+	template <std::uint8_t _Size, typename _Scalar>
+	BRAZEN_TARGET("avx2") inline typename Avx2Ops<_Scalar>::Vector blockMagnitudeAvx2(const TupleComponents<_Size, _Scalar>& v, std::uint32_t i) {
+		typedef Avx2Ops<_Scalar> Ops;
+
+		if constexpr (_Size == 1)
+			return Ops::abs(Ops::load(v.component[0] + i));
+		else {
+			typename Ops::Vector sum = Ops::zero();
+			for (std::uint8_t c = 0; c < _Size; c++) {
+				typename Ops::Vector component = Ops::load(v.component[c] + i);
+				sum = Ops::add(sum, Ops::mul(component, component));
+			}
+			return Ops::sqrt(sum);
+		}
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	BRAZEN_TARGET("avx2") void magnitudeAvx2(const TupleComponents<_Size, _Scalar>& v, _Scalar* out, std::uint32_t begin, std::uint32_t end) {
+		typedef Avx2Ops<_Scalar> Ops;
+
+		std::uint32_t i = begin;
+		for (; i + Ops::WIDTH <= end; i += Ops::WIDTH)
+			Ops::store(out + i, blockMagnitudeAvx2(v, i));
+
+		magnitudeScalar(v, out, i, end);  // Leftover tuples
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	BRAZEN_TARGET("avx2") void unitAvx2(const TupleComponents<_Size, _Scalar>& v, const TupleComponents<_Size, _Scalar>& out, std::uint32_t begin, std::uint32_t end) {
+		typedef Avx2Ops<_Scalar> Ops;
+
+		std::uint32_t i = begin;
+		for (; i + Ops::WIDTH <= end; i += Ops::WIDTH) {
+			const typename Ops::Vector mag = blockMagnitudeAvx2(v, i);
+
+			if (Ops::anyNotPositive(mag)) {  // Rare: leave the zero vectors in this block to the portable kernel
+				unitScalar(v, out, i, i + Ops::WIDTH);
+				continue;
+			}
+			for (std::uint8_t c = 0; c < _Size; c++)
+				Ops::store(out.component[c] + i, Ops::div(Ops::load(v.component[c] + i), mag));
+		}
+
+		unitScalar(v, out, i, end);  // Leftover tuples
+	}
+
+	template <std::uint8_t _Size, typename _Scalar>
+	BRAZEN_TARGET("avx2") void projectionVectorAvx2(const TupleComponents<_Size, _Scalar>& v1, const TupleComponents<_Size, _Scalar>& v2, const TupleComponents<_Size, _Scalar>& out,
+		std::uint32_t begin, std::uint32_t end) {
+		typedef Avx2Ops<_Scalar> Ops;
+
+		std::uint32_t i = begin;
+		for (; i + Ops::WIDTH <= end; i += Ops::WIDTH) {
+			typename Ops::Vector projection = Ops::zero(), magnitude_squared = Ops::zero();
+			for (std::uint8_t c = 0; c < _Size; c++) {
+				typename Ops::Vector component = Ops::load(v2.component[c] + i);
+				projection = Ops::add(projection, Ops::mul(Ops::load(v1.component[c] + i), component));
+				magnitude_squared = Ops::add(magnitude_squared, Ops::mul(component, component));
+			}
+			const typename Ops::Vector scale = Ops::div(projection, magnitude_squared);
+
+			for (std::uint8_t c = 0; c < _Size; c++)
+				Ops::store(out.component[c] + i, Ops::mul(Ops::load(v2.component[c] + i), scale));
+		}
+
+		projectionVectorScalar(v1, v2, out, i, end);  // Leftover tuples
+	}
+#endif
+
+	// Return true if the AVX2 kernels exist for _Scalar and the given SIMD level can run them.
+	template <typename _Scalar>
+	inline bool useAvx2(SimdLevel level) {
+#ifdef BRAZEN_X86_SIMD
+		return Avx2Ops<_Scalar>::available && level != SimdLevel::SCALAR;
+#else
+		(void)level;
+		return false;
+#endif
+	}
+
+
+	/*************BATCH FUNCTIONS************/
+	// y[k] += a * x[k] for scalars [0, count)
+	template <typename _Scalar>
+	void axpyBatch(typename ScalarArgument<_Scalar>::type a, const _Scalar* x, _Scalar* y, std::uint32_t count, ThreadPool* pool, SimdLevel level) {
+		forEachTupleChunk(count, pool, [=](std::uint32_t begin, std::uint32_t end) {
+#ifdef BRAZEN_X86_SIMD
+			if constexpr (Avx2Ops<_Scalar>::available)
+				if (useAvx2<_Scalar>(level)) {
+					axpyAvx2(a, x, y, begin, end);
+					return;
+				}
+#endif
+			axpyScalar(a, x, y, begin, end);
+		});
+	}
+
+	// y[i] += a * x[i]
+	template <std::uint8_t _Size, typename _Scalar>
+	void axpyBatch(typename ScalarArgument<_Scalar>::type a, const Tuple<_Size, _Scalar>* x, Tuple<_Size, _Scalar>* y, std::uint32_t count,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		axpyBatch<_Scalar>(a, scalarsOf(x), scalarsOf(y), count * _Size, pool, level);
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	void axpyBatch(typename ScalarArgument<_Scalar>::type a, const TupleComponents<_Size, _Scalar>& x, const TupleComponents<_Size, _Scalar>& y, std::uint32_t count,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		for (std::uint8_t c = 0; c < _Size; c++)
+			axpyBatch<_Scalar>(a, x.component[c], y.component[c], count, pool, level);
+	}
+
+
+	// out[i] = dot(v1[i], v2[i])
+	template <std::uint8_t _Size, typename _Scalar>
+	void dotBatch(const Tuple<_Size, _Scalar>* v1, const Tuple<_Size, _Scalar>* v2, _Scalar* out, std::uint32_t count, ThreadPool* pool = nullptr) {
+		forEachTupleChunk(count, pool, [=](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++)
+				out[i] = dot(v1[i], v2[i]);
+		});
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	void dotBatch(const TupleComponents<_Size, _Scalar>& v1, const TupleComponents<_Size, _Scalar>& v2, _Scalar* out, std::uint32_t count,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		forEachTupleChunk(count, pool, [&](std::uint32_t begin, std::uint32_t end) {
+#ifdef BRAZEN_X86_SIMD
+			if constexpr (Avx2Ops<_Scalar>::available)
+				if (useAvx2<_Scalar>(level)) {
+					dotAvx2(v1, v2, out, begin, end);
+					return;
+				}
+#endif
+			dotScalar(v1, v2, out, begin, end);
+		});
+	}
+
+
+	// out[i] = magnitude(v[i])
+	template <std::uint8_t _Size, typename _Scalar>
+	void magnitudeBatch(const Tuple<_Size, _Scalar>* v, _Scalar* out, std::uint32_t count, ThreadPool* pool = nullptr) {
+		forEachTupleChunk(count, pool, [=](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++)
+				out[i] = magnitude(v[i]);
+		});
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	void magnitudeBatch(const TupleComponents<_Size, _Scalar>& v, _Scalar* out, std::uint32_t count,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		forEachTupleChunk(count, pool, [&](std::uint32_t begin, std::uint32_t end) {
+#ifdef BRAZEN_X86_SIMD
+			if constexpr (Avx2Ops<_Scalar>::available)
+				if (useAvx2<_Scalar>(level)) {
+					magnitudeAvx2(v, out, begin, end);
+					return;
+				}
+#endif
+			magnitudeScalar(v, out, begin, end);
+		});
+	}
+
+
+	// out[i] = unit(v[i])
+	template <std::uint8_t _Size, typename _Scalar>
+	void unitBatch(const Tuple<_Size, _Scalar>* v, Tuple<_Size, _Scalar>* out, std::uint32_t count, ThreadPool* pool = nullptr) {
+		forEachTupleChunk(count, pool, [=](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++)
+				out[i] = unit(v[i]);
+		});
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	void unitBatch(const TupleComponents<_Size, _Scalar>& v, const TupleComponents<_Size, _Scalar>& out, std::uint32_t count,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		forEachTupleChunk(count, pool, [&](std::uint32_t begin, std::uint32_t end) {
+#ifdef BRAZEN_X86_SIMD
+			if constexpr (Avx2Ops<_Scalar>::available)
+				if (useAvx2<_Scalar>(level)) {
+					unitAvx2(v, out, begin, end);
+					return;
+				}
+#endif
+			unitScalar(v, out, begin, end);
+		});
+	}
+
+
+	// out[i] = projection_vector(v1[i], v2[i])
+	template <std::uint8_t _Size, typename _Scalar>
+	void projectionVectorBatch(const Tuple<_Size, _Scalar>* v1, const Tuple<_Size, _Scalar>* v2, Tuple<_Size, _Scalar>* out, std::uint32_t count, ThreadPool* pool = nullptr) {
+		forEachTupleChunk(count, pool, [=](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++)
+				out[i] = projection_vector(v1[i], v2[i]);
+		});
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	void projectionVectorBatch(const TupleComponents<_Size, _Scalar>& v1, const TupleComponents<_Size, _Scalar>& v2, const TupleComponents<_Size, _Scalar>& out, std::uint32_t count,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		forEachTupleChunk(count, pool, [&](std::uint32_t begin, std::uint32_t end) {
+#ifdef BRAZEN_X86_SIMD
+			if constexpr (Avx2Ops<_Scalar>::available)
+				if (useAvx2<_Scalar>(level)) {
+					projectionVectorAvx2(v1, v2, out, begin, end);
+					return;
+				}
+#endif
+			projectionVectorScalar(v1, v2, out, begin, end);
+		});
+	}
+
+
+	/*************RANDOM UNIT VECTORS************/
+	/*
+	Batch equivalent of "random_unit()": fills tuples [0, count) with random unit vectors, uniformly distributed over
+	the unit N-sphere, from a seed instead of a shared generator.
+
+	Every tuple normalizes _Size normally distributed components, made in pairs with the Box-Muller transform
+	(a 1-tuple just takes a random sign). Tuples are generated 4 at a time, one per lane of 4 xorshift128+
+	generators, which are reseeded from "seed" every TUPLE_BATCH_CHUNK tuples, so the same seed gives the same
+	vectors whether or not the work is split across a ThreadPool. The AVX2 kernel evaluates the logarithm, sine
+	and cosine with its own polynomials, which differ from the portable kernel's std::log, std::sin and std::cos
+	in the last bits, so the two kernels agree to about 1e-14 rather than exactly. Vectors are generated in double
+	precision and converted to _Scalar.
+	*/
+	struct RandomLanes {
+		static constexpr std::uint32_t LANES = 4;
+
+		std::uint64_t state[2][LANES];  // xorshift128+ state words, lane-major so each word is one AVX2 vector
+
+		// Seed every lane from the given seed and stream number with splitmix64.
+		RandomLanes(std::uint64_t seed, std::uint64_t stream) {
+			std::uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+			for (std::uint32_t w = 0; w < 2; w++)
+				for (std::uint32_t lane = 0; lane < LANES; lane++) {
+					std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+					z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+					z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+					state[w][lane] = z ^ (z >> 31);
+				}
+		}
+
+		// Return the next 64 random bits of the given lane.
+		std::uint64_t next(std::uint32_t lane) {
+			std::uint64_t s1 = state[0][lane];
+			const std::uint64_t s0 = state[1][lane];
+			state[0][lane] = s0;
+			s1 ^= s1 << 23;
+			state[1][lane] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+			return state[1][lane] + s0;
+		}
+	};
+
+	// Return the top 52 of the given bits as a double uniformly distributed on [1, 2).
+	inline double uniformOneToTwo(std::uint64_t bits) {
+		bits = (bits >> 12) | 0x3FF0000000000000ull;
+		double out;
+		std::memcpy(&out, &bits, sizeof(double));
+		return out;
+	}
+
+	// Component c of tuple i of a structure-of-arrays view or an array of Tuple.
+	template <std::uint8_t _Size, typename _Scalar>
+	inline _Scalar& componentOf(const TupleComponents<_Size, _Scalar>& v, std::uint32_t i, std::uint8_t c) {
+		return v.component[c][i];
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	inline _Scalar& componentOf(Tuple<_Size, _Scalar>* v, std::uint32_t i, std::uint8_t c) {
+		return v[i][c];
+	}
+
+	// Generate tuples [begin, end) with the portable kernel, tuple i drawing from lane i % 4.
+	template <std::uint8_t _Size, typename _Scalar, typename OutView>
+	void randomUnitScalar(RandomLanes& lanes, const OutView& out, std::uint32_t begin, std::uint32_t end) {
+		const double TWO_PI = 6.283185307179586;
+
+		for (std::uint32_t i = begin; i < end; i++) {
+			const std::uint32_t lane = (i - begin) % RandomLanes::LANES;
+			double components[_Size];
+
+			if constexpr (_Size == 1)
+				components[0] = (lanes.next(lane) >> 63) ? -1. : 1.;
+			else {
+				for (std::uint8_t c = 0; c < _Size; c += 2) {
+					// (0, 1) keeps the logarithm finite and the radius nonzero
+					const double u = (uniformOneToTwo(lanes.next(lane)) - 1.) + 0x1p-53;
+					const double angle = TWO_PI * (uniformOneToTwo(lanes.next(lane)) - 1.);
+					const double radius = std::sqrt(-2. * std::log(u));
+
+					components[c] = radius * std::cos(angle);
+					if (c + 1 < _Size)
+						components[c + 1] = radius * std::sin(angle);
+				}
+
+				double sum = 0.;
+				for (std::uint8_t c = 0; c < _Size; c++)
+					sum += components[c] * components[c];
+				const double mag = std::sqrt(sum);
+				for (std::uint8_t c = 0; c < _Size; c++)
+					components[c] /= mag;
+			}
+
+			for (std::uint8_t c = 0; c < _Size; c++)
+				componentOf(out, i, c) = static_cast<_Scalar>(components[c]);
+		}
+	}
+
+#ifdef BRAZEN_X86_SIMD
+	// Return the next 64 random bits of all 4 lanes, whose state is held in s0 and s1.
+	BRAZEN_TARGET("avx2") inline __m256i nextRandomAvx2(__m256i& s0, __m256i& s1) {
+		__m256i x = s0;
+		const __m256i y = s1;
+		s0 = y;
+		x = _mm256_xor_si256(x, _mm256_slli_epi64(x, 23));
+		s1 = _mm256_xor_si256(_mm256_xor_si256(x, y), _mm256_xor_si256(_mm256_srli_epi64(x, 17), _mm256_srli_epi64(y, 26)));
+		return _mm256_add_epi64(s1, y);
+	}
+
+	// The top 52 of the given bits as doubles uniformly distributed on [1, 2)
+	BRAZEN_TARGET("avx2") inline __m256d uniformOneToTwoAvx2(__m256i bits) {
+		return _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 12), _mm256_set1_epi64x(0x3FF0000000000000ll)));
+	}
+
+	// Natural logarithm of positive, normal doubles, to within a few units in the last place.
+	//	log(x) = e * log(2) + log(m) for x = m * 2^e with m in [sqrt(1/2), sqrt(2)), and
+	//	log(m) = 2 * atanh(s) = 2 * (s + s^3 / 3 + s^5 / 5 + ...) with s = (m - 1) / (m + 1), |s| < .172
+	BRAZEN_TARGET("avx2") inline __m256d logAvx2(__m256d x) {
+		const __m256d one = _mm256_set1_pd(1.);
+		const __m256i bits = _mm256_castpd_si256(x);
+
+		// Biased exponent to double without 64-bit conversions: 2^52 + e as bits, minus 2^52
+		__m256d exponent = _mm256_sub_pd(
+			_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(_mm256_set1_pd(0x1p52)))),
+			_mm256_set1_pd(0x1p52 + 1023.));
+		__m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFll)), _mm256_castpd_si256(one)));
+
+		// Move m from [1, 2) to [sqrt(1/2), sqrt(2))
+		const __m256d high = _mm256_cmp_pd(m, _mm256_set1_pd(1.4142135623730951), _CMP_GT_OQ);
+		m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(.5)), high);
+		exponent = _mm256_add_pd(exponent, _mm256_and_pd(high, one));
+
+		const __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one)), s2 = _mm256_mul_pd(s, s);
+		__m256d series = _mm256_set1_pd(1. / 23.);
+		for (int k = 21; k >= 1; k -= 2)
+			series = _mm256_add_pd(_mm256_mul_pd(series, s2), _mm256_set1_pd(1. / k));
+		const __m256d log_m = _mm256_mul_pd(_mm256_add_pd(s, s), series);
+
+		// log(2) split in two, so e * log(2) keeps full precision
+		return _mm256_add_pd(_mm256_mul_pd(exponent, _mm256_set1_pd(6.93147180369123816490e-01)),
+			_mm256_add_pd(_mm256_mul_pd(exponent, _mm256_set1_pd(1.90821492927058770002e-10)), log_m));
+	}
+
+	// Sine and cosine of 2 * pi * t for t in [0, 1), to within a few units in the last place.
+	//	With t = (q + f) / 4 for the nearest integer q, the angle is q quarter turns plus x = f * pi / 2 in [-pi / 4, pi / 4],
+	//	whose sine and cosine are Taylor series; q picks which is which and their signs.
+	BRAZEN_TARGET("avx2") inline void sinCosTurnsAvx2(__m256d t, __m256d& sin_out, __m256d& cos_out) {
+		const __m256d quarters = _mm256_mul_pd(t, _mm256_set1_pd(4.));
+		const __m256d q = _mm256_round_pd(quarters, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		const __m256d x = _mm256_mul_pd(_mm256_sub_pd(quarters, q), _mm256_set1_pd(1.5707963267948966)), x2 = _mm256_mul_pd(x, x);
+
+		__m256d sin_series = _mm256_set1_pd(-1. / 1307674368000.);  // -1 / 15!
+		const double SIN_COEFFICIENTS[] = { 1. / 6227020800., -1. / 39916800., 1. / 362880., -1. / 5040., 1. / 120., -1. / 6., 1. };
+		for (double coefficient : SIN_COEFFICIENTS)
+			sin_series = _mm256_add_pd(_mm256_mul_pd(sin_series, x2), _mm256_set1_pd(coefficient));
+		const __m256d sin_x = _mm256_mul_pd(sin_series, x);
+
+		__m256d cos_x = _mm256_set1_pd(1. / 20922789888000.);  // 1 / 16!
+		const double COS_COEFFICIENTS[] = { -1. / 87178291200., 1. / 479001600., -1. / 3628800., 1. / 40320., -1. / 720., 1. / 24., -1. / 2., 1. };
+		for (double coefficient : COS_COEFFICIENTS)
+			cos_x = _mm256_add_pd(_mm256_mul_pd(cos_x, x2), _mm256_set1_pd(coefficient));
+
+		// Integer q in the low bits: odd q swaps sine and cosine, bit 1 of q (of q + 1) negates the sine (cosine)
+		const __m256i q_bits = _mm256_castpd_si256(_mm256_add_pd(q, _mm256_set1_pd(0x1p52)));
+		const __m256d swap = _mm256_castsi256_pd(_mm256_slli_epi64(q_bits, 63));
+		const __m256d sin_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_srli_epi64(q_bits, 1), 63));
+		const __m256d cos_sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_srli_epi64(_mm256_add_epi64(q_bits, _mm256_set1_epi64x(1)), 1), 63));
+
+		sin_out = _mm256_xor_pd(_mm256_blendv_pd(sin_x, cos_x, swap), sin_sign);
+		cos_out = _mm256_xor_pd(_mm256_blendv_pd(cos_x, sin_x, swap), cos_sign);
+	}
+
+	// Store the 4 lanes of "a" as component c of tuples [i, i + 4).
+	template <std::uint8_t _Size, typename _Scalar, typename OutView>
+	BRAZEN_TARGET("avx2") inline void storeComponentAvx2(const OutView& out, std::uint32_t i, std::uint8_t c, __m256d a) {
+		if constexpr (std::is_same<OutView, TupleComponents<_Size, double> >::value)
+			_mm256_storeu_pd(out.component[c] + i, a);
+		else {
+			alignas(32) double lanes[4];
+			_mm256_store_pd(lanes, a);
+			for (std::uint32_t k = 0; k < 4; k++)
+				componentOf(out, i + k, c) = static_cast<_Scalar>(lanes[k]);
+		}
+	}
+
+	// Generate tuples [begin, end) with the AVX2 kernel: the same algorithm as "randomUnitScalar()," 4 tuples at a time.
+	template <std::uint8_t _Size, typename _Scalar, typename OutView>
+	BRAZEN_TARGET("avx2") void randomUnitAvx2(RandomLanes& lanes, const OutView& out, std::uint32_t begin, std::uint32_t end) {
+		__m256i s0 = _mm256_loadu_si256((const __m256i*)lanes.state[0]), s1 = _mm256_loadu_si256((const __m256i*)lanes.state[1]);
+		const __m256d one = _mm256_set1_pd(1.);
+
+		std::uint32_t i = begin;
+		for (; i + RandomLanes::LANES <= end; i += RandomLanes::LANES) {
+			__m256d components[_Size];
+
+			if constexpr (_Size == 1)  // Random sign
+				components[0] = _mm256_or_pd(one, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_srli_epi64(nextRandomAvx2(s0, s1), 63), 63)));
+			else {
+				for (std::uint8_t c = 0; c < _Size; c += 2) {
+					const __m256d u = _mm256_add_pd(_mm256_sub_pd(uniformOneToTwoAvx2(nextRandomAvx2(s0, s1)), one), _mm256_set1_pd(0x1p-53));
+					const __m256d t = _mm256_sub_pd(uniformOneToTwoAvx2(nextRandomAvx2(s0, s1)), one);
+					const __m256d radius = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_set1_pd(-2.), logAvx2(u)));
+
+					__m256d sin_t, cos_t;
+					sinCosTurnsAvx2(t, sin_t, cos_t);
+					components[c] = _mm256_mul_pd(radius, cos_t);
+					if (c + 1 < _Size)
+						components[c + 1] = _mm256_mul_pd(radius, sin_t);
+				}
+
+				__m256d sum = _mm256_setzero_pd();
+				for (std::uint8_t c = 0; c < _Size; c++)
+					sum = _mm256_add_pd(sum, _mm256_mul_pd(components[c], components[c]));
+				const __m256d mag = _mm256_sqrt_pd(sum);
+				for (std::uint8_t c = 0; c < _Size; c++)
+					components[c] = _mm256_div_pd(components[c], mag);
+			}
+
+			for (std::uint8_t c = 0; c < _Size; c++)
+				storeComponentAvx2<_Size, _Scalar>(out, i, c, components[c]);
+		}
+
+		_mm256_storeu_si256((__m256i*)lanes.state[0], s0);
+		_mm256_storeu_si256((__m256i*)lanes.state[1], s1);
+
+		randomUnitScalar<_Size, _Scalar>(lanes, out, i, end);  // Leftover tuples
+	}
+#endif
+
+	// Generate tuples [begin, end), where "begin" is a multiple of TUPLE_BATCH_CHUNK.
+	template <std::uint8_t _Size, typename _Scalar, typename OutView>
+	void randomUnitRange(const OutView& out, std::uint64_t seed, std::uint32_t begin, std::uint32_t end, SimdLevel level) {
+		for (std::uint32_t chunk_begin = begin; chunk_begin < end; chunk_begin += TUPLE_BATCH_CHUNK) {
+			const std::uint32_t chunk_end = std::min(end, chunk_begin + TUPLE_BATCH_CHUNK);
+			RandomLanes lanes(seed, chunk_begin / TUPLE_BATCH_CHUNK);
+
+#ifdef BRAZEN_X86_SIMD
+			if (level != SimdLevel::SCALAR) {
+				randomUnitAvx2<_Size, _Scalar>(lanes, out, chunk_begin, chunk_end);
+				continue;
+			}
+#endif
+			(void)level;
+			randomUnitScalar<_Size, _Scalar>(lanes, out, chunk_begin, chunk_end);
+		}
+	}
+
+	// out[i] = a random unit vector, for i in [0, count)
+	template <std::uint8_t _Size, typename _Scalar>
+	void randomUnitBatch(Tuple<_Size, _Scalar>* out, std::uint32_t count, std::uint64_t seed,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		forEachTupleChunk(count, pool, [=](std::uint32_t begin, std::uint32_t end) {
+			randomUnitRange<_Size, _Scalar>(out, seed, begin, end, level);
+		});
+	}
+	template <std::uint8_t _Size, typename _Scalar>
+	void randomUnitBatch(const TupleComponents<_Size, _Scalar>& out, std::uint32_t count, std::uint64_t seed,
+		ThreadPool* pool = nullptr, SimdLevel level = simdLevel()) {
+		forEachTupleChunk(count, pool, [&](std::uint32_t begin, std::uint32_t end) {
+			randomUnitRange<_Size, _Scalar>(out, seed, begin, end, level);
+		});
+	}
+}
+
+#endif
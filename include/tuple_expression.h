@@ -0,0 +1,330 @@
+/*
+//
+// tuple_expression.h
+//
+// Author: Weston Cook
+//
+// Distributed under the Mozilla Public Lincence 2.0
+//
+// Description:
+//	Defines expression templates for Tuple arithmetic, so chains of additions, subtractions,
+//		and scalings evaluate in a single pass without materializing intermediate Tuples.
+//
+*/
+
+#ifndef BRAZEN_TUPLE_EXPRESSION_H
+#define BRAZEN_TUPLE_EXPRESSION_H
+
+#include "tuple.h"
+#include <cstdint>  // std::uint8_t
+#include <utility>  // std::integer_sequence, std::make_integer_sequence
+
+
+/*
+//
+// Expression templates are opt-in: wrap an operand in "lazy()" and the operators build an expression
+//	instead of a Tuple. The expression is only evaluated when it is assigned to (or added to) a Tuple,
+//	with the loop over the components unrolled at compile time, so
+//
+//		pos += lazy(vel) * dt + lazy(F) * (invMass * dt * dt);
+//
+//	compiles to straight-line (and vectorizable) code with no temporaries. Every component is computed with
+//	the same operations in the same order as the eager operators, so results match to within rounding. They
+//	are bit-for-bit identical only if the compiler contracts neither into fused multiply-adds
+//	(-ffp-contract=off); GCC contracts by default when targeting FMA, and may do so differently in each.
+//
+// WARNING: Expressions hold references to the Tuples they were built from. Evaluate them in the
+//	statement that builds them rather than keeping them in "auto" variables.
+//
+*/
+
+/*************COMPONENT ACCESS***********/
+// Unchecked component access, shared by the generic Tuple and the specializations.
+//	With a constant index the specializations' branches fold away.
+template <std::uint8_t _Size, typename _Scalar>
+inline _Scalar& element(Tuple<_Size, _Scalar>& v, std::uint8_t i) {
+	return v.value[i];
+}
+template <std::uint8_t _Size, typename _Scalar>
+inline _Scalar element(const Tuple<_Size, _Scalar>& v, std::uint8_t i) {
+	return v.value[i];
+}
+
+template <typename _Scalar>
+inline _Scalar& element(Tuple<2, _Scalar>& v, std::uint8_t i) {
+	return i == 0 ? v.x : v.y;
+}
+template <typename _Scalar>
+inline _Scalar element(const Tuple<2, _Scalar>& v, std::uint8_t i) {
+	return i == 0 ? v.x : v.y;
+}
+
+template <typename _Scalar>
+inline _Scalar& element(Tuple<3, _Scalar>& v, std::uint8_t i) {
+	return i == 0 ? v.x : (i == 1 ? v.y : v.z);
+}
+template <typename _Scalar>
+inline _Scalar element(const Tuple<3, _Scalar>& v, std::uint8_t i) {
+	return i == 0 ? v.x : (i == 1 ? v.y : v.z);
+}
+
+
+/*
+//
+// Struct TupleExpression - base of every expression node, which evaluates to a Tuple<_Size, _Scalar>.
+//	_Expr is the node type, which defines "_Scalar component(std::uint8_t i) const."
+//
+*/
+template <typename _Expr, std::uint8_t _Size, typename _Scalar>
+struct TupleExpression {
+	// Return component i of the expression's value
+	_Scalar operator[](std::uint8_t i) const {
+		return static_cast<const _Expr&>(*this).component(i);
+	}
+
+	// Evaluate the expression
+	operator Tuple<_Size, _Scalar>(void) const {
+		Tuple<_Size, _Scalar> out(false);
+		assignTo(out, std::make_integer_sequence<std::uint8_t, _Size>());
+
+		return out;
+	}
+
+	// Write every component into "v." The components are unrolled at compile time rather than looped
+	//	over, so the whole expression becomes straight-line code the compiler can vectorize.
+	template <std::uint8_t... _I>
+	void assignTo(Tuple<_Size, _Scalar>& v, std::integer_sequence<std::uint8_t, _I...>) const {
+		const _Scalar values[_Size] = { (*this)[_I]... };  // Read every operand before writing, in case "v" is one of them
+		((element(v, _I) = values[_I]), ...);
+	}
+	template <std::uint8_t... _I>
+	void addTo(Tuple<_Size, _Scalar>& v, std::integer_sequence<std::uint8_t, _I...>) const {
+		const _Scalar values[_Size] = { (*this)[_I]... };
+		((element(v, _I) += values[_I]), ...);
+	}
+	template <std::uint8_t... _I>
+	void subtractFrom(Tuple<_Size, _Scalar>& v, std::integer_sequence<std::uint8_t, _I...>) const {
+		const _Scalar values[_Size] = { (*this)[_I]... };
+		((element(v, _I) -= values[_I]), ...);
+	}
+};
+
+
+/*
+//
+// Expression nodes. Leaves refer to a Tuple; every other node holds its operands by value, which
+//	are themselves small nodes.
+//
+*/
+template <std::uint8_t _Size, typename _Scalar>
+struct TupleLeaf : public TupleExpression<TupleLeaf<_Size, _Scalar>, _Size, _Scalar> {
+	const Tuple<_Size, _Scalar>& v;
+
+	TupleLeaf(const Tuple<_Size, _Scalar>& v) :
+		v(v)
+	{}
+
+	_Scalar component(std::uint8_t i) const { return element(v, i); }
+};
+
+template <typename _A, typename _B, std::uint8_t _Size, typename _Scalar>
+struct TupleSum : public TupleExpression<TupleSum<_A, _B, _Size, _Scalar>, _Size, _Scalar> {
+	_A a;
+	_B b;
+
+	TupleSum(const _A& a, const _B& b) :
+		a(a), b(b)
+	{}
+
+	_Scalar component(std::uint8_t i) const { return a[i] + b[i]; }
+};
+
+template <typename _A, typename _B, std::uint8_t _Size, typename _Scalar>
+struct TupleDifference : public TupleExpression<TupleDifference<_A, _B, _Size, _Scalar>, _Size, _Scalar> {
+	_A a;
+	_B b;
+
+	TupleDifference(const _A& a, const _B& b) :
+		a(a), b(b)
+	{}
+
+	_Scalar component(std::uint8_t i) const { return a[i] - b[i]; }
+};
+
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+struct TupleProduct : public TupleExpression<TupleProduct<_A, _Size, _Scalar>, _Size, _Scalar> {
+	_A a;
+	_Scalar s;
+
+	TupleProduct(const _A& a, _Scalar s) :
+		a(a), s(s)
+	{}
+
+	_Scalar component(std::uint8_t i) const { return a[i] * s; }
+};
+
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+struct TupleQuotient : public TupleExpression<TupleQuotient<_A, _Size, _Scalar>, _Size, _Scalar> {
+	_A a;
+	_Scalar s;
+
+	TupleQuotient(const _A& a, _Scalar s) :
+		a(a), s(s)
+	{}
+
+	_Scalar component(std::uint8_t i) const { return a[i] / s; }
+};
+
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+struct TupleNegation : public TupleExpression<TupleNegation<_A, _Size, _Scalar>, _Size, _Scalar> {
+	_A a;
+
+	TupleNegation(const _A& a) :
+		a(a)
+	{}
+
+	_Scalar component(std::uint8_t i) const { return -a[i]; }
+};
+
+
+/*************ASSIGNMENT***********/
+// Evaluate straight into the Tuple rather than through a temporary
+template <std::uint8_t _Size, typename _Scalar>
+template <typename _Expr>
+const Tuple<_Size, _Scalar>& Tuple<_Size, _Scalar>::operator=(const TupleExpression<_Expr, _Size, _Scalar>& e) {
+	e.assignTo(*this, std::make_integer_sequence<std::uint8_t, _Size>());
+
+	return *this;
+}
+
+template <typename _Scalar>
+template <typename _Expr>
+const Tuple<2, _Scalar>& Tuple<2, _Scalar>::operator=(const TupleExpression<_Expr, 2, _Scalar>& e) {
+	e.assignTo(*this, std::make_integer_sequence<std::uint8_t, 2>());
+
+	return *this;
+}
+
+template <typename _Scalar>
+template <typename _Expr>
+const Tuple<3, _Scalar>& Tuple<3, _Scalar>::operator=(const TupleExpression<_Expr, 3, _Scalar>& e) {
+	e.assignTo(*this, std::make_integer_sequence<std::uint8_t, 3>());
+
+	return *this;
+}
+
+
+/*************EXPRESSION HELPER FUNCTIONS***********/
+// Start an expression from a Tuple
+template <std::uint8_t _Size, typename _Scalar>
+inline TupleLeaf<_Size, _Scalar> lazy(const Tuple<_Size, _Scalar>& v) {
+	return TupleLeaf<_Size, _Scalar>(v);
+}
+
+
+// SCALAR VECTOR MULTIPLICATION
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline TupleProduct<_A, _Size, _Scalar> operator*(const TupleExpression<_A, _Size, _Scalar>& a, typename ScalarArgument<_Scalar>::type s) {
+	return TupleProduct<_A, _Size, _Scalar>(static_cast<const _A&>(a), s);
+}
+
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline TupleProduct<_A, _Size, _Scalar> operator*(typename ScalarArgument<_Scalar>::type s, const TupleExpression<_A, _Size, _Scalar>& a) {
+	return TupleProduct<_A, _Size, _Scalar>(static_cast<const _A&>(a), s);
+}
+
+
+// SCALAR VECTOR DIVISION
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline TupleQuotient<_A, _Size, _Scalar> operator/(const TupleExpression<_A, _Size, _Scalar>& a, typename ScalarArgument<_Scalar>::type s) {
+	return TupleQuotient<_A, _Size, _Scalar>(static_cast<const _A&>(a), s);
+}
+
+
+// NEGATION
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline TupleNegation<_A, _Size, _Scalar> operator-(const TupleExpression<_A, _Size, _Scalar>& a) {
+	return TupleNegation<_A, _Size, _Scalar>(static_cast<const _A&>(a));
+}
+
+
+// VECTOR ADDITION
+template <typename _A, typename _B, std::uint8_t _Size, typename _Scalar>
+inline TupleSum<_A, _B, _Size, _Scalar> operator+(const TupleExpression<_A, _Size, _Scalar>& a, const TupleExpression<_B, _Size, _Scalar>& b) {
+	return TupleSum<_A, _B, _Size, _Scalar>(static_cast<const _A&>(a), static_cast<const _B&>(b));
+}
+
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline TupleSum<_A, TupleLeaf<_Size, _Scalar>, _Size, _Scalar> operator+(const TupleExpression<_A, _Size, _Scalar>& a, const Tuple<_Size, _Scalar>& b) {
+	return TupleSum<_A, TupleLeaf<_Size, _Scalar>, _Size, _Scalar>(static_cast<const _A&>(a), TupleLeaf<_Size, _Scalar>(b));
+}
+
+template <typename _B, std::uint8_t _Size, typename _Scalar>
+inline TupleSum<TupleLeaf<_Size, _Scalar>, _B, _Size, _Scalar> operator+(const Tuple<_Size, _Scalar>& a, const TupleExpression<_B, _Size, _Scalar>& b) {
+	return TupleSum<TupleLeaf<_Size, _Scalar>, _B, _Size, _Scalar>(TupleLeaf<_Size, _Scalar>(a), static_cast<const _B&>(b));
+}
+
+
+// VECTOR SUBTRACTION
+template <typename _A, typename _B, std::uint8_t _Size, typename _Scalar>
+inline TupleDifference<_A, _B, _Size, _Scalar> operator-(const TupleExpression<_A, _Size, _Scalar>& a, const TupleExpression<_B, _Size, _Scalar>& b) {
+	return TupleDifference<_A, _B, _Size, _Scalar>(static_cast<const _A&>(a), static_cast<const _B&>(b));
+}
+
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline TupleDifference<_A, TupleLeaf<_Size, _Scalar>, _Size, _Scalar> operator-(const TupleExpression<_A, _Size, _Scalar>& a, const Tuple<_Size, _Scalar>& b) {
+	return TupleDifference<_A, TupleLeaf<_Size, _Scalar>, _Size, _Scalar>(static_cast<const _A&>(a), TupleLeaf<_Size, _Scalar>(b));
+}
+
+template <typename _B, std::uint8_t _Size, typename _Scalar>
+inline TupleDifference<TupleLeaf<_Size, _Scalar>, _B, _Size, _Scalar> operator-(const Tuple<_Size, _Scalar>& a, const TupleExpression<_B, _Size, _Scalar>& b) {
+	return TupleDifference<TupleLeaf<_Size, _Scalar>, _B, _Size, _Scalar>(TupleLeaf<_Size, _Scalar>(a), static_cast<const _B&>(b));
+}
+
+
+// DOT PRODUCT
+template <typename _A, typename _B, std::uint8_t _Size, typename _Scalar>
+inline _Scalar dot(const TupleExpression<_A, _Size, _Scalar>& a, const TupleExpression<_B, _Size, _Scalar>& b) {
+	_Scalar sum = 0.;
+
+	for (std::uint8_t i = 0; i < _Size; i++)
+		sum += a[i] * b[i];
+
+	return sum;
+}
+
+
+// MAGNITUDE
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline _Scalar magnitudeSquared(const TupleExpression<_A, _Size, _Scalar>& a) {
+	_Scalar sum = 0.;
+
+	for (std::uint8_t i = 0; i < _Size; i++) {
+		_Scalar component = a[i];
+		sum += component * component;
+	}
+
+	return sum;
+}
+
+
+/***************IN PLACE OPERATIONS***************/
+// VECTOR ADDITION
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline Tuple<_Size, _Scalar>& operator+=(Tuple<_Size, _Scalar>& v, const TupleExpression<_A, _Size, _Scalar>& a) {
+	a.addTo(v, std::make_integer_sequence<std::uint8_t, _Size>());
+
+	return v;
+}
+
+
+// VECTOR SUBTRACTION
+template <typename _A, std::uint8_t _Size, typename _Scalar>
+inline Tuple<_Size, _Scalar>& operator-=(Tuple<_Size, _Scalar>& v, const TupleExpression<_A, _Size, _Scalar>& a) {
+	a.subtractFrom(v, std::make_integer_sequence<std::uint8_t, _Size>());
+
+	return v;
+}
+
+
+#endif
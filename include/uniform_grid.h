@@ -0,0 +1,133 @@
+// uniform_grid.h
+// Written by Weston Cook
+// Defines the class UniformGrid
+
+#ifndef BRAZEN_UNIFORM_GRID_H
+#define BRAZEN_UNIFORM_GRID_H
+
+#include "aabb.h"
+#include <vector>  // std::vector
+#include <utility>  // std::pair
+#include <algorithm>  // std::sort, std::unique
+#include <cmath>  // std::floor
+#include <cstdint>  // std::uint8_t, std::uint32_t, std::int64_t, std::uint64_t
+
+namespace Brazen {
+	/*
+	Class UniformGrid - broad phase that finds overlapping boxes by hashing them into a uniform N-dimensional grid.
+
+	Each box is entered into every cell it touches, keyed by a hash of the cell's integer coordinates.
+	Sorting the entries by hash groups boxes that share a cell, and only boxes sharing a cell are tested
+	against each other. Boxes that would touch too many cells (much larger than the cell size) are kept
+	in a separate list and tested against every box instead.
+
+	All storage is reused between calls, so a steady-state scene performs no allocations.
+	*/
+	template <std::uint8_t _Size>
+	class UniformGrid {
+	private:
+		// ATTRIBUTES
+		static constexpr std::uint32_t MAX_CELLS_PER_BOX = 64;  // Boxes touching more cells than this go into "oversized"
+
+		double cell_size;  // Side length of a grid cell, or 0 to pick one automatically on every call
+		std::vector<std::pair<std::uint64_t, std::uint32_t> > entries;  // (cell hash, box index) for every cell touched by every box
+		std::vector<std::uint32_t> oversized;  // Indices of boxes that are tested against every box
+		std::vector<BoxPair> pairs;  // Output of the last call to "findPairs()"
+
+		// Add an entry for every cell touched by the box with the given index.
+		void insert(const AABB<_Size>& box, std::uint32_t index, double size);
+	public:
+		// CONSTRUCTORS
+		UniformGrid(double cell_size = 0.) :
+			cell_size(cell_size)
+		{}
+
+		// MEMBER FUNCTIONS
+		// Set the side length of a grid cell. 0 picks twice the mean largest box extent on every call.
+		void setCellSize(double size) { cell_size = size; }
+
+		// Return every pair of overlapping boxes, each once, sorted. The reference stays valid until the next call.
+		const std::vector<BoxPair>& findPairs(const std::vector<AABB<_Size> >& boxes);
+	};
+
+
+	template <std::uint8_t _Size>
+	void UniformGrid<_Size>::insert(const AABB<_Size>& box, std::uint32_t index, double size) {
+		std::int64_t low[_Size], high[_Size], cell[_Size];
+		std::uint64_t cell_count = 1;
+
+		// Check every span before multiplying it in, so the count cannot overflow however large the box or however
+		//	many axes it spans
+		for (std::uint8_t i = 0; i < _Size; i++) {
+			const double first = std::floor(box.min[i] / size), last = std::floor(box.max[i] / size);
+			if (!(last - first < MAX_CELLS_PER_BOX) || cell_count * (std::uint64_t)(last - first + 1.) > MAX_CELLS_PER_BOX) {
+				oversized.push_back(index);  // Also catches NaN and infinite bounds
+				return;
+			}
+			low[i] = cell[i] = (std::int64_t)first;
+			high[i] = (std::int64_t)last;
+			cell_count *= high[i] - low[i] + 1;
+		}
+
+		// Visit every cell in [low, high] like an odometer
+		for (std::uint64_t c = 0; c < cell_count; c++) {
+			std::uint64_t hash = 0;
+			for (std::uint8_t i = 0; i < _Size; i++)
+				hash = hash * 0x9E3779B97F4A7C15ull + (std::uint64_t)cell[i];
+			entries.push_back(std::make_pair(hash, index));
+
+			for (std::uint8_t i = 0; i < _Size && ++cell[i] > high[i]; i++)
+				cell[i] = low[i];
+		}
+	}
+
+	template <std::uint8_t _Size>
+	const std::vector<BoxPair>& UniformGrid<_Size>::findPairs(const std::vector<AABB<_Size> >& boxes) {
+		entries.clear();
+		oversized.clear();
+		pairs.clear();
+		if (boxes.empty())
+			return pairs;
+
+		// Pick the cell size
+		double size = cell_size;
+		if (size <= 0.) {
+			for (const AABB<_Size>& box : boxes)
+				size += box.largestExtent();
+			size = 2. * size / boxes.size();
+			if (size <= 0.)
+				size = 1.;  // Every box is a point
+		}
+
+		// Hash every box into the grid and group the entries by cell
+		for (std::uint32_t b = 0; b < boxes.size(); b++)
+			insert(boxes[b], b, size);
+		std::sort(entries.begin(), entries.end());
+
+		// Test the boxes that share a cell against each other
+		for (std::size_t run = 0, end; run < entries.size(); run = end) {
+			for (end = run + 1; end < entries.size() && entries[end].first == entries[run].first; end++);
+
+			for (std::size_t i = run; i < end; i++)
+				for (std::size_t j = i + 1; j < end; j++) {
+					std::uint32_t a = entries[i].second, b = entries[j].second;  // a < b since entries are sorted
+					if (a != b && boxes[a].overlaps(boxes[b]))
+						pairs.push_back(BoxPair(a, b));
+				}
+		}
+
+		// Test oversized boxes against every box
+		for (std::uint32_t a : oversized)
+			for (std::uint32_t b = 0; b < boxes.size(); b++)
+				if (a != b && boxes[a].overlaps(boxes[b]))
+					pairs.push_back(BoxPair(std::min(a, b), std::max(a, b)));
+
+		// Boxes sharing several cells (and oversized boxes) produce duplicates
+		std::sort(pairs.begin(), pairs.end());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+		return pairs;
+	}
+}
+
+#endif
@@ -0,0 +1,141 @@
+// validation.h
+// Written by Weston Cook
+// Defines the enum ErrorCode, the class ValidationError and the template class Result
+
+#ifndef BRAZEN_VALIDATION_H
+#define BRAZEN_VALIDATION_H
+
+#include <stdexcept>  // std::runtime_error
+#include <utility>  // std::move
+
+namespace Brazen {
+	/*
+	Argument validation. Functions that can be handed bad input (an out of range index, a zero vector) report it by
+	returning a Result holding an ErrorCode instead of printing and exiting, so a long-running host can log the error
+	and carry on.
+
+	Defining BRAZEN_NO_VALIDATION before including any Brazen header compiles the index checks of the simulation
+	mutators out (see "VALIDATION_ENABLED"), for hot paths whose input was already checked upstream. Those mutators
+	then always succeed, and an invalid index is undefined behavior. Checks that guard math, like "checked_unit()",
+	are always made.
+	*/
+#ifdef BRAZEN_NO_VALIDATION
+	constexpr bool VALIDATION_ENABLED = false;
+#else
+	constexpr bool VALIDATION_ENABLED = true;
+#endif
+
+	/*
+	Enum ErrorCode - reasons a checked call can fail.
+	*/
+	enum class ErrorCode {
+		OK,  // No error
+		INVALID_PARTICLE_INDEX,  // A particle index was never handed out
+		INVALID_EDGE_INDEX,  // An edge refers past the end of the index list it is relative to
+		ZERO_VECTOR  // The vector has no direction
+	};
+
+	// Return a short description of the given error.
+	inline const char* errorMessage(ErrorCode error) {
+		switch (error) {
+		case ErrorCode::OK:
+			return "no error";
+		case ErrorCode::INVALID_PARTICLE_INDEX:
+			return "invalid particle index";
+		case ErrorCode::INVALID_EDGE_INDEX:
+			return "invalid edge index";
+		case ErrorCode::ZERO_VECTOR:
+			return "zero vector has no direction";
+		}
+		return "unknown error";
+	}
+
+
+	/*
+	Class ValidationError - thrown by "Result::value()" when there is no value, carrying the error.
+	*/
+	class ValidationError : public std::runtime_error {
+	private:
+		// ATTRIBUTES
+		ErrorCode code;
+	public:
+		// CONSTRUCTORS
+		explicit ValidationError(ErrorCode error) :
+			std::runtime_error(errorMessage(error)), code(error)
+		{}
+
+		// MEMBER FUNCTIONS
+		ErrorCode error(void) const { return code; }
+	};
+
+
+	/*
+	Class Result - either a value or the ErrorCode saying why there is none, after C++23's std::expected.
+	Result<void> (typedef Status) only says whether a call succeeded. Both convert to true on success.
+	*/
+	template <typename T>
+	class Result {
+	private:
+		// ATTRIBUTES
+		T result_value;  // Default constructed on error
+		ErrorCode code;
+	public:
+		// CONSTRUCTORS
+		Result(T value) :
+			result_value(std::move(value)), code(ErrorCode::OK)
+		{}
+		Result(ErrorCode error) :
+			result_value(), code(error)
+		{}
+
+		// MEMBER FUNCTIONS
+		bool ok(void) const { return code == ErrorCode::OK; }
+		explicit operator bool(void) const { return ok(); }
+		ErrorCode error(void) const { return code; }
+		const char* message(void) const { return errorMessage(code); }
+
+		// Return the value, or throw a ValidationError if there is none.
+		const T& value(void) const;
+		// Return the value, or "fallback" if there is none.
+		T valueOr(T fallback) const { return ok() ? result_value : fallback; }
+		// Return the value without checking for one.
+		const T& operator*(void) const { return result_value; }
+		const T* operator->(void) const { return &result_value; }
+	};
+
+	template <>
+	class Result<void> {
+	private:
+		// ATTRIBUTES
+		ErrorCode code;
+	public:
+		// CONSTRUCTORS
+		Result(ErrorCode error = ErrorCode::OK) :
+			code(error)
+		{}
+
+		// MEMBER FUNCTIONS
+		bool ok(void) const { return code == ErrorCode::OK; }
+		explicit operator bool(void) const { return ok(); }
+		ErrorCode error(void) const { return code; }
+		const char* message(void) const { return errorMessage(code); }
+
+		// Throw a ValidationError if there was an error.
+		void value(void) const {
+			if (!ok())
+				throw ValidationError(code);
+		}
+	};
+
+	typedef Result<void> Status;
+
+
+	template <typename T>
+	const T& Result<T>::value(void) const {
+		if (!ok())
+			throw ValidationError(code);
+		return result_value;
+	}
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include "aligned_tuple.h"
+#include <iostream>
+#include <random>
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+template <std::uint8_t _Size>
+Tuple<_Size> randomTuple(std::default_random_engine& generator) {
+	std::uniform_real_distribution<double> distribution(-10., 10.);
+	Tuple<_Size> out(false);
+
+	for (std::uint8_t i = 0; i < _Size; i++)
+		out[i] = distribution(generator);
+
+	return out;
+}
+
+// Return the largest difference between the components of a Tuple and an AlignedTuple, including a nonzero padding lane
+template <std::uint8_t _Size>
+double difference(const Tuple<_Size>& expected, const AlignedTuple<_Size>& v) {
+	double error = _Size == 3 ? std::abs(v[3]) : 0.;
+
+	for (std::uint8_t i = 0; i < _Size; i++)
+		error = std::max(error, std::abs(expected[i] - v[i]));
+
+	return error;
+}
+
+// Run every operation on Tuples and AlignedTuples and return the largest difference
+template <std::uint8_t _Size>
+double maxError(std::default_random_engine& generator) {
+	double error = 0.;
+
+	for (int trial = 0; trial < 1000; trial++) {
+		Tuple<_Size> a = randomTuple<_Size>(generator), b = randomTuple<_Size>(generator);
+		AlignedTuple<_Size> aa(a), ab(b);
+		double s = 1.5 + trial;
+
+		error = std::max(error, difference(a + b, aa + ab));
+		error = std::max(error, difference(a - b, aa - ab));
+		error = std::max(error, difference(a * s, aa * s));
+		error = std::max(error, difference(s * a, s * aa));
+		error = std::max(error, difference(a / s, aa / s));
+		error = std::max(error, difference(unit(a), unit(aa)));
+		error = std::max(error, std::abs(dot(a, b) - dot(aa, ab)) / (1. + std::abs(dot(a, b))));
+		error = std::max(error, std::abs(magnitude(a) - magnitude(aa)) / magnitude(a));
+
+		Tuple<_Size> c = a;
+		AlignedTuple<_Size> ac = aa;
+		c += b;
+		ac += ab;
+		c *= s;
+		ac *= s;
+		c -= a;
+		ac -= aa;
+		c /= s;
+		ac /= s;
+		error = std::max(error, difference(c, ac));
+		error = std::max(error, difference(a, AlignedTuple<_Size>(Tuple<_Size>(aa))));
+	}
+
+	return error;
+}
+
+double crossError(std::default_random_engine& generator) {
+	double error = 0.;
+
+	for (int trial = 0; trial < 1000; trial++) {
+		Tuple<3> a = randomTuple<3>(generator), b = randomTuple<3>(generator);
+		error = std::max(error, difference(cross(a, b), cross(AlignedTuple<3>(a), AlignedTuple<3>(b))));
+	}
+
+	return error;
+}
+
+int main() {
+	bool failed = false;
+	std::default_random_engine generator(5);
+	double error;
+
+	print("Aligned Tuple Test");
+#if defined(BRAZEN_ALIGNED_TUPLE_AVX)
+	print("Compiled for AVX");
+#elif defined(BRAZEN_ALIGNED_TUPLE_SSE2)
+	print("Compiled for SSE2");
+#else
+	print("Compiled without SIMD");
+#endif
+
+	print("alignment:", alignof(AlignedTuple<3>), "size:", sizeof(AlignedTuple<3>));
+	failed |= alignof(AlignedTuple<3>) != 32 || sizeof(AlignedTuple<3>) != 32;
+
+	error = maxError<3>(generator);
+	print("3D max error:", error);
+	failed |= error > 1e-12;
+	error = maxError<4>(generator);
+	print("4D max error:", error);
+	failed |= error > 1e-12;
+	error = crossError(generator);
+	print("cross max error:", error);
+	failed |= error > 1e-12;
+
+	print(failed ? "\nFAILED" : "\nPASSED");
+	return failed ? 1 : 0;
+}
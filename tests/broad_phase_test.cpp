@@ -0,0 +1,181 @@
+#include "uniform_grid.h"
+#include "sweep_and_prune.h"
+#include "aabb_tree.h"
+#include <vector>
+#include <cmath>
+#include <limits>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return "count" random boxes scattered through a cube of side "spread"; every tenth box is large
+template <std::uint8_t _Size>
+std::vector<AABB<_Size> > randomBoxes(std::uint32_t count, double spread) {
+	std::vector<AABB<_Size> > boxes;
+	std::default_random_engine generator(count);
+	std::uniform_real_distribution<double> position(-spread, spread), size(.1, 1.);
+
+	for (std::uint32_t b = 0; b < count; b++) {
+		Tuple<_Size> min(true), max(true);
+		for (std::uint8_t i = 0; i < _Size; i++) {
+			min[i] = position(generator);
+			max[i] = min[i] + size(generator) * (b % 10 ? 1. : 20.);
+		}
+		boxes.push_back(AABB<_Size>(min, max));
+	}
+
+	return boxes;
+}
+
+// Return every overlapping pair by testing all of them
+template <std::uint8_t _Size>
+std::vector<BoxPair> allPairs(const std::vector<AABB<_Size> >& boxes) {
+	std::vector<BoxPair> pairs;
+
+	for (std::uint32_t a = 0; a < boxes.size(); a++)
+		for (std::uint32_t b = a + 1; b < boxes.size(); b++)
+			if (boxes[a].overlaps(boxes[b]))
+				pairs.push_back(BoxPair(a, b));
+
+	return pairs;
+}
+
+template <std::uint8_t _Size>
+bool testUniformGrid(std::uint32_t count, double spread) {
+	std::vector<AABB<_Size> > boxes = randomBoxes<_Size>(count, spread);
+	std::vector<BoxPair> expected = allPairs(boxes);
+	UniformGrid<_Size> grid;
+
+	bool matches = grid.findPairs(boxes) == expected;
+	print(_Size + 0, "D uniform grid,", count, "boxes:", expected.size(), "pairs, matches:", matches);
+
+	// A box spanning 2^32 cells on every axis, so that its cell count wraps to 0 in 64 bits from 2D up, must
+	//	still be checked against everything
+	Tuple<_Size> min(true), max(true);
+	for (std::uint8_t i = 0; i < _Size; i++) {
+		min[i] = -2147483648.;
+		max[i] = 2147483647.5;
+	}
+	boxes.push_back(AABB<_Size>(min, max));
+	grid.setCellSize(1.);
+	const bool huge = grid.findPairs(boxes) == allPairs(boxes);
+	print(_Size + 0, "D uniform grid with a huge box matches:", huge);
+
+	return matches && huge;
+}
+
+template <std::uint8_t _Size>
+bool testSweepAndPrune(std::uint32_t count, double spread) {
+	std::vector<AABB<_Size> > boxes = randomBoxes<_Size>(count, spread);
+	SweepAndPrune<_Size> sweep;
+	bool matches = true;
+
+	// Move the boxes a little between calls to exercise the incremental re-sort
+	for (std::uint32_t step = 0; step < 10; step++) {
+		matches &= sweep.findPairs(boxes) == allPairs(boxes);
+
+		for (AABB<_Size>& box : boxes) {
+			Tuple<_Size> offset = random_unit<_Size>() * .2;
+			box.min += offset;
+			box.max += offset;
+		}
+	}
+	print(_Size + 0, "D sweep and prune,", count, "boxes, axis", sweep.sweepAxis() + 0, "matches:", matches);
+
+	// Boxes with a NaN bound, an infinite bound or a min above their max must not break the sweep, before
+	//	or after the incremental re-sort, and must still be checked against everything
+	AABB<_Size> nan_box = boxes[1], infinite_box = boxes[2], inverted_box = boxes[3];
+	nan_box.min[0] = std::nan("");
+	infinite_box.max[_Size - 1] = std::numeric_limits<double>::infinity();
+	inverted_box.min[0] = inverted_box.max[0] + 1.;
+	bool degenerate = true;
+	for (std::uint32_t step = 0; step < 4; step++) {
+		boxes[1] = step % 2 ? nan_box : boxes[4];  // Drops in and out of the endpoint list
+		boxes[2] = infinite_box;
+		boxes[3] = inverted_box;
+		degenerate &= sweep.findPairs(boxes) == allPairs(boxes);
+	}
+	print(_Size + 0, "D sweep and prune with degenerate boxes matches:", degenerate);
+
+	return matches && degenerate;
+}
+
+template <std::uint8_t _Size>
+bool testAABBTree(std::uint32_t count, double spread) {
+	std::vector<AABB<_Size> > boxes = randomBoxes<_Size>(count, spread);
+	AABBTree<_Size> tree;
+	bool matches = true;
+
+	// Move the boxes between calls so some leave their fat boxes and are reinserted
+	for (std::uint32_t step = 0; step < 10; step++) {
+		matches &= tree.findPairs(boxes) == allPairs(boxes);
+
+		for (AABB<_Size>& box : boxes) {
+			Tuple<_Size> offset = random_unit<_Size>() * .2;
+			box.min += offset;
+			box.max += offset;
+		}
+	}
+
+	// A box query must find exactly the boxes that overlap the query box
+	AABB<_Size> query_box = boxes[0];
+	std::vector<std::uint32_t> found, expected;
+	tree.update(boxes);
+	tree.query(query_box, [&found, &boxes, &query_box](std::uint32_t key) {
+		if (boxes[key].overlaps(query_box))
+			found.push_back(key);
+		return true;
+	});
+	for (std::uint32_t b = 0; b < boxes.size(); b++)
+		if (boxes[b].overlaps(query_box))
+			expected.push_back(b);
+	std::sort(found.begin(), found.end());
+	matches &= found == expected;
+
+	// A ray cast from outside toward a box's center must hit it
+	Tuple<_Size> target = boxes[1].center();
+	Tuple<_Size> origin = target + random_unit<_Size>() * (4. * spread);
+	bool hit = false;
+	tree.rayCast(origin, target - origin, 1., [&hit](std::uint32_t key, double) {
+		hit |= key == 1;
+		return 1.;
+	});
+	matches &= hit;
+
+	print(_Size + 0, "D AABB tree,", count, "boxes, height", tree.height(), "matches:", matches);
+
+	return matches;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Uniform Grid Test");
+	failed |= !testUniformGrid<1>(500, 100.);
+	failed |= !testUniformGrid<2>(1000, 20.);
+	failed |= !testUniformGrid<3>(1000, 8.);
+	failed |= !testUniformGrid<4>(1000, 4.);
+
+	print("\nSweep and Prune Test");
+	failed |= !testSweepAndPrune<1>(500, 100.);
+	failed |= !testSweepAndPrune<2>(1000, 20.);
+	failed |= !testSweepAndPrune<3>(1000, 8.);
+	failed |= !testSweepAndPrune<4>(1000, 4.);
+
+	print("\nAABB Tree Test");
+	failed |= !testAABBTree<1>(500, 100.);
+	failed |= !testAABBTree<2>(1000, 20.);
+	failed |= !testAABBTree<3>(1000, 8.);
+	failed |= !testAABBTree<4>(1000, 4.);
+
+	print(failed ? "\nFAILED" : "\nPASSED");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+#include "command_queue.h"
+#include <thread>
+#include <mutex>
+#include <vector>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// The members CommandQueue reads from a spring
+struct TestSpring {
+	std::uint32_t p1_index, p2_index;
+};
+
+typedef CommandQueue<2, double, TestSpring> TestQueue;
+typedef CommandBatch<2, double, TestSpring> TestBatch;
+
+// Indices follow queueing order, objects expand into springs, and bad indices are rejected without queueing anything
+bool testQueueing(void) {
+	TestQueue queue;
+	TestBatch batch;
+	std::vector<Particle<2> > particles(5, Particle<2>(Tuple<2>(), 1.));
+
+	const std::uint32_t first = queue.addParticles(particles.begin(), particles.end());
+	const std::uint32_t second = queue.addParticles(particles.begin(), particles.begin() + 3);
+	const bool spring_ok = queue.addSprings({ TestSpring{ 0, 7 } }).ok();
+	const bool object_ok = queue.addObject({ 5, 6, 7 }, { SpringEdge{ 0, 1 }, SpringEdge{ 1, 2 } }, TestSpring{ 0, 0 }).ok();
+	bool spring_rejected = true, object_rejected = true;
+	if (VALIDATION_ENABLED) {  // Bad indices are undefined behavior with the checks compiled out
+		spring_rejected = queue.addSprings({ TestSpring{ 1, 2 }, TestSpring{ 0, 8 } }).error() == ErrorCode::INVALID_PARTICLE_INDEX;
+		object_rejected = queue.addObject({ 5, 6 }, { SpringEdge{ 0, 2 } }, TestSpring{ 0, 0 }).error() == ErrorCode::INVALID_EDGE_INDEX
+			&& queue.addObject({ 9 }).error() == ErrorCode::INVALID_PARTICLE_INDEX;
+	}
+
+	const bool took = queue.take(batch);
+	const bool took_again = queue.take(batch);  // Nothing left, and the batch is untouched
+	const bool contents = batch.particles.size() == 8 && batch.springs.size() == 3 && batch.objects.size() == 1
+		&& batch.springs[1].p1_index == 5 && batch.springs[1].p2_index == 6 && batch.springs[2].p2_index == 7;
+
+	print("first indices:", first, second, " issued:", queue.issuedParticleCount(), " accepted:", spring_ok && object_ok,
+		" rejected:", spring_rejected && object_rejected, " batch contents:", contents, " empty after take:", !took_again);
+	return first == 0 && second == 5 && queue.issuedParticleCount() == 8 && spring_ok && object_ok && spring_rejected
+		&& object_rejected && took && !took_again && contents;
+}
+
+// Producers queueing while a consumer takes batches must never see their particles split from their springs
+bool testConcurrentProducers(void) {
+	const std::uint32_t PRODUCERS = 4, BATCHES = 500, BATCH_SIZE = 8;
+	TestQueue queue;
+	std::vector<Particle<2> > applied;
+	std::vector<TestSpring> applied_springs;
+	bool done = false;
+	std::mutex done_mutex;
+
+	std::vector<std::thread> producers;
+	for (std::uint32_t t = 0; t < PRODUCERS; t++)
+		producers.emplace_back([&queue, t]() {
+			for (std::uint32_t b = 0; b < BATCHES; b++) {
+				std::vector<Particle<2> > batch(BATCH_SIZE, Particle<2>(Tuple<2>(t, b), 1.));  // Tagged with the producer and batch
+				std::uint32_t first = queue.addParticles(batch.begin(), batch.end());
+				queue.addSprings({ TestSpring{ first, first + BATCH_SIZE - 1 } });
+			}
+		});
+
+	std::thread consumer([&]() {
+		TestBatch batch;
+		for (;;) {
+			bool finished;
+			{
+				std::lock_guard<std::mutex> done_lock(done_mutex);
+				finished = done;
+			}
+			if (queue.take(batch)) {
+				applied.insert(applied.end(), batch.particles.begin(), batch.particles.end());
+				applied_springs.insert(applied_springs.end(), batch.springs.begin(), batch.springs.end());
+				batch.clear();
+			}
+			else if (finished)
+				break;
+		}
+	});
+
+	for (std::thread& producer : producers)
+		producer.join();
+	{
+		std::lock_guard<std::mutex> done_lock(done_mutex);
+		done = true;
+	}
+	consumer.join();
+
+	std::uint32_t mismatches = 0;
+	for (const TestSpring& spring : applied_springs)
+		mismatches += spring.p2_index >= applied.size() || magnitude(applied[spring.p1_index].pos - applied[spring.p2_index].pos) != 0.;
+	print("particles:", applied.size(), " springs:", applied_springs.size(), " springs joining different batches:", mismatches);
+	return applied.size() == PRODUCERS * BATCHES * BATCH_SIZE && applied_springs.size() == PRODUCERS * BATCHES && mismatches == 0;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Command Queue Test");
+	failed |= !testQueueing();
+	failed |= !testConcurrentProducers();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#include "hypercube.h"
+#include <iostream>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Tuple arithmetic is usable in constant expressions, for every size
+constexpr Tuple<3> GRAVITY(0., -9.8, 0.);
+constexpr Tuple<3> FORWARD = cross(Tuple<3>(1., 0., 0.), Tuple<3>(0., 1., 0.));
+constexpr Tuple<2> PLANE = Tuple<2>(1., 2.) * 2. - Tuple<2>(.5, .5) / .5;
+constexpr Tuple<4> DIAGONAL = Tuple<4>(1., 1., 1., 1.) + Tuple<4>() * 3.;
+static_assert(GRAVITY.y == -9.8 && magnitudeSquared(GRAVITY) == 9.8 * 9.8, "constexpr 3-Tuple");
+static_assert(FORWARD.z == 1. && dot(FORWARD, GRAVITY) == 0., "constexpr cross product");
+static_assert(PLANE.x == 1. && PLANE.y == 3., "constexpr 2-Tuple");
+static_assert(DIAGONAL[3] == 1. && dot(DIAGONAL, DIAGONAL) == 4., "constexpr N-Tuple");
+static_assert(projection_vector(Tuple<4>(2., 3., 0., 0.), Tuple<4>(1., 0., 0., 0.))[0] == 2., "constexpr projection");
+
+// Hypercube tables are built at compile time
+constexpr auto CUBE = hypercubeVertices<3>(2., Tuple<3>(10., 0., 0.));
+constexpr auto CUBE_EDGES = hypercubeEdges<3>();
+constexpr auto TESSERACT = hypercubeVertices<4>(1.);
+constexpr auto TESSERACT_EDGES = hypercubeEdges<4>();
+static_assert(CUBE.size() == 8 && CUBE_EDGES.size() == 12, "cube counts");
+static_assert(TESSERACT.size() == 16 && TESSERACT_EDGES.size() == 32, "tesseract counts");
+static_assert(CUBE[0].x == 9. && CUBE[7].x == 11. && CUBE[5].y == -1. && CUBE[5].z == 1., "cube vertices");
+static_assert(TESSERACT[15][3] == .5 && TESSERACT[7][3] == -.5, "tesseract vertices");
+
+// Every edge joins two vertices one side length apart, and no edge appears twice
+template <std::uint8_t _Size>
+bool testHypercube(double side) {
+	const auto vertices = hypercubeVertices<_Size>(side);
+	const auto edges = hypercubeEdges<_Size>();
+	std::uint32_t bad_edges = 0, duplicates = 0;
+
+	for (std::uint32_t e = 0; e < edges.size(); e++) {
+		const Tuple<_Size> d = vertices[edges[e].p2_index] - vertices[edges[e].p1_index];
+		bad_edges += std::abs(magnitude(d) - side) > 1e-12;
+		for (std::uint32_t f = 0; f < e; f++)
+			duplicates += edges[f].p1_index == edges[e].p1_index && edges[f].p2_index == edges[e].p2_index;
+	}
+
+	print(_Size + 0, "D hypercube ", vertices.size(), "vertices,", edges.size(), "edges  bad edges:", bad_edges, " duplicates:", duplicates);
+	return bad_edges == 0 && duplicates == 0;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Hypercube Test");
+	failed |= !testHypercube<1>(2.);
+	failed |= !testHypercube<2>(2.);
+	failed |= !testHypercube<3>(.5);
+	failed |= !testHypercube<4>(1.);
+	failed |= !testHypercube<6>(3.);
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
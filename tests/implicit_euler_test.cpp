@@ -0,0 +1,184 @@
+#include "implicit_euler.h"
+#include <cmath>
+#include <vector>
+
+using namespace Brazen;
+
+const double MASS = 1., REST_LENGTH = .1;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// A chain of "length" particles along x, stretched by 20% and hanging from a static first particle
+void makeChain(ParticleStore<3>& store, std::vector<Spring<3> >& springs, std::uint32_t length, double stiffness) {
+	for (std::uint32_t i = 0; i < length; i++)
+		store.push_back(Particle<3>(Tuple<3>(1.2 * REST_LENGTH * i, .01 * std::sin(i), 0.), i ? MASS : 0.));
+	for (std::uint32_t i = 0; i + 1 < length; i++)
+		springs.push_back(Spring<3>(i, i + 1, stiffness, REST_LENGTH));
+}
+
+void applySprings(ParticleStore<3>& store, const std::vector<Spring<3> >& springs) {
+	for (const Spring<3>& spring : springs)
+		spring.update(store);
+}
+
+// Kinetic plus spring potential energy
+double energy(const ParticleStore<3>& store, const std::vector<Spring<3> >& springs) {
+	double e = 0.;
+	for (std::uint32_t i = 0; i < store.size(); i++)
+		if (store.invMass[i] > 0)
+			e += .5 * magnitudeSquared(store.vel[i]) / store.invMass[i];
+	for (const Spring<3>& spring : springs) {
+		double stretch = magnitude(store.pos[spring.p2_index] - store.pos[spring.p1_index]) - spring.rest_length;
+		e += .5 * spring.stiffness * stretch * stretch;
+	}
+	return e;
+}
+
+template <template <std::uint8_t, typename> class _Integrator>
+void runChain(ParticleStore<3>& store, const std::vector<Spring<3> >& springs, _Integrator<3, double>& integrator, double dt, double duration, ThreadPool* pool) {
+	const std::uint32_t steps = (std::uint32_t)std::lround(duration / dt);
+	for (std::uint32_t s = 0; s < steps; s++)
+		integrator.step(store, dt, springForces(springs, [&store, &springs]() { applySprings(store, springs); }), pool);
+}
+
+// Conjugate gradients must solve a block tridiagonal system to the requested tolerance
+bool testConjugateGradient(void) {
+	const std::uint32_t rows = 50;
+	BlockSparseMatrix<3> A;
+	std::vector<std::pair<std::uint32_t, std::uint32_t> > pairs;
+	for (std::uint32_t r = 0; r + 1 < rows; r++)
+		pairs.push_back(std::pair<std::uint32_t, std::uint32_t>(r, r + 1));
+	pairs.push_back(std::pair<std::uint32_t, std::uint32_t>(1, 0));  // Duplicates share a block
+	A.setPattern(rows, pairs);
+
+	for (std::uint32_t r = 0; r < rows; r++)
+		for (std::uint8_t k = 0; k < 3; k++) {
+			A.block(A.diagonalIndex(r))[k * 3 + k] = 3. + r % 4;
+			if (r + 1 < rows) {
+				A.block(A.blockIndex(r, r + 1))[k * 3 + k] = -1.;
+				A.block(A.blockIndex(r + 1, r))[k * 3 + k] = -1.;
+			}
+		}
+
+	std::vector<double> b(rows * 3), x(rows * 3, 0.), Ax(rows * 3);
+	for (std::uint32_t k = 0; k < b.size(); k++)
+		b[k] = std::cos(k * .7);
+	ConjugateGradientResult result = conjugateGradient(A, b, x, 1e-10, 500);
+	A.multiply(x.data(), Ax.data(), nullptr);
+
+	double error = 0.;
+	for (std::uint32_t k = 0; k < b.size(); k++)
+		error = std::max(error, std::abs(Ax[k] - b[k]));
+	print("blocks:", A.blockCount(), " iterations:", result.iterations, " relative residual:", result.relative_residual, " max |Ax - b|:", error);
+	return A.blockCount() == 3 * rows - 2 && result.relative_residual <= 1e-10 && error < 1e-8;
+}
+
+// A chain far too stiff for explicit methods at this step must stay bounded and lose energy rather than gain it
+bool testStiffChain(ThreadPool* pool) {
+	const double stiffness = 1e4, omega = 2. * std::sqrt(stiffness / MASS);
+	const double dt = 8. / omega;  // Four times the explicit stability limit
+
+	ParticleStore<3> store;
+	std::vector<Spring<3> > springs;
+	ImplicitEuler<3, double> integrator;
+	makeChain(store, springs, 64, stiffness);
+	const double start_energy = energy(store, springs);
+	runChain(store, springs, integrator, dt, 1., pool);
+	const double end_energy = energy(store, springs);
+
+	print("dt * omega:", dt * omega, " energy:", start_energy, "->", end_energy, " last solve:", integrator.lastSolve().iterations, "iterations");
+	return std::isfinite(end_energy) && end_energy < start_energy && integrator.lastSolve().relative_residual <= 1e-6;
+}
+
+// The error against a fine explicit solution must halve with the step: backward Euler is first order
+bool testOrder(void) {
+	const double stiffness = 100.;
+	std::vector<Spring<3> > springs;
+	ParticleStore<3> reference;
+	RungeKutta4<3, double> rk4;
+	makeChain(reference, springs, 16, stiffness);
+	runChain(reference, springs, rk4, 1e-4, .5, nullptr);
+
+	double errors[2];
+	for (std::uint32_t run = 0; run < 2; run++) {
+		ParticleStore<3> store;
+		std::vector<Spring<3> > chain_springs;
+		ImplicitEuler<3, double> integrator;
+		integrator.setTolerance(1e-12);
+		makeChain(store, chain_springs, 16, stiffness);
+		runChain(store, chain_springs, integrator, run ? .0005 : .001, .5, nullptr);
+
+		errors[run] = 0.;
+		for (std::uint32_t i = 0; i < store.size(); i++)
+			errors[run] = std::max(errors[run], magnitude(store.pos[i] - reference.pos[i]));
+	}
+
+	const double order = std::log2(errors[0] / errors[1]);
+	print("error at dt = .001:", errors[0], " at dt = .0005:", errors[1], " observed order:", order);
+	return std::abs(order - 1.) < .3;
+}
+
+// The pattern must be built once and reused until "reset()", and the partitioned store must give the same motion
+bool testPatternReuse(void) {
+	ParticleStore<3> a, b;
+	std::vector<Spring<3> > springs;
+	ImplicitEuler<3, double> integrator_a, integrator_b;
+	makeChain(a, springs, 32, 1e3);
+	springs.clear();
+	makeChain(b, springs, 32, 1e3);
+	springs.push_back(Spring<3>(3, 7, 500., .3, .5));  // A damped cross link
+
+	std::vector<std::uint32_t> new_index;
+	b.partition(new_index);  // Moves the static particle to the back
+	std::vector<Spring<3> > b_springs = springs;
+	for (Spring<3>& spring : b_springs) {
+		spring.p1_index = new_index[spring.p1_index];
+		spring.p2_index = new_index[spring.p2_index];
+	}
+
+	runChain(a, springs, integrator_a, .01, .5, nullptr);
+	runChain(b, b_springs, integrator_b, .01, .5, nullptr);
+	const std::uint32_t builds = integrator_a.patternBuilds();
+	integrator_a.reset();
+	runChain(a, springs, integrator_a, .01, .01, nullptr);
+	runChain(b, b_springs, integrator_b, .01, .01, nullptr);
+
+	double difference = 0.;
+	for (std::uint32_t i = 0; i < a.size(); i++)
+		difference = std::max(difference, magnitude(a.pos[i] - b.pos[new_index[i]]));
+
+	print("pattern builds over 50 steps:", builds, " after reset:", integrator_a.patternBuilds(), " partitioned vs unpartitioned:", difference);
+	return builds == 1 && integrator_a.patternBuilds() == 2 && difference < 1e-9;
+}
+
+int main() {
+	bool failed = false;
+	ThreadPool pool(4);
+
+	print("Conjugate Gradient Test");
+	failed |= !testConjugateGradient();
+	print();
+
+	print("Stiff Chain Test");
+	failed |= !testStiffChain(nullptr);
+	failed |= !testStiffChain(&pool);
+	print();
+
+	print("Order Test");
+	failed |= !testOrder();
+	print();
+
+	print("Pattern Reuse Test");
+	failed |= !testPatternReuse();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
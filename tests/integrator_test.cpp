@@ -0,0 +1,110 @@
+#include "integrators.h"
+#include <cmath>
+#include <vector>
+
+using namespace Brazen;
+
+const double STIFFNESS = 40.;  // Of the spring pulling every particle to the origin
+const double DURATION = 2.;  // Simulated seconds
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Fill a store with harmonic oscillators of different masses and one static particle with a velocity
+void makeOscillators(ParticleStore<3>& store) {
+	for (std::uint32_t i = 0; i < 20; i++)
+		store.push_back(Particle<3>(Tuple<3>(1., .5 * i / 20, 0.), Tuple<3>(0., 0., 1.), 1. + i * .25));
+	store.push_back(Particle<3>(Tuple<3>(), Tuple<3>(1., 0., 0.), 0.));
+}
+
+// Integrate the oscillators for DURATION with the given step and return the largest position error from the exact solution
+template <template <std::uint8_t, typename> class _Integrator>
+double oscillatorError(double dt, ThreadPool* pool) {
+	ParticleStore<3> store;
+	_Integrator<3, double> integrator;
+	makeOscillators(store);
+
+	std::vector<Particle<3> > start;
+	for (std::uint32_t i = 0; i < store.size(); i++)
+		start.push_back(store.get(i));
+
+	const std::uint32_t steps = (std::uint32_t)std::lround(DURATION / dt);
+	for (std::uint32_t s = 0; s < steps; s++)
+		integrator.step(store, dt, [&store]() {
+			for (std::uint32_t i = 0; i < store.size(); i++)
+				store.F[i] += store.pos[i] * -STIFFNESS;
+		}, pool);
+
+	double error = 0.;
+	for (std::uint32_t i = 0; i < store.size(); i++) {
+		Tuple<3> exact = start[i].pos + start[i].vel * DURATION;  // The static particle only drifts
+		if (start[i].invMass > 0) {
+			const double omega = std::sqrt(STIFFNESS * start[i].invMass);
+			exact = start[i].pos * std::cos(omega * DURATION) + start[i].vel * (std::sin(omega * DURATION) / omega);
+		}
+		error = std::max(error, magnitude(store.pos[i] - exact));
+	}
+	return error;
+}
+
+// The error must shrink with the step size at the method's order
+template <template <std::uint8_t, typename> class _Integrator>
+bool testOrder(double expected_order, ThreadPool* pool) {
+	const double coarse = oscillatorError<_Integrator>(.01, pool), fine = oscillatorError<_Integrator>(.005, pool);
+	const double order = std::log2(coarse / fine);
+
+	print(_Integrator<3, double>::name(), " error at dt = .01:", coarse, " at dt = .005:", fine, " observed order:", order);
+	return std::abs(order - expected_order) < .3 && fine < .05;
+}
+
+// SymplecticEuler must reproduce "ParticleStore::integrate()" exactly
+bool testSymplecticEulerMatchesStore(void) {
+	ParticleStore<3> a, b;
+	SymplecticEuler<3, double> integrator;
+	makeOscillators(a);
+	makeOscillators(b);
+
+	for (std::uint32_t s = 0; s < 100; s++) {
+		integrator.step(a, .01, [&a]() {
+			for (std::uint32_t i = 0; i < a.size(); i++)
+				a.F[i] += a.pos[i] * -STIFFNESS;
+		}, nullptr);
+		for (std::uint32_t i = 0; i < b.size(); i++)
+			b.F[i] += b.pos[i] * -STIFFNESS;
+		b.integrate(.01);
+	}
+
+	std::uint32_t mismatches = 0;
+	for (std::uint32_t i = 0; i < a.size(); i++)
+		for (std::uint8_t k = 0; k < 3; k++)
+			mismatches += a.pos[i][k] != b.pos[i][k] || a.vel[i][k] != b.vel[i][k];
+	print("symplectic Euler vs ParticleStore::integrate() mismatches:", mismatches);
+	return mismatches == 0;
+}
+
+int main() {
+	bool failed = false;
+	ThreadPool pool(4);
+
+	print("Integrator Order Test");
+	failed |= !testOrder<SymplecticEuler>(1., nullptr);
+	failed |= !testOrder<PositionVerlet>(2., nullptr);
+	failed |= !testOrder<VelocityVerlet>(2., nullptr);
+	failed |= !testOrder<RungeKutta4>(4., nullptr);
+	failed |= !testOrder<VelocityVerlet>(2., &pool);
+	failed |= !testOrder<RungeKutta4>(4., &pool);
+	print();
+
+	print("Consistency Test");
+	failed |= !testSymplecticEulerMatchesStore();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+#include "islands.h"
+#include "particle_store.h"
+#include <vector>
+#include <algorithm>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Sets merge, and every set lists exactly its own members
+bool testDisjointSets(void) {
+	DisjointSets sets;
+	for (std::uint32_t i = 0; i < 10; i++)
+		sets.add();
+	for (std::uint32_t i = 0; i + 2 < 10; i += 2)
+		sets.unite(i, i + 2);  // Evens
+	sets.unite(1, 3);
+	sets.unite(3, 1);  // Already merged
+
+	std::vector<std::uint32_t> evens, odds;
+	sets.forEachMember(4, [&evens](std::uint32_t member) { evens.push_back(member); });
+	sets.forEachMember(3, [&odds](std::uint32_t member) { odds.push_back(member); });
+	std::sort(evens.begin(), evens.end());
+	std::sort(odds.begin(), odds.end());
+
+	const bool roots = sets.find(0) == sets.find(8) && sets.find(1) == sets.find(3) && sets.find(0) != sets.find(1) && sets.find(9) == 9;
+	print("evens:", evens.size(), " odds:", odds.size(), " even set size:", sets.setSize(sets.find(0)), " roots consistent:", roots);
+	return roots && evens == std::vector<std::uint32_t>{ 0, 2, 4, 6, 8 } && odds == std::vector<std::uint32_t>{ 1, 3 }
+		&& sets.setSize(sets.find(6)) == 5;
+}
+
+// Islands sleep after enough quiet steps, touching islands sleep together, and joining a sleeping island wakes it
+bool testSleep(void) {
+	const double THRESHOLD = 1e-4;
+	const std::uint32_t STEPS = 3;
+	Islands islands;
+	std::vector<bool> asleep(7, false);
+	const auto sleep_member = [&asleep](std::uint32_t p) { asleep[p] = true; };
+	const auto wake_member = [&asleep](std::uint32_t p) { asleep[p] = false; };
+
+	// Islands {0, 1}, {2, 3} and {4}; 5 is static and stays out of every island, 6 is alone
+	for (std::uint32_t i = 0; i < 7; i++)
+		islands.add(i != 5);
+	islands.connect(0, 1, wake_member);
+	islands.connect(2, 3, wake_member);
+	islands.connect(4, 5, wake_member);
+
+	// {0, 1} and {6} are quiet, {2, 3} is quiet but touches {4}, which moves. Only awake particles are measured
+	const auto measure = [&islands, &asleep](std::uint32_t p, double mass, double speed_squared) {
+		if (!asleep[p])
+			islands.measure(p, mass, speed_squared);
+	};
+	std::uint32_t slept = 0, steps_to_sleep = 0;
+	for (std::uint32_t step = 0; step < 5; step++) {
+		measure(0, 1., 0.);
+		measure(1, 2., 1e-5);
+		measure(2, 1., 0.);
+		measure(3, 1., 0.);
+		measure(4, 1., 1.);
+		measure(6, 1., 0.);
+		islands.touch(3, 4);
+		slept += islands.sleep(THRESHOLD, STEPS, sleep_member);
+		if (!steps_to_sleep && asleep[0])
+			steps_to_sleep = step + 1;
+	}
+	const bool first = asleep[0] && asleep[1] && asleep[6] && !asleep[2] && !asleep[3] && !asleep[4] && !asleep[5] && slept == 2;
+
+	// Once {4} settles, {2, 3} and {4} sleep together
+	for (std::uint32_t step = 0; step < STEPS; step++) {
+		measure(2, 1., 0.);
+		measure(3, 1., 0.);
+		measure(4, 1., 0.);
+		islands.touch(3, 4);
+		slept += islands.sleep(THRESHOLD, STEPS, sleep_member);
+	}
+	const bool together = asleep[2] && asleep[3] && asleep[4] && slept == 4;
+
+	// Connecting to a sleeping island wakes all of it; waking by one member wakes the rest
+	islands.connect(1, 6, wake_member);
+	const bool joined = !asleep[0] && !asleep[1] && !asleep[6] && !islands.isAsleep(0) && islands.island(0) == islands.island(6);
+	const bool woke = islands.wake(3, wake_member) && !asleep[2] && !asleep[3] && !islands.wake(3, wake_member);
+	islands.wakeAll(wake_member);
+
+	print("steps to sleep:", steps_to_sleep, " quiet islands slept:", first, " touching islands slept together:", together,
+		" joining woke:", joined, " waking one woke all:", woke, " all awake:", !asleep[4]);
+	return steps_to_sleep == STEPS && first && together && joined && woke && !asleep[4] && !islands.isAsleep(4);
+}
+
+// A sleeping particle is partitioned out of the integrated range like a static one, and back in when woken
+bool testStorePartition(void) {
+	ParticleStore<2> store;
+	std::vector<std::uint32_t> new_index;
+	for (std::uint32_t i = 0; i < 6; i++)
+		store.push_back(Particle<2>(Tuple<2>((double)i, 0.), i == 2 ? 0. : 1.));
+	store.partition(new_index);
+	const std::uint32_t dynamic = store.dynamicCount();
+
+	store.setAsleep(new_index[4], true);
+	const bool broken = !store.isPartitioned();
+	store.partition(new_index);
+	const bool slept = store.dynamicCount() == 4 && store.isAsleep(4) && store.pos[4][0] == 4. && store.pos[5][0] == 2.;
+
+	store.setAsleep(4, false);
+	store.partition(new_index);
+	const bool woke = store.dynamicCount() == 5 && !store.isAsleep(new_index[4]) && store.pos[4][0] == 4.;
+
+	print("dynamic:", dynamic, " partition broken by sleep:", broken, " asleep after partition:", slept, " awake again:", woke);
+	return dynamic == 5 && broken && slept && woke;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Disjoint Sets Test");
+	failed |= !testDisjointSets();
+	print();
+
+	print("Sleep Test");
+	failed |= !testSleep();
+	print();
+
+	print("Store Partition Test");
+	failed |= !testStorePartition();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+#include "object_store.h"
+#include <vector>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Objects must keep their members in order, and their cached bounds and centroids must match a direct computation
+bool testMembersAndBounds(void) {
+	std::vector<Tuple<3> > positions;
+	for (std::uint32_t i = 0; i < 100; i++)
+		positions.push_back(Tuple<3>(std::sin(i * 1.3), std::cos(i * .7), i * .01));
+
+	std::vector<std::vector<std::uint32_t> > lists;
+	ObjectStore<3> store;
+	for (std::uint32_t o = 0; o < 20; o++) {
+		std::vector<std::uint32_t> list;
+		for (std::uint32_t m = 0; m < o % 6; m++)  // Every sixth object is empty
+			list.push_back((o * 7 + m * 13) % 100);
+		lists.push_back(list);
+		store.push_back(list, positions);
+	}
+
+	std::uint32_t mismatches = 0;
+	for (std::uint32_t o = 0; o < store.size(); o++) {
+		ObjectView view = store[o];
+		mismatches += view.size() != lists[o].size() || view.empty() != lists[o].empty();
+		for (std::uint32_t m = 0; m < view.size(); m++)
+			mismatches += view[m] != lists[o][m];
+		if (lists[o].empty())
+			continue;
+
+		AABB<3> box = boundsOf(positions, lists[o]);
+		Tuple<3> centroid;
+		for (std::uint32_t index : lists[o])
+			centroid += positions[index];
+		centroid /= (double)lists[o].size();
+		mismatches += magnitude(box.min - store.bounds()[o].min) > 1e-12 || magnitude(box.max - store.bounds()[o].max) > 1e-12;
+		mismatches += magnitude(centroid - store.centroids()[o]) > 1e-12;
+	}
+
+	print("objects:", store.size(), " members:", store.memberCount(), " mismatches:", mismatches);
+	return store.size() == 20 && mismatches == 0;
+}
+
+// Moving particles only changes the cache after "updateBounds()," and remapping renumbers the members
+bool testUpdateAndRemap(void) {
+	std::vector<Tuple<2> > positions = { Tuple<2>(0., 0.), Tuple<2>(1., 0.), Tuple<2>(0., 2.), Tuple<2>(5., 5.) };
+	ObjectStore<2> store;
+	store.push_back({ 0, 1, 2 }, positions);
+	store.push_back({ 3 }, positions);
+
+	positions[3] = Tuple<2>(-1., -1.);
+	const bool stale = store.bounds()[1].min[0] == 5.;
+	store.updateBounds(positions, 0, store.size());
+	const bool updated = store.bounds()[1].min[0] == -1. && store.centroids()[0][1] == 2. / 3;
+
+	store.remap({ 3, 2, 1, 0 });
+	const bool remapped = store[0][0] == 3 && store[0][2] == 1 && store[1][0] == 0;
+
+	print("stale until updated:", stale, " updated:", updated, " remapped:", remapped);
+	return stale && updated && remapped;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Object Store Test");
+	failed |= !testMembersAndBounds();
+	failed |= !testUpdateAndRemap();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+#include "particle_store.h"
+#include "fixed_point.h"
+#include <vector>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the largest difference between the positions and velocities of "expected" and "store"
+template <std::uint8_t _Size, typename _Scalar>
+double maxError(const std::vector<Particle<_Size, _Scalar> >& expected, const ParticleStore<_Size, _Scalar>& store) {
+	double error = 0.;
+
+	for (std::uint32_t i = 0; i < store.size(); i++) {
+		error = std::max(error, magnitude(Tuple<_Size>(expected[i].pos - store.pos[i])));
+		error = std::max(error, magnitude(Tuple<_Size>(expected[i].vel - store.vel[i])));
+	}
+
+	return error;
+}
+
+// Integrate the same particles as structs and in a store and return the largest difference
+template <std::uint8_t _Size, typename _Scalar = double>
+double integrationError(std::uint32_t count, std::uint32_t cycles, SimdLevel level) {
+	std::vector<Particle<_Size, _Scalar> > expected;
+	ParticleStore<_Size, _Scalar> store;
+
+	for (std::uint32_t i = 0; i < count; i++) {
+		// Every fourth particle is static
+		Particle<_Size, _Scalar> p(random_unit<_Size, _Scalar>() * i, random_unit<_Size, _Scalar>(), i % 4 ? 1. + i : 0.);
+		expected.push_back(p);
+		store.push_back(p);
+	}
+
+	for (std::uint32_t c = 0; c < cycles; c++) {
+		for (std::uint32_t i = 0; i < count; i++) {
+			Tuple<_Size, _Scalar> force = random_unit<_Size, _Scalar>();
+			Tuple<_Size, _Scalar> correction = random_unit<_Size, _Scalar>() * .01;
+
+			expected[i].F += force;
+			expected[i].m_delta_vel += correction;
+			expected[i].m_delta_pos_hard += correction;
+			store[i].F += force;
+			store[i].m_delta_vel += correction;
+			store[i].m_delta_pos_hard += correction;
+		}
+
+		for (Particle<_Size, _Scalar>& p : expected)
+			p.update(.01);
+		store.applyCorrections();
+		integrateBatch<_Size, _Scalar>(store.arrays(), .01, 0, store.size(), level);
+	}
+
+	return maxError(expected, store);
+}
+
+int main() {
+	bool failed = false;
+	double error;
+
+	print("Integration Test");
+
+	// Test every kernel this CPU can run; 101 particles leaves a remainder for the scalar tail
+	for (int l = 0; l <= (int)simdLevel(); l++) {
+		SimdLevel level = (SimdLevel)l;
+
+		error = integrationError<2>(101, 50, level);
+		print(simdLevelName(level), "2D max error:", error);
+		failed |= error > 1e-9;
+		error = integrationError<3>(101, 50, level);
+		print(simdLevelName(level), "3D max error:", error);
+		failed |= error > 1e-9;
+		error = integrationError<4>(101, 50, level);
+		print(simdLevelName(level), "4D max error:", error);
+		failed |= error > 1e-9;
+		error = integrationError<5>(101, 50, level);
+		print(simdLevelName(level), "5D max error:", error);
+		failed |= error > 1e-9;
+
+		// float kernels hold twice as many particles per vector, so use more particles to leave a remainder
+		error = integrationError<3, float>(203, 50, level);
+		print(simdLevelName(level), "3D float max error:", error);
+		failed |= error > 1e-4;
+		error = integrationError<4, float>(203, 50, level);
+		print(simdLevelName(level), "4D float max error:", error);
+		failed |= error > 1e-4;
+	}
+
+	// Fixed point always runs the portable kernel, which must match "Particle::update()" exactly
+	error = integrationError<3, Fixed32>(101, 50, SimdLevel::SCALAR);
+	print("fixed point 3D max error:", error);
+	failed |= error != 0.;
+
+	print("\nView Test");
+
+	ParticleStore<3> store;
+	store.push_back(Particle<3>(Tuple<3>(1., 2., 3.), 2.));
+	store[0].vel += Tuple<3>(1., 1., 1.);
+	Particle<3> p = store[0];
+	print("pos:", p.pos, "vel:", p.vel, "invMass:", p.invMass);
+	failed |= magnitude(p.vel - Tuple<3>(1., 1., 1.)) > 0. || p.invMass != .5;
+
+	print("\nSparse Correction Test");
+
+	// Only corrected particles get an entry, and applying the corrections empties the table
+	ParticleStore<3> sparse;
+	for (std::uint32_t i = 0; i < 1000; i++)
+		sparse.push_back(Particle<3>(Tuple<3>(), i % 2 ? 2. : 0.));
+	for (std::uint32_t i = 0; i < 1000; i += 100) {
+		sparse[i].m_delta_pos_hard += Tuple<3>(1., 0., 0.);
+		sparse[i + 1].m_delta_pos += Tuple<3>(1., 0., 0.);
+		sparse[i + 1].m_delta_pos += Tuple<3>(1., 0., 0.);
+	}
+	Tuple<3> untouched = sparse[2].m_delta_vel, touched = sparse[1].m_delta_pos;
+	std::uint32_t entries = sparse.corrections.size();
+	sparse.integrate(0.);
+	print("entries:", entries, "untouched:", untouched, "touched:", touched, "entries after integrating:", sparse.corrections.size(),
+		"static pos:", sparse.pos[100], "dynamic pos:", sparse.pos[101]);
+	failed |= entries != 20 || magnitude(untouched) != 0. || touched.x != 2. || sparse.corrections.size() != 0;
+	failed |= sparse.pos[100].x != 1. || sparse.pos[101].x != 1. || sparse.pos[2].x != 0.;
+
+	print("\nPartition Test");
+
+	// Partitioning moves static particles last without changing how any particle moves,
+	//	and a static particle with a velocity keeps moving
+	std::vector<Particle<3> > reference;
+	ParticleStore<3> partitioned;
+	for (std::uint32_t i = 0; i < 50; i++) {
+		Particle<3> p(random_unit<3>() * i, i % 7 == 0 ? random_unit<3>() : Tuple<3>(), i % 3 ? 1. + i : 0.);
+		reference.push_back(p);
+		partitioned.push_back(p);
+	}
+	std::vector<std::uint32_t> new_index;
+	bool was_partitioned = partitioned.isPartitioned();
+	partitioned.partition(new_index);
+	for (std::uint32_t c = 0; c < 20; c++) {
+		for (std::uint32_t i = 0; i < 50; i++) {
+			Tuple<3> force = random_unit<3>(), correction = random_unit<3>() * .01;
+			reference[i].F += force;
+			partitioned[new_index[i]].F += force;
+			if (i % 10 == 0) {
+				reference[i].m_delta_vel_hard += correction;
+				partitioned[new_index[i]].m_delta_vel_hard += correction;
+			}
+		}
+		for (Particle<3>& p : reference)
+			p.update(.01);
+		partitioned.integrate(.01);
+	}
+	double partition_error = 0.;
+	std::uint32_t misplaced = 0;
+	for (std::uint32_t i = 0; i < 50; i++) {
+		partition_error = std::max(partition_error, magnitude(reference[i].pos - partitioned.pos[new_index[i]]));
+		misplaced += (new_index[i] < partitioned.dynamicCount()) != (i % 3 != 0);
+	}
+	print("partitioned before:", was_partitioned, "dynamic:", partitioned.dynamicCount(), "misplaced:", misplaced, "max error:", partition_error);
+	failed |= was_partitioned || partitioned.dynamicCount() != 33 || misplaced != 0 || partition_error > 1e-12;
+
+	print(failed ? "\nFAILED" : "\nPASSED");
+	return failed ? 1 : 0;
+}
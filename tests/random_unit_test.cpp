@@ -0,0 +1,118 @@
+#include "tuple_batch.h"
+#include <iostream>
+#include <vector>
+#include <random>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+/*
+Check that vectors are unit length and uniformly oriented: for a uniform direction on the N-sphere every
+component has mean 0 and mean square 1 / N, and every pair of components is uncorrelated.
+Return the largest deviation from those moments, or a large number if a vector is not unit length.
+*/
+template <std::uint8_t _Size>
+double momentError(const std::vector<Tuple<_Size> >& v) {
+	double mean[_Size] = {}, second[_Size][_Size] = {};
+	for (const Tuple<_Size>& t : v) {
+		if (std::abs(magnitude(t) - 1.) > 1e-12)
+			return 1e9;
+		for (std::uint8_t a = 0; a < _Size; a++) {
+			mean[a] += t[a] / v.size();
+			for (std::uint8_t b = 0; b < _Size; b++)
+				second[a][b] += t[a] * t[b] / v.size();
+		}
+	}
+
+	double error = 0.;
+	for (std::uint8_t a = 0; a < _Size; a++) {
+		error = std::max(error, std::abs(mean[a]));
+		for (std::uint8_t b = 0; b < _Size; b++)
+			error = std::max(error, std::abs(second[a][b] - (a == b ? 1. / _Size : 0.)));
+	}
+	return error;
+}
+
+// random_unit() with a caller's generator is reproducible and uniform
+template <std::uint8_t _Size>
+bool testRandomUnit(std::uint32_t count) {
+	std::mt19937_64 generator(11), same_generator(11);
+	std::vector<Tuple<_Size> > v;
+	bool reproducible = true;
+
+	for (std::uint32_t i = 0; i < count; i++) {
+		v.push_back(random_unit<_Size>(generator));
+		Tuple<_Size> again = random_unit<_Size>(same_generator);
+		for (std::uint8_t c = 0; c < _Size; c++)
+			reproducible &= again[c] == v.back()[c];
+	}
+
+	double error = momentError(v);
+	print(_Size + 0, "D random_unit(generator)  moment error:", error, " reproducible:", reproducible);
+	return error < .01 && reproducible;
+}
+
+// randomUnitBatch(): uniform, the same with or without a pool, and the same to rounding with either kernel
+template <std::uint8_t _Size>
+bool testRandomUnitBatch(std::uint32_t count, ThreadPool& pool) {
+	std::vector<Tuple<_Size> > portable(count), simd(count), threaded(count);
+
+	randomUnitBatch(portable.data(), count, 99, nullptr, SimdLevel::SCALAR);
+	randomUnitBatch(simd.data(), count, 99, nullptr, simdLevel());
+	randomUnitBatch(threaded.data(), count, 99, &pool, simdLevel());
+
+	double kernel_difference = 0.;
+	std::uint32_t thread_mismatches = 0;
+	for (std::uint32_t i = 0; i < count; i++)
+		for (std::uint8_t c = 0; c < _Size; c++) {
+			kernel_difference = std::max(kernel_difference, std::abs(portable[i][c] - simd[i][c]));
+			thread_mismatches += threaded[i][c] != simd[i][c];
+		}
+
+	// Structure-of-arrays output gets the same vectors
+	std::vector<double> storage(_Size * count);
+	TupleComponents<_Size> view;
+	for (std::uint8_t c = 0; c < _Size; c++)
+		view.component[c] = storage.data() + c * count;
+	randomUnitBatch(view, count, 99, &pool, simdLevel());
+	std::uint32_t layout_mismatches = 0;
+	for (std::uint32_t i = 0; i < count; i++)
+		for (std::uint8_t c = 0; c < _Size; c++)
+			layout_mismatches += view.component[c][i] != simd[i][c];
+
+	double error = std::max(momentError(portable), momentError(simd));
+	print(_Size + 0, "D randomUnitBatch  moment error:", error, " kernel difference:", kernel_difference,
+		" thread mismatches:", thread_mismatches, " layout mismatches:", layout_mismatches);
+	return error < .01 && kernel_difference < 1e-13 && thread_mismatches == 0 && layout_mismatches == 0;
+}
+
+int main() {
+	bool failed = false;
+	ThreadPool pool(4);
+
+	print("Random Unit Vector Test");
+	failed |= !testRandomUnit<1>(20000);
+	failed |= !testRandomUnit<2>(20000);
+	failed |= !testRandomUnit<3>(20000);
+	failed |= !testRandomUnit<7>(20000);
+	print();
+
+	print("Batch Random Unit Vector Test");
+	failed |= !testRandomUnitBatch<1>(50001, pool);
+	failed |= !testRandomUnitBatch<2>(50001, pool);
+	failed |= !testRandomUnitBatch<3>(50001, pool);
+	failed |= !testRandomUnitBatch<4>(50001, pool);
+	failed |= !testRandomUnitBatch<7>(50001, pool);
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,299 @@
+#include "simulator.h"
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+using namespace Brazen;
+
+const double STIFFNESS = 100., REST_LENGTH = 1., DT = 1. / 600.;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Position of the particle with the given index, as of the last cycle
+Tuple<3> position(Simulator<3>& sim, std::uint32_t index) {
+	return sim.getParticle(index).pos;
+}
+
+// A spring pulls stretched particles together with the same damped force ImplicitEuler linearizes
+bool testSpring(void) {
+	ParticleStore<3> store;
+	store.push_back(Particle<3>(Tuple<3>(0., 0., 0.), Tuple<3>(0., 0., 0.), 1.));
+	store.push_back(Particle<3>(Tuple<3>(2., 0., 0.), Tuple<3>(1., 3., 0.), 1.));
+	const Spring<3> spring(0, 1, 10., 1.5, .5);
+
+	spring.update(store);
+	const double expected = 10. * (2. - 1.5) + .5 * 1.;  // Stretch, plus damping of the speed along the axis only
+	const double error = magnitude(store.F[0] - Tuple<3>(expected, 0., 0.)) + magnitude(store.F[0] + store.F[1]);
+
+	store.pos[1] = store.pos[0];
+	store.F[0].setZero();
+	spring.update(store);
+
+	print("force error:", error, " coincident force:", magnitude(store.F[0]));
+	return error < 1e-12 && magnitude(store.F[0]) == 0.;
+}
+
+// Overlapping objects are pushed apart until they just touch and stop approaching, conserving momentum;
+//	an object with a static member does not move
+bool testObjectCollision(void) {
+	ParticleStore<3> store;
+	const double xs[4] = { -.5, .1, 0., .6 }, vs[4] = { 1., 1., -1., -1. };
+	for (std::uint32_t i = 0; i < 4; i++)
+		store.push_back(Particle<3>(Tuple<3>(xs[i], 0., 0.), Tuple<3>(vs[i], 0., 0.), 1.));
+	const std::vector<std::uint32_t> a = { 0, 1 }, b = { 2, 3 };
+
+	const bool collided = resolveObjectCollision(store, a, b);
+	store.applyCorrections();
+	const ObjectSphere<3> sphere_a(store, a), sphere_b(store, b);
+	const double gap = magnitude(sphere_b.center - sphere_a.center) - sphere_a.radius - sphere_b.radius;
+	const double momentum = magnitude(store.vel[0] + store.vel[1] + store.vel[2] + store.vel[3]);
+	const bool stopped = magnitude(sphere_a.vel) < 1e-12 && magnitude(sphere_b.vel) < 1e-12;
+	const bool apart = !resolveObjectCollision(store, a, b);
+
+	// Same collision against an immovable object: the other takes all of the separation and leaves with its velocity
+	for (std::uint32_t i = 0; i < 4; i++) {
+		store.pos[i] = Tuple<3>(xs[i], 0., 0.);
+		store.vel[i] = Tuple<3>(vs[i], 0., 0.);
+	}
+	store.invMass[3] = 0.;
+	resolveObjectCollision(store, a, b);
+	store.applyCorrections();
+	const bool immovable = store.pos[2][0] == 0. && store.pos[3][0] == .6 && std::abs(store.pos[0][0] + .6) < 1e-12
+		&& magnitude(store.vel[1] - store.vel[3]) < 1e-12;
+
+	print("collided:", collided, " gap:", gap, " momentum:", momentum, " stopped:", stopped, " apart after:", apart, " against immovable:", immovable);
+	return collided && std::abs(gap) < 1e-12 && momentum < 1e-12 && stopped && apart && immovable;
+}
+
+// Two objects sliding into each other stop where their spheres touch, and stay there
+bool testObjects(void) {
+	Simulator<3> sim;
+	const double xs[4] = { -2., -1., 1., 2. }, vs[4] = { 1., 1., -1., -1. };
+	for (std::uint32_t i = 0; i < 4; i++)
+		sim.addParticle(Particle<3>(Tuple<3>(xs[i], 0., 0.), Tuple<3>(vs[i], 0., 0.), 1.));
+	const bool created = sim.createObject({ 0, 1 }, Spring<3>(0, 0, STIFFNESS, REST_LENGTH)).ok()
+		&& sim.createObject({ 2, 3 }, { SpringEdge{ 0, 1 } }, Spring<3>(0, 0, STIFFNESS, REST_LENGTH)).ok();  // The same pair, as an edge list
+
+	// The spheres start 2 apart and close at 2 per second, so they meet after 600 cycles and have stopped by 900
+	Tuple<3> pos[4], stopped[4];
+	double min_gap = 2.;
+	for (std::uint32_t cycle = 1; cycle <= 1200; cycle++) {
+		sim.updateState(DT);
+		for (std::uint32_t i = 0; i < 4; i++)
+			pos[i] = position(sim, i);
+		min_gap = std::min(min_gap, magnitude(pos[2] + pos[3] - pos[0] - pos[1]) * .5 - magnitude(pos[1] - pos[0]) * .5 - magnitude(pos[3] - pos[2]) * .5);
+		if (cycle == 900)
+			for (std::uint32_t i = 0; i < 4; i++)
+				stopped[i] = pos[i];
+	}
+	const double gap = magnitude(pos[2] + pos[3] - pos[0] - pos[1]) * .5 - magnitude(pos[1] - pos[0]) * .5 - magnitude(pos[3] - pos[2]) * .5;
+	double drift = 0.;
+	for (std::uint32_t i = 0; i < 4; i++)
+		drift += magnitude(pos[i] - stopped[i]);
+	const bool summarized = sim.getObjectCount() == 2 && magnitude(sim.getObjectCentroid(1) - (pos[2] + pos[3]) * .5) < 1e-9
+		&& std::abs(sim.getObjectBounds(0).min[0] - pos[0][0]) < 1e-9 && std::abs(sim.getObjectBounds(0).max[0] - pos[1][0]) < 1e-9;
+
+	print("closest:", min_gap, " final gap:", gap, " drift after stopping:", drift, " object summaries:", summarized);
+	return created && min_gap > -.01 && std::abs(gap) < .01 && drift < 1e-6 && summarized;
+}
+
+// A particle on a spring from a static anchor oscillates: the explicit integrators keep its energy, implicit Euler only loses it
+template <template <std::uint8_t, typename> class _Integrator>
+bool testIntegrator(const char* name, bool conserves_energy) {
+	Simulator<3, double, _Integrator> sim;
+	sim.addParticle(Particle<3>(Tuple<3>(0., 0., 0.), 0.));
+	sim.addParticle(Particle<3>(Tuple<3>(1.2, 0., 0.), 1.));
+	const bool attached = sim.attachParticles(Spring<3>(0, 1, STIFFNESS, REST_LENGTH)).ok();
+
+	double min_x = 1.2;
+	for (std::uint32_t cycle = 0; cycle < 600; cycle++) {
+		sim.updateState(DT);
+		min_x = std::min(min_x, sim.getParticle(1).pos[0]);
+	}
+	const Particle<3> p = sim.getParticle(1), anchor = sim.getParticle(0);
+	const double stretch = magnitude(p.pos) - REST_LENGTH;
+	const double energy = .5 * magnitudeSquared(p.vel) + .5 * STIFFNESS * stretch * stretch, initial = .5 * STIFFNESS * .2 * .2;
+
+	const bool energy_ok = conserves_energy ? std::abs(energy - initial) < .02 * initial : energy < initial;
+	print(name, " lowest x:", min_x, " energy:", energy, "of", initial, " anchor moved:", magnitude(anchor.pos));
+	return attached && min_x < .85 && energy_ok && magnitude(anchor.pos) == 0.;
+}
+
+// Each cycle publishes the positions in the order particles were added, once
+bool testOutput(void) {
+	Simulator<3> sim;
+	std::vector<Particle<3> > particles;
+	for (std::uint32_t i = 0; i < 10; i++)
+		particles.push_back(Particle<3>(Tuple<3>((double)i, 0., 0.), Tuple<3>(0., 1., 0.), i % 3 ? 1. : 0.));  // Static ones get partitioned last
+	sim.addParticles(particles.begin(), particles.end());
+
+	const bool before = sim.updateOutput();
+	sim.updateState(DT);
+	const bool published = sim.updateOutput(), again = sim.updateOutput();
+	const std::vector<OutputParticle<3> >& output = sim.getOutput();
+
+	bool matches = output.size() == 10;
+	for (std::uint32_t i = 0; matches && i < 10; i++)
+		matches = magnitude(output[i].pos - sim.getParticle(i).pos) == 0. && output[i].pos[0] == (double)i;
+
+	print("new output before a cycle:", before, " after:", published, " twice:", again, " matches particles:", matches);
+	return !before && published && !again && matches;
+}
+
+// Once every output list has grown to the particle count, publishing stops allocating, whether or not the reader keeps up
+bool testOutputAllocations(void) {
+	const std::uint32_t WARM_UP = 10, CYCLES = 200;
+	Simulator<3> sim;
+	std::vector<Particle<3> > particles;
+	for (std::uint32_t i = 0; i < 1000; i++)
+		particles.push_back(Particle<3>(Tuple<3>((double)i, 0., 0.), Tuple<3>(1., 0., 0.), 1.));
+	sim.addParticles(particles.begin(), particles.end());
+
+	for (std::uint32_t cycle = 0; cycle < WARM_UP; cycle++) {
+		sim.updateState(DT);
+		sim.updateOutput();
+	}
+	const std::uint64_t warm = sim.getOutputAllocationCount();
+
+	for (std::uint32_t cycle = 0; cycle < CYCLES; cycle++) {
+		sim.updateState(DT);
+		if (cycle % 3 == 0)  // A reader that skips cycles
+			sim.updateOutput();
+	}
+	const std::uint64_t steady = sim.getOutputAllocationCount();
+
+	print("allocations after warm-up:", warm, " after", CYCLES, "more cycles:", steady);
+	return warm > 0 && steady == warm;
+}
+
+// Queued edits land at the start of the next cycle, with the indices they were queued with
+bool testCommandQueue(void) {
+	Simulator<3> sim;
+	std::vector<Particle<3> > particles;
+	for (std::uint32_t i = 0; i < 4; i++)
+		particles.push_back(Particle<3>(Tuple<3>(3. * i, 0., 0.), 1.));
+
+	const std::uint32_t first = sim.queueParticles(particles.begin(), particles.end());
+	const bool spring = sim.queueSprings({ Spring<3>(first, first + 1, STIFFNESS, 3.) }).ok();
+	const bool object = sim.queueObject({ first + 2, first + 3 }, { SpringEdge{ 0, 1 } }, Spring<3>(0, 0, STIFFNESS, 3.)).ok();
+	const bool rejected = !VALIDATION_ENABLED || sim.queueSprings({ Spring<3>(first, 99, STIFFNESS, 1.) }).error() == ErrorCode::INVALID_PARTICLE_INDEX;
+	const std::uint32_t queued = sim.getParticleCount();
+
+	sim.updateState(DT);
+	const std::uint32_t applied = sim.getParticleCount(), objects = sim.getObjectCount();
+
+	print("first index:", first, " accepted:", spring && object, " rejected:", rejected, " particles before a cycle:", queued,
+		" after:", applied, " objects:", objects);
+	return first == 0 && spring && object && rejected && queued == 0 && applied == 4 && objects == 1;
+}
+
+// A resting pair falls asleep after the quiet cycles while a moving particle stays awake, and an impulse wakes the pair
+bool testSleeping(void) {
+	const std::uint32_t CYCLES = 5;
+	Simulator<3> sim;
+	sim.addParticle(Particle<3>(Tuple<3>(0., 0., 0.), 1.));
+	sim.addParticle(Particle<3>(Tuple<3>(REST_LENGTH, 0., 0.), 1.));
+	sim.addParticle(Particle<3>(Tuple<3>(5., 0., 0.), Tuple<3>(1., 0., 0.), 1.));
+	sim.attachParticles(Spring<3>(0, 1, STIFFNESS, REST_LENGTH));
+	sim.setSleepThreshold(1e-8, CYCLES);
+
+	std::uint32_t cycles_to_sleep = 0;
+	for (std::uint32_t cycle = 1; cycle <= 2 * CYCLES && !cycles_to_sleep; cycle++) {
+		sim.updateState(DT);
+		if (sim.isParticleAsleep(0))
+			cycles_to_sleep = cycle;
+	}
+	const bool slept = sim.getSleepingParticleCount() == 2 && sim.isParticleAsleep(1) && !sim.isParticleAsleep(2);
+	const double moving_x = sim.getParticle(2).pos[0];
+
+	const bool woke = sim.applyImpulse(1, Tuple<3>(0., 1., 0.)).ok() && !sim.isParticleAsleep(0);
+	sim.updateState(DT);
+	const bool moved = sim.getParticle(1).pos[1] > 0. && sim.getSleepingParticleCount() == 0;
+
+	print("cycles to sleep:", cycles_to_sleep, " pair asleep, mover awake:", slept, " mover x:", moving_x, " impulse woke:", woke, " moved:", moved);
+	return cycles_to_sleep == CYCLES && slept && moving_x > 5. && woke && moved;
+}
+
+// A non-positive cycle rate is ignored, in the constructor as in "setCycleRate()"
+bool testCycleRate(void) {
+	Simulator<3> zero(0.), negative(-30.), fast(120.);
+	fast.setCycleRate(-1.);
+
+	print("rates:", zero.getTargetCycleRate(), negative.getTargetCycleRate(), fast.getTargetCycleRate());
+	return zero.getTargetCycleRate() == 60. && negative.getTargetCycleRate() == 60. && fast.getTargetCycleRate() == 120.;
+}
+
+// The physics thread runs cycles at the target rate until stopped, and publishes output for the reader
+bool testPhysicsThread(void) {
+	const double RATE = 200.;
+	Simulator<3> sim(RATE);
+	sim.addParticle(Particle<3>(Tuple<3>(0., 0., 0.), Tuple<3>(1., 0., 0.), 1.));
+
+	sim.start();
+	const bool running = sim.isRunning();
+	std::this_thread::sleep_for(std::chrono::milliseconds(1300));  // The achieved rate is measured over a second
+	sim.stop();
+
+	const std::uint64_t cycles = sim.getCycleCount();
+	const double achieved = sim.getAchievedCycleRate();
+	const bool published = sim.updateOutput() && sim.getOutput().size() == 1 && sim.getOutput()[0].pos[0] > 0.;
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	const bool stopped = !sim.isRunning() && sim.getCycleCount() == cycles;
+
+	print("running:", running, " cycles:", cycles, " achieved rate:", achieved, " dropped:", sim.getDroppedCycleCount(),
+		" published:", published, " stopped:", stopped);
+	return running && cycles > RATE && cycles < 1.5 * RATE && std::abs(achieved - RATE) < .2 * RATE && published && stopped;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Spring Test");
+	failed |= !testSpring();
+	print();
+
+	print("Object Collision Test");
+	failed |= !testObjectCollision();
+	failed |= !testObjects();
+	print();
+
+	print("Integrator Test");
+	failed |= !testIntegrator<SymplecticEuler>("symplectic Euler", true);
+	failed |= !testIntegrator<PositionVerlet>("position Verlet", true);
+	failed |= !testIntegrator<VelocityVerlet>("velocity Verlet", true);
+	failed |= !testIntegrator<RungeKutta4>("Runge-Kutta 4", true);
+	failed |= !testIntegrator<ImplicitEuler>("implicit Euler", false);
+	print();
+
+	print("Output Test");
+	failed |= !testOutput();
+	failed |= !testOutputAllocations();
+	print();
+
+	print("Command Queue Test");
+	failed |= !testCommandQueue();
+	print();
+
+	print("Sleeping Test");
+	failed |= !testSleeping();
+	print();
+
+	print("Cycle Rate Test");
+	failed |= !testCycleRate();
+	print();
+
+	print("Physics Thread Test");
+	failed |= !testPhysicsThread();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+#include "spring_coloring.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Minimal stand-in for Spring: only the particle indices matter for coloring
+struct TestSpring {
+	std::uint32_t p1_index, p2_index;
+
+	bool operator<(const TestSpring& s) const {
+		return p1_index < s.p1_index || (p1_index == s.p1_index && p2_index < s.p2_index);
+	}
+	bool operator==(const TestSpring& s) const {
+		return p1_index == s.p1_index && p2_index == s.p2_index;
+	}
+};
+
+// Color the springs and check that no color touches a particle twice and that no spring was lost
+bool testColoring(const char* name, std::vector<TestSpring> springs, std::uint32_t particle_count) {
+	std::vector<TestSpring> original = springs;
+	SpringColoring coloring;
+	coloring.build(springs, particle_count);
+
+	bool valid = true;
+	std::vector<std::uint32_t> last_color(particle_count, 0xFFFFFFFF);
+	for (std::uint32_t c = 0; c < coloring.colorCount(); c++)
+		for (std::uint32_t s = coloring.begin(c); s < coloring.end(c); s++) {
+			valid &= last_color[springs[s].p1_index] != c && last_color[springs[s].p2_index] != c;
+			last_color[springs[s].p1_index] = c;
+			last_color[springs[s].p2_index] = c;
+		}
+
+	std::sort(original.begin(), original.end());
+	std::sort(springs.begin(), springs.end());
+	valid &= original == springs && coloring.end(coloring.colorCount() - 1) == springs.size();
+
+	print(name, springs.size(), "springs,", coloring.colorCount(), "colors, valid:", valid);
+	return valid;
+}
+
+int main() {
+	bool failed = false;
+	std::default_random_engine generator(7);
+
+	print("Spring Coloring Test");
+
+	// Fully connected blob, as built by Simulator::createObject(indices, spring)
+	std::vector<TestSpring> blob;
+	for (std::uint32_t i = 0; i < 50; i++)
+		for (std::uint32_t j = i + 1; j < 50; j++)
+			blob.push_back(TestSpring{ i, j });
+	failed |= !testColoring("Fully connected:", blob, 50);
+
+	// Chain, as in a slinky
+	std::vector<TestSpring> chain;
+	for (std::uint32_t i = 0; i + 1 < 1000; i++)
+		chain.push_back(TestSpring{ i, i + 1 });
+	failed |= !testColoring("Chain:", chain, 1000);
+
+	// Random sparse graph
+	std::vector<TestSpring> sparse;
+	std::uniform_int_distribution<std::uint32_t> particle(0, 9999);
+	for (std::uint32_t i = 0; i < 30000; i++) {
+		std::uint32_t a = particle(generator), b = particle(generator);
+		if (a != b)
+			sparse.push_back(TestSpring{ a, b });
+	}
+	failed |= !testColoring("Random sparse:", sparse, 10000);
+
+	print(failed ? "\nFAILED" : "\nPASSED");
+	return failed ? 1 : 0;
+}
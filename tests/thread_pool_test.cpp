@@ -0,0 +1,91 @@
+#include "thread_pool.h"
+#include <iostream>
+#include <vector>
+#include <atomic>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Run many phases over the same array and check that every iteration ran exactly once per phase
+bool testPhases(std::uint32_t thread_count, std::uint32_t size, std::uint32_t chunk, std::uint32_t phases) {
+	ThreadPool pool(thread_count);
+	std::vector<std::uint32_t> counts(size, 0);
+
+	for (std::uint32_t phase = 0; phase < phases; phase++)
+		pool.parallelFor(0, size, chunk, [&counts, phase](std::uint32_t begin, std::uint32_t end) {
+			for (std::uint32_t i = begin; i < end; i++)
+				counts[i] += counts[i] == phase;  // Only counts if the previous phase finished first
+		});
+
+	std::uint32_t wrong = 0;
+	for (std::uint32_t c : counts)
+		wrong += c != phases;
+
+	print(pool.threadCount(), "threads,", size, "iterations, chunk", chunk, "wrong:", wrong);
+	return wrong == 0;
+}
+
+// Chunks of very different cost must still all run (exercises stealing)
+bool testUnevenWork(std::uint32_t thread_count) {
+	ThreadPool pool(thread_count);
+	std::vector<double> results(256, 0.);
+
+	pool.parallelFor(0, 256, 1, [&results](std::uint32_t begin, std::uint32_t) {
+		double sum = 0.;
+		for (std::uint32_t k = 0; k < (begin < 8 ? 200000u : 10u); k++)
+			sum += k;
+		results[begin] = sum;
+	});
+
+	std::uint32_t missing = 0;
+	for (double r : results)
+		missing += r == 0.;
+
+	print(pool.threadCount(), "threads, uneven chunks, missing:", missing);
+	return missing == 0;
+}
+
+// Ranges near the top of the 32-bit index space must be split without the chunk bounds wrapping around
+bool testHighRange(std::uint32_t thread_count, std::uint32_t begin, std::uint32_t chunk) {
+	ThreadPool pool(thread_count);
+	const std::uint32_t end = 0xFFFFFFFFu;
+	std::atomic<std::uint64_t> covered(0);
+	std::atomic<std::uint32_t> bad(0);
+
+	pool.parallelFor(begin, end, chunk, [&covered, &bad](std::uint32_t first, std::uint32_t last) {
+		if (first >= last)
+			bad++;
+		covered += last - first;
+	});
+
+	print(pool.threadCount(), "threads, [", begin, ",", end, "), chunk", chunk, "covered:", covered.load(), "bad chunks:", bad.load());
+	return covered == end - begin && bad == 0;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Phase Barrier Test");
+	failed |= !testPhases(1, 10000, 64, 50);
+	failed |= !testPhases(4, 10000, 64, 50);
+	failed |= !testPhases(8, 100003, 1000, 50);
+	failed |= !testPhases(4, 5, 64, 50);
+
+	print("\nWork Stealing Test");
+	failed |= !testUnevenWork(4);
+
+	print("\nHigh Range Test");
+	failed |= !testHighRange(4, 0x7FFFFFFFu, 0x30000000u);
+	failed |= !testHighRange(4, 0xFFFFFFFFu - 100000u, 1000);
+
+	print(failed ? "\nFAILED" : "\nPASSED");
+	return failed ? 1 : 0;
+}
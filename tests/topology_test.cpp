@@ -0,0 +1,155 @@
+#include "topology.h"
+#include <cmath>
+#include <vector>
+#include <random>
+#include <stdexcept>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+// Return the rank of the rigidity matrix of the given framework: one row per edge, the edge direction
+//	against its first particle's coordinates and its negation against its second's
+template <std::uint8_t _Size>
+std::uint32_t rigidityRank(const std::vector<Tuple<_Size> >& points, const std::vector<SpringEdge>& edges) {
+	const std::uint32_t columns = _Size * (std::uint32_t)points.size();
+	std::vector<std::vector<double> > rows;
+	for (const SpringEdge& edge : edges) {
+		std::vector<double> row(columns, 0.);
+		Tuple<_Size> d = points[edge.p2_index] - points[edge.p1_index];
+		for (std::uint8_t i = 0; i < _Size; i++) {
+			row[edge.p1_index * _Size + i] = -d[i];
+			row[edge.p2_index * _Size + i] = d[i];
+		}
+		rows.push_back(row);
+	}
+
+	std::uint32_t rank = 0;
+	for (std::uint32_t c = 0; c < columns && rank < rows.size(); c++) {
+		std::uint32_t pivot = rank;
+		for (std::uint32_t r = rank; r < rows.size(); r++)
+			if (std::abs(rows[r][c]) > std::abs(rows[pivot][c]))
+				pivot = r;
+		if (std::abs(rows[pivot][c]) < 1e-9)
+			continue;
+		std::swap(rows[pivot], rows[rank]);
+		for (std::uint32_t r = rank + 1; r < rows.size(); r++) {
+			double factor = rows[r][c] / rows[rank][c];
+			for (std::uint32_t k = c; k < columns; k++)
+				rows[r][k] -= factor * rows[rank][k];
+		}
+		rank++;
+	}
+	return rank;
+}
+
+// A framework of n points in general position is rigid when its rigidity matrix has rank _Size n - _Size (_Size + 1) / 2
+template <std::uint8_t _Size>
+bool isRigid(const std::vector<Tuple<_Size> >& points, const std::vector<SpringEdge>& edges) {
+	return rigidityRank<_Size>(points, edges) == _Size * points.size() - _Size * (_Size + 1) / 2;
+}
+
+bool testLattices(void) {
+	const std::array<std::uint32_t, 2> square = { { 3, 3 } };
+	const std::array<std::uint32_t, 3> cube = { { 2, 2, 2 } }, block = { { 3, 4, 3 } };
+	const std::array<std::uint32_t, 4> tesseract = { { 2, 2, 2, 2 } };
+
+	const std::uint32_t square_edges = (std::uint32_t)latticeEdges<2>(square, false).size();
+	const std::uint32_t triangulated_square_edges = (std::uint32_t)latticeEdges<2>(square, true).size();
+	const std::uint32_t cube_edges = (std::uint32_t)latticeEdges<3>(cube, true).size();
+	const std::uint32_t tesseract_edges = (std::uint32_t)latticeEdges<4>(tesseract, false).size();
+	print("3x3 grid:", square_edges, "edges,", triangulated_square_edges, "triangulated  2x2x2 triangulated:", cube_edges,
+		" 2^4 grid:", tesseract_edges);
+
+	std::vector<Tuple<3> > points = latticePoints<3>(block, .5, Tuple<3>(1., 2., 3.));
+	const bool placed = points.size() == 36 && magnitude(points[1] - Tuple<3>(1.5, 2., 3.)) < 1e-12 && magnitude(points[3] - Tuple<3>(1., 2.5, 3.)) < 1e-12;
+	const bool rigid = isRigid<3>(points, latticeEdges<3>(block, true));
+	const bool plain_floppy = !isRigid<3>(points, latticeEdges<3>(block, false));
+	print("points placed:", placed, " triangulated lattice rigid:", rigid, " plain lattice floppy:", plain_floppy);
+
+	return square_edges == 12 && triangulated_square_edges == 16 && cube_edges == 19 && tesseract_edges == 32
+		&& placed && rigid && plain_floppy;
+}
+
+// The sweeps must find exactly the edges a brute force search finds
+bool testNeighbors(void) {
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<double> coordinate(-1., 1.);
+	std::vector<Tuple<3> > points(300);
+	for (Tuple<3>& p : points)
+		p = Tuple<3>(coordinate(generator), .5 * coordinate(generator), .2 * coordinate(generator));
+
+	const std::uint32_t k = 6;
+	const double max_distance = .25;
+	std::vector<SpringEdge> nearest_brute, distance_brute;
+	for (std::uint32_t i = 0; i < points.size(); i++) {
+		std::vector<std::pair<double, std::uint32_t> > by_distance;
+		for (std::uint32_t j = 0; j < points.size(); j++)
+			if (j != i) {
+				by_distance.push_back(std::make_pair(magnitudeSquared(points[j] - points[i]), j));
+				if (j > i && magnitude(points[j] - points[i]) <= max_distance)
+					distance_brute.push_back(SpringEdge{ i, j });
+			}
+		std::sort(by_distance.begin(), by_distance.end());
+		for (std::uint32_t n = 0; n < k; n++)
+			nearest_brute.push_back(SpringEdge{ i, by_distance[n].second });
+	}
+	normalizeEdges(nearest_brute);
+	normalizeEdges(distance_brute);
+
+	std::vector<SpringEdge> nearest = kNearestEdges(points, k), distance = distanceEdges(points, max_distance);
+	std::uint32_t mismatches = (std::uint32_t)(nearest.size() != nearest_brute.size()) + (distance.size() != distance_brute.size());
+	for (std::uint32_t e = 0; e < nearest.size() && e < nearest_brute.size(); e++)
+		mismatches += nearest[e].p1_index != nearest_brute[e].p1_index || nearest[e].p2_index != nearest_brute[e].p2_index;
+	for (std::uint32_t e = 0; e < distance.size() && e < distance_brute.size(); e++)
+		mismatches += distance[e].p1_index != distance_brute[e].p1_index || distance[e].p2_index != distance_brute[e].p2_index;
+
+	const bool rigid = isRigid<3>(std::vector<Tuple<3> >(points.begin(), points.begin() + 60),
+		kNearestEdges(std::vector<Tuple<3> >(points.begin(), points.begin() + 60), 9));
+	print(k, "nearest:", nearest.size(), "edges  within", max_distance, ":", distance.size(), "edges  mismatches:", mismatches,
+		" 9 nearest of 60 points rigid:", rigid, " fully connected 300:", fullyConnectedEdges(300).size(), "edges");
+	return mismatches == 0 && rigid && fullyConnectedEdges(300).size() == 300 * 299 / 2;
+}
+
+// Edge counts past 32 bits must be rejected instead of wrapping, and k larger than the rest of the positions capped
+bool testEdgeCounts(void) {
+	bool rejected = false;
+	try {
+		fullyConnectedEdges(100000);  // ~5e9 edges
+	}
+	catch (const std::length_error& e) {
+		rejected = true;
+		print(e.what());
+	}
+
+	const std::vector<Tuple<3> > points = { Tuple<3>(0., 0., 0.), Tuple<3>(1., 0., 0.), Tuple<3>(0., 1., 0.) };
+	const std::size_t capped = kNearestEdges(points, 0xFFFFFFFFu).size();
+	print("100000 fully connected rejected:", rejected, " 3 points with k = 2^32 - 1:", capped, "edges");
+	return rejected && capped == 3;
+}
+
+int main() {
+	bool failed = false;
+
+	print("Lattice Test");
+	failed |= !testLattices();
+	print();
+
+	print("Neighbor Test");
+	failed |= !testNeighbors();
+	print();
+
+	print("Edge Count Test");
+	failed |= !testEdgeCounts();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
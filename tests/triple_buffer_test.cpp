@@ -0,0 +1,64 @@
+#include "triple_buffer.h"
+#include <array>
+#include <iostream>
+#include <thread>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+int main() {
+	const std::uint32_t PUBLISH_COUNT = 1000000;
+	TripleBuffer<std::array<std::uint32_t, 16> > buffer;
+	bool failed = false;
+
+	print("Empty Update Test");
+	bool updated = buffer.update();
+	print("update():", updated);
+	failed |= updated;
+
+	print("\nSingle Publish Test");
+	buffer.writeBuffer().fill(7);
+	buffer.publish();
+	updated = buffer.update();
+	print("update():", updated, "value:", buffer.readBuffer()[0]);
+	failed |= !updated || buffer.readBuffer()[0] != 7;
+	updated = buffer.update();
+	print("update() again:", updated);
+	failed |= updated;
+
+	print("\nConcurrent Publish Test");
+	std::thread producer([&buffer, PUBLISH_COUNT]() {
+		for (std::uint32_t i = 1; i <= PUBLISH_COUNT; i++) {
+			buffer.writeBuffer().fill(i);
+			buffer.publish();
+		}
+	});
+
+	std::uint32_t last = 0, updates = 0;
+	bool torn = false, backwards = false;
+	while (last < PUBLISH_COUNT) {
+		if (buffer.update()) {
+			const std::array<std::uint32_t, 16>& value = buffer.readBuffer();
+			for (std::uint32_t v : value)
+				torn |= v != value[0];
+			backwards |= value[0] <= last;
+			last = value[0];
+			updates++;
+		}
+	}
+	producer.join();
+
+	print("updates:", updates, "last:", last, "torn:", torn, "backwards:", backwards);
+	failed |= torn || backwards || last != PUBLISH_COUNT;
+
+	print(failed ? "\nFAILED" : "\nPASSED");
+	return failed ? 1 : 0;
+}
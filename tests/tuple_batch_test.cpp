@@ -0,0 +1,195 @@
+#include "tuple_batch.h"
+#include "fixed_point.h"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+using namespace Brazen;
+
+const std::uint32_t COUNT = 1003;  // Not a multiple of any vector width, so the leftover loops run too
+const double SCALE = 100.;  // Largest product of two test components, which bounds the rounding of a cancelling dot product
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+template <std::uint8_t _Size, typename _Scalar>
+Tuple<_Size, _Scalar> randomTuple(void) {
+	return Tuple<_Size, _Scalar>(random_unit<_Size>() * (.1 + 10. * rand() / RAND_MAX));
+}
+
+// Return whether a and b differ by no more than rounding. The compiler may contract a * b + c into a fused
+//	multiply-add in one of them and not the other (GCC does by default when targeting FMA), so floating point
+//	results agree to a few ulps of the operands rather than exactly. Other scalar types must match exactly.
+template <typename _Scalar>
+bool sameResult(_Scalar a, _Scalar b) {
+	if constexpr (std::is_floating_point<_Scalar>::value)
+		return std::abs((double)a - (double)b) <= 16. * std::numeric_limits<_Scalar>::epsilon() * (std::abs((double)a) + SCALE);
+	else
+		return a == b;
+}
+
+template <std::uint8_t _Size, typename _Scalar>
+std::uint32_t countMismatches(const std::vector<Tuple<_Size, _Scalar> >& a, const std::vector<Tuple<_Size, _Scalar> >& b) {
+	std::uint32_t mismatches = 0;
+	for (std::uint32_t i = 0; i < a.size(); i++)
+		for (std::uint8_t c = 0; c < _Size; c++)
+			mismatches += !sameResult(a[i][c], b[i][c]);
+	return mismatches;
+}
+
+// Copy an array of Tuple into structure-of-arrays storage and return a view of it.
+template <std::uint8_t _Size, typename _Scalar>
+TupleComponents<_Size, _Scalar> toComponents(const std::vector<Tuple<_Size, _Scalar> >& v, std::vector<_Scalar>& storage) {
+	storage.resize(v.size() * _Size);
+	TupleComponents<_Size, _Scalar> view;
+	for (std::uint8_t c = 0; c < _Size; c++) {
+		view.component[c] = storage.data() + c * v.size();
+		for (std::uint32_t i = 0; i < v.size(); i++)
+			view.component[c][i] = v[i][c];
+	}
+	return view;
+}
+
+template <std::uint8_t _Size, typename _Scalar>
+std::vector<Tuple<_Size, _Scalar> > fromComponents(const TupleComponents<_Size, _Scalar>& view, std::uint32_t count) {
+	std::vector<Tuple<_Size, _Scalar> > out(count);
+	for (std::uint32_t i = 0; i < count; i++)
+		for (std::uint8_t c = 0; c < _Size; c++)
+			out[i][c] = view.component[c][i];
+	return out;
+}
+
+// Every batch function, in both layouts, must match the single-tuple functions up to rounding (exactly for fixed point).
+template <std::uint8_t _Size, typename _Scalar>
+bool testBatch(const char* scalar_name, SimdLevel level, ThreadPool* pool) {
+	std::vector<Tuple<_Size, _Scalar> > a, b;
+	for (std::uint32_t i = 0; i < COUNT; i++) {
+		a.push_back(randomTuple<_Size, _Scalar>());
+		b.push_back(randomTuple<_Size, _Scalar>());
+	}
+	const _Scalar s = .375;
+
+	std::vector<Tuple<_Size, _Scalar> > expected_axpy(b), expected_unit, expected_projection;
+	std::vector<_Scalar> expected_dot, expected_magnitude;
+	for (std::uint32_t i = 0; i < COUNT; i++) {
+		expected_axpy[i] += a[i] * s;
+		expected_dot.push_back(dot(a[i], b[i]));
+		expected_magnitude.push_back(magnitude(a[i]));
+		expected_unit.push_back(unit(a[i]));
+		expected_projection.push_back(projection_vector(a[i], b[i]));
+	}
+
+	std::uint32_t mismatches = 0;
+
+	// Arrays of Tuple
+	std::vector<Tuple<_Size, _Scalar> > tuples(b);
+	std::vector<_Scalar> scalars(COUNT);
+	axpyBatch(s, a.data(), tuples.data(), COUNT, pool, level);
+	mismatches += countMismatches(tuples, expected_axpy);
+	dotBatch(a.data(), b.data(), scalars.data(), COUNT, pool);
+	for (std::uint32_t i = 0; i < COUNT; i++)
+		mismatches += !sameResult(scalars[i], expected_dot[i]);
+	magnitudeBatch(a.data(), scalars.data(), COUNT, pool);
+	for (std::uint32_t i = 0; i < COUNT; i++)
+		mismatches += !sameResult(scalars[i], expected_magnitude[i]);
+	unitBatch(a.data(), tuples.data(), COUNT, pool);
+	mismatches += countMismatches(tuples, expected_unit);
+	projectionVectorBatch(a.data(), b.data(), tuples.data(), COUNT, pool);
+	mismatches += countMismatches(tuples, expected_projection);
+
+	// Structures of arrays
+	std::vector<_Scalar> a_storage, b_storage, out_storage;
+	TupleComponents<_Size, _Scalar> a_view = toComponents(a, a_storage), b_view = toComponents(b, b_storage);
+	TupleComponents<_Size, _Scalar> out_view = toComponents(b, out_storage);
+	axpyBatch(s, a_view, out_view, COUNT, pool, level);
+	mismatches += countMismatches(fromComponents(out_view, COUNT), expected_axpy);
+	dotBatch(a_view, b_view, scalars.data(), COUNT, pool, level);
+	for (std::uint32_t i = 0; i < COUNT; i++)
+		mismatches += !sameResult(scalars[i], expected_dot[i]);
+	magnitudeBatch(a_view, scalars.data(), COUNT, pool, level);
+	for (std::uint32_t i = 0; i < COUNT; i++)
+		mismatches += !sameResult(scalars[i], expected_magnitude[i]);
+	unitBatch(a_view, out_view, COUNT, pool, level);
+	mismatches += countMismatches(fromComponents(out_view, COUNT), expected_unit);
+	projectionVectorBatch(a_view, b_view, out_view, COUNT, pool, level);
+	mismatches += countMismatches(fromComponents(out_view, COUNT), expected_projection);
+
+	// In place
+	unitBatch(a_view, a_view, COUNT, pool, level);
+	mismatches += countMismatches(fromComponents(a_view, COUNT), expected_unit);
+
+	print(_Size + 0, "D", scalar_name, simdLevelName(level), pool ? "threaded" : "", "mismatches:", mismatches);
+	return mismatches == 0;
+}
+
+// A zero vector inside a SIMD block must still come out as a unit vector (the random one "unit()" fakes)
+template <typename _Scalar>
+bool testUnitOfZero(SimdLevel level) {
+	std::vector<Tuple<3, _Scalar> > v(16, Tuple<3, _Scalar>(1., 2., 2.));
+	v[5] = Tuple<3, _Scalar>();
+	std::vector<_Scalar> storage;
+	TupleComponents<3, _Scalar> view = toComponents(v, storage);
+
+	unitBatch(view, view, 16, nullptr, level);
+	std::vector<Tuple<3, _Scalar> > out = fromComponents(view, 16);
+
+	double error = std::abs((double)magnitude(out[5]) - 1.) + std::abs((double)out[0][1] - 2. / 3.);
+	print("unit of zero,", simdLevelName(level), "error:", error);
+	return error < 1e-6;
+}
+
+// Fixed32 division by zero saturates rather than trapping, so projecting onto the zero vector gives the zero vector
+bool testFixedDivisionByZero(void) {
+	const Fixed32 zero, three(3.);
+	const bool saturated = three / zero == Fixed32::fromRaw(std::numeric_limits<std::int32_t>::max())
+		&& -three / zero == Fixed32::fromRaw(std::numeric_limits<std::int32_t>::min()) && zero / zero == zero;
+	const Tuple<3, Fixed32> projected = projection_vector(Tuple<3, Fixed32>(1., 2., 2.), Tuple<3, Fixed32>());
+
+	print("Fixed32 division by zero saturated:", saturated, " projection onto zero:", projected);
+	return saturated && projected.x == zero && projected.y == zero && projected.z == zero;
+}
+
+template <typename _Scalar>
+bool testScalarType(const char* scalar_name, ThreadPool* pool) {
+	bool failed = false;
+
+	for (SimdLevel level : { SimdLevel::SCALAR, simdLevel() }) {
+		failed |= !testBatch<1, _Scalar>(scalar_name, level, pool);
+		failed |= !testBatch<2, _Scalar>(scalar_name, level, pool);
+		failed |= !testBatch<3, _Scalar>(scalar_name, level, pool);
+		failed |= !testBatch<4, _Scalar>(scalar_name, level, pool);
+		failed |= !testBatch<7, _Scalar>(scalar_name, level, pool);
+	}
+
+	return !failed;
+}
+
+int main() {
+	bool failed = false;
+	ThreadPool pool(4);
+
+	print("Batch Tuple Functions Test");
+	failed |= !testScalarType<double>("double", nullptr);
+	failed |= !testScalarType<double>("double", &pool);
+	failed |= !testScalarType<float>("float", nullptr);
+	failed |= !testScalarType<Fixed32>("Fixed32", nullptr);
+	print();
+
+	print("Zero Vector Test");
+	failed |= !testUnitOfZero<double>(SimdLevel::SCALAR);
+	failed |= !testUnitOfZero<double>(simdLevel());
+	failed |= !testUnitOfZero<float>(simdLevel());
+	failed |= !testFixedDivisionByZero();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}
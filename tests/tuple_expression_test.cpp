@@ -0,0 +1,98 @@
+#include "tuple_expression.h"
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <limits>
+
+const double SCALE = 1e4;  // Bound on the terms summed by the test expressions, which bounds the rounding of a cancelling sum
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+template <std::uint8_t _Size>
+Tuple<_Size> randomTuple(std::default_random_engine& generator) {
+	std::uniform_real_distribution<double> distribution(-10., 10.);
+	Tuple<_Size> out(false);
+
+	for (std::uint8_t i = 0; i < _Size; i++)
+		out[i] = distribution(generator);
+
+	return out;
+}
+
+// Return whether a and b differ by no more than rounding. The compiler may contract a * b + c into a fused
+//	multiply-add in the eager operators and not in the expression, or the other way around (GCC does by default
+//	when targeting FMA), so results agree to a few ulps of the terms rather than exactly.
+bool close(double a, double b) {
+	return std::abs(a - b) <= 16. * std::numeric_limits<double>::epsilon() * (std::abs(a) + SCALE);
+}
+
+template <std::uint8_t _Size>
+bool close(const Tuple<_Size>& a, const Tuple<_Size>& b) {
+	for (std::uint8_t i = 0; i < _Size; i++)
+		if (!close(a[i], b[i]))
+			return false;
+
+	return true;
+}
+
+// Evaluate the same expressions eagerly and lazily; the results must match up to rounding
+template <std::uint8_t _Size>
+bool testExpressions(std::default_random_engine& generator) {
+	bool valid = true;
+
+	for (int trial = 0; trial < 100; trial++) {
+		Tuple<_Size> a = randomTuple<_Size>(generator), b = randomTuple<_Size>(generator), c = randomTuple<_Size>(generator);
+		double s = 1.5 + trial, t = .25 - trial;
+
+		Tuple<_Size> eager = a + b * s - c / t;
+		Tuple<_Size> fused = lazy(a) + lazy(b) * s - lazy(c) / t;
+		valid &= close(eager, fused);
+
+		eager = (a - b) * s + (c - a) * t;
+		fused = (lazy(a) - b) * s + (c - lazy(a)) * t;
+		valid &= close(eager, fused);
+
+		eager = c * -1. + s * a;
+		fused = -lazy(c) + s * lazy(a);
+		valid &= close(eager, fused);
+
+		valid &= close(dot(a - b, c), dot(lazy(a) - b, lazy(c)));
+		valid &= close(magnitudeSquared(a + c), magnitudeSquared(lazy(a) + c));
+
+		// In place, including an expression that refers to the Tuple being updated
+		Tuple<_Size> x = a, y = a;
+		x += b * s + a * t;
+		y += lazy(b) * s + lazy(y) * t;
+		valid &= close(x, y);
+
+		x -= c / s;
+		y -= lazy(c) / s;
+		valid &= close(x, y);
+	}
+
+	print(_Size + 0, "D expressions match eager operators:", valid);
+	return valid;
+}
+
+int main() {
+	bool failed = false;
+	std::default_random_engine generator(11);
+
+	print("Tuple Expression Test");
+
+	failed |= !testExpressions<1>(generator);
+	failed |= !testExpressions<2>(generator);
+	failed |= !testExpressions<3>(generator);
+	failed |= !testExpressions<4>(generator);
+	failed |= !testExpressions<8>(generator);
+	failed |= !testExpressions<16>(generator);
+
+	return failed ? 1 : 0;
+}
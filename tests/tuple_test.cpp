@@ -1,4 +1,7 @@
 #include "tuple.h"
+#include "fixed_point.h"
+
+using Brazen::Fixed32;
 
 void print(void) {
 	std::cout << std::endl;
@@ -9,6 +12,12 @@ void print(T arg, Args... args) {
 	print(args...);
 }
 
+// Print a Fixed32 result next to the raw value it should have, and return whether they match
+bool check(const char* name, Fixed32 result, std::int32_t expected) {
+	print(name, result.raw, "expected", expected);
+	return result.raw == expected;
+}
+
 int main() {
 	Tuple<1> a1(3), b1(4);
 	Tuple<2> a2(2, 3), b2(4, 5);
@@ -78,6 +87,42 @@ int main() {
 		print("unit(a4 - a4):", unit(a4 - a4));
 		print();
 	}
+
+	bool failed = false;
+	const Fixed32 MAX = Fixed32::fromRaw(std::numeric_limits<std::int32_t>::max()), MIN = Fixed32::fromRaw(std::numeric_limits<std::int32_t>::min());
+
+	print("Fixed32 Rounding Test");  // Raw values; products and quotients round toward negative infinity
+
+	failed |= !check("-1 * .5:", Fixed32::fromRaw(-1) * Fixed32(.5), -1);
+	failed |= !check("-3 * .5:", Fixed32::fromRaw(-3) * Fixed32(.5), -2);
+	failed |= !check("3 * .5:", Fixed32::fromRaw(3) * Fixed32(.5), 1);
+	failed |= !check("-1 / 2:", Fixed32::fromRaw(-1) / Fixed32(2), -1);
+	failed |= !check("-3 / 2:", Fixed32::fromRaw(-3) / Fixed32(2), -2);
+	failed |= !check("3 / -2:", Fixed32::fromRaw(3) / Fixed32(-2), -2);
+	failed |= !check("-4 / 2:", Fixed32::fromRaw(-4) / Fixed32(2), -2);
+	failed |= !check("1 / 2:", Fixed32::fromRaw(1) / Fixed32(2), 0);
+	failed |= !check("-1. / 3.:", Fixed32(-1) / Fixed32(3), -21846);
+
+	print("\nFixed32 Overflow Test");  // Out of range results wrap around
+
+	failed |= !check("MAX + 1:", MAX + Fixed32::fromRaw(1), std::numeric_limits<std::int32_t>::min());
+	failed |= !check("MIN - 1:", MIN - Fixed32::fromRaw(1), std::numeric_limits<std::int32_t>::max());
+	failed |= !check("-MIN:", -MIN, std::numeric_limits<std::int32_t>::min());
+	failed |= !check("abs(MIN):", abs(MIN), std::numeric_limits<std::int32_t>::min());
+	failed |= !check("32767. * 2.:", Fixed32(32767) * Fixed32(2), -131072);
+	failed |= !check("MAX / 1:", MAX / Fixed32::fromRaw(1), -65536);
+
+	print("\nFixed32 Square Root Test");  // Rounded down
+
+	failed |= !check("sqrt(4.):", sqrt(Fixed32(4)), 131072);
+	failed |= !check("sqrt(2.):", sqrt(Fixed32(2)), 92681);
+	failed |= !check("sqrt(1):", sqrt(Fixed32::fromRaw(1)), 256);
+	failed |= !check("sqrt(MAX):", sqrt(MAX), 11863283);
+	failed |= !check("sqrt(0.):", sqrt(Fixed32(0)), 0);
+	failed |= !check("sqrt(-1.):", sqrt(Fixed32(-1)), 0);
+
+	print();
+	print(failed ? "FAILED" : "PASSED");
 /*
 	print("Magnitude of Unit Vector of Zero Vector Test");
 
@@ -126,5 +171,5 @@ int main() {
 	print("a3 /= 2:", a3 /= 2);
 	print("a4 /= 2:", a4 /= 2);
 */
-	return 0;
+	return failed ? 1 : 0;
 }
@@ -0,0 +1,101 @@
+#include "validation.h"
+#include "aligned_tuple.h"
+#include "command_queue.h"
+#include <cmath>
+#include <vector>
+
+using namespace Brazen;
+
+void print(void) {
+	std::cout << std::endl;
+}
+template <typename T, typename... Args>
+void print(T arg, Args... args) {
+	std::cout << arg << " ";
+	print(args...);
+}
+
+struct TestSpring {
+	std::uint32_t p1_index, p2_index;
+};
+
+// A Result holds either its value or an error, and "value()" throws only for the error
+bool testResult(void) {
+	const Result<int> good(7), bad(ErrorCode::INVALID_PARTICLE_INDEX);
+	const Status fine, failed(ErrorCode::ZERO_VECTOR);
+
+	bool threw = false;
+	try {
+		bad.value();
+	}
+	catch (const ValidationError& e) {
+		threw = e.error() == ErrorCode::INVALID_PARTICLE_INDEX;
+	}
+
+	print("good:", good.ok(), *good, " bad:", bad.ok(), bad.message(), " fallback:", bad.valueOr(-1), " threw:", threw);
+	return good && good.value() == 7 && !bad && bad.valueOr(-1) == -1 && threw && fine.ok() && !failed
+		&& failed.error() == ErrorCode::ZERO_VECTOR;
+}
+
+// The zero vector must give an error rather than exit, and other vectors their direction
+bool testCheckedUnit(void) {
+	const Tuple<3> v(3., 0., 4.), zero;
+	const AlignedTuple<4> aligned(Tuple<4>(0., 2., 0., 0.)), aligned_zero;
+
+	const Result<Tuple<3> > u = checked_unit(v), z = checked_unit(zero);
+	const Result<AlignedTuple<4> > au = checked_unit(aligned), az = checked_unit(aligned_zero);
+
+	bool threw = false;
+	try {
+		unit(zero, false);
+	}
+	catch (const ValidationError& e) {
+		threw = e.error() == ErrorCode::ZERO_VECTOR;
+	}
+
+	print("unit:", *u, " zero:", z.message(), " aligned:", au.ok(), az.message(), " unit(zero, false) threw:", threw);
+	return u && std::abs(magnitude(*u) - 1.) < 1e-15 && std::abs((*u)[2] - .8) < 1e-15 && z.error() == ErrorCode::ZERO_VECTOR
+		&& au && std::abs((*au)[1] - 1.) < 1e-15 && az.error() == ErrorCode::ZERO_VECTOR && threw;
+}
+
+// A rejected command reports why and queues nothing. Without validation bad indices are undefined behavior, so there is nothing to test
+bool testRejectedCommands(void) {
+	if (!VALIDATION_ENABLED) {
+		print("validation compiled out, skipped");
+		return true;
+	}
+
+	CommandQueue<2, double, TestSpring> queue;
+	CommandBatch<2, double, TestSpring> batch;
+	std::vector<Particle<2> > particles(3, Particle<2>(Tuple<2>(), 1.));
+	queue.addParticles(particles.begin(), particles.end());
+
+	const Status spring = queue.addSprings({ TestSpring{ 0, 3 } });
+	const Status edge = queue.addObject({ 0, 1, 2 }, { SpringEdge{ 0, 3 } }, TestSpring{ 0, 0 });
+	const Status member = queue.addObject({ 0, 1, 5 });
+	queue.take(batch);
+
+	print("spring:", spring.message(), " edge:", edge.message(), " member:", member.message(), " queued springs:", batch.springs.size(),
+		" objects:", batch.objects.size());
+	return spring.error() == ErrorCode::INVALID_PARTICLE_INDEX && edge.error() == ErrorCode::INVALID_EDGE_INDEX
+		&& member.error() == ErrorCode::INVALID_PARTICLE_INDEX && batch.springs.empty() && batch.objects.empty();
+}
+
+int main() {
+	bool failed = false;
+
+	print("Result Test");
+	failed |= !testResult();
+	print();
+
+	print("Checked Unit Test");
+	failed |= !testCheckedUnit();
+	print();
+
+	print("Rejected Commands Test");
+	failed |= !testRejectedCommands();
+	print();
+
+	print(failed ? "FAILED" : "PASSED");
+	return failed ? 1 : 0;
+}